@@ -0,0 +1,71 @@
+/**
+ * @file bench_main.c
+ * @brief Benchmark firmware for the WeAct 2.13" panel
+ *
+ * Runs the panel and LVGL benchmarks once at boot and prints CSV on the
+ * console (see epaper_bench.h for the columns). Copy the lines between
+ * "# begin" and "# end" from the monitor output.
+ *
+ * Hardware:
+ * - WeAct Studio 2.13" E-Paper Display (122x250 pixels)
+ * - ESP32-S3 DevKit
+ */
+
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "epaper_bench.h"
+
+static const char *TAG = "epaper_bench";
+
+// =============================================================================
+// PIN CONFIGURATION - Update these to match your wiring!
+// =============================================================================
+
+#define PIN_SPI_SCK     6
+#define PIN_SPI_MOSI    7
+#define PIN_EPD_CS      10
+#define PIN_EPD_DC      9
+#define PIN_EPD_RST     4
+#define PIN_EPD_BUSY    18
+
+// SSD1680 write clock is specified up to 20 MHz. The first clock (the driver
+// default) also runs the refresh and wake tests.
+static const uint32_t s_spi_clocks_hz[] = {4000000, 8000000, 10000000, 20000000};
+
+void app_main(void)
+{
+    const epaper_bench_config_t config = {
+        .panel = {
+            .pin_sck = PIN_SPI_SCK,
+            .pin_mosi = PIN_SPI_MOSI,
+            .pin_cs = PIN_EPD_CS,
+            .pin_dc = PIN_EPD_DC,
+            .pin_rst = PIN_EPD_RST,
+            .pin_busy = PIN_EPD_BUSY,
+            .spi_host = SPI2_HOST,
+        },
+        .spi_clocks_hz = s_spi_clocks_hz,
+        .spi_clock_count = sizeof(s_spi_clocks_hz) / sizeof(s_spi_clocks_hz[0]),
+        .iterations = 50,
+        .refreshes = 3,
+    };
+
+    // Driver logs would interleave with the CSV
+    esp_log_level_set("*", ESP_LOG_WARN);
+
+    ESP_LOGW(TAG, "Benchmark started, this takes about a minute");
+
+    printf("# begin\n");
+    epaper_bench_print_header();
+    bool ok = epaper_bench_run(&config) && epaper_bench_lvgl(&config);
+    printf("# end\n");
+
+    ESP_LOGW(TAG, "Benchmark %s", ok ? "done" : "failed");
+
+    while (1)
+    {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+}
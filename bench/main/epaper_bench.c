@@ -0,0 +1,250 @@
+/**
+ * @file epaper_bench.c
+ * @brief Panel benchmarks: SPI, command overhead, init, refresh and wake
+ *
+ * Times are esp_timer_get_time() differences around the driver calls; the
+ * BUSY share of each refresh comes from the driver's own update timing
+ * (weact_epaper_get_stats()).
+ */
+
+#include "epaper_bench.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief One CSV row from phase statistics
+ *
+ * @param value Derived figure (throughput...), printed when unit is not NULL
+ */
+static void print_row(const char *test, uint32_t spi_hz, const weact_epaper_phase_stats_t *p, double value,
+                      const char *unit)
+{
+    printf("%s,%lu,%lu,%lu,%lu,%lu,", test, (unsigned long)spi_hz, (unsigned long)p->count,
+           (unsigned long)p->mean_us, (unsigned long)p->min_us, (unsigned long)p->max_us);
+    if (unit != NULL)
+    {
+        printf("%.1f,%s\n", value, unit);
+    }
+    else
+    {
+        printf(",\n");
+    }
+}
+
+void epaper_bench_print_header(void)
+{
+    printf("test,spi_hz,n,mean_us,min_us,max_us,value,unit\n");
+}
+
+static bool bench_open(const epaper_bench_config_t *config, uint32_t spi_hz, weact_epaper_t *dev,
+                       weact_epaper_phase_stats_t *init)
+{
+    weact_epaper_config_t panel = config->panel;
+
+    panel.spi_clock_speed_hz = (int)spi_hz;
+    panel.transport = config->new_transport != NULL ? config->new_transport(config->ctx, spi_hz) : NULL;
+
+    int64_t t0 = esp_timer_get_time();
+    if (!weact_epaper_init(dev, &panel))
+    {
+        printf("# init failed at %lu Hz\n", (unsigned long)spi_hz);
+        return false;
+    }
+    weact_epaper_phase_stats_add(init, esp_timer_get_time() - t0);
+    return true;
+}
+
+static void bench_close(weact_epaper_t *dev)
+{
+    // A transport from new_transport is the caller's, the driver leaves it alone
+    weact_epaper_transport_t *transport = dev->owns_transport ? NULL : dev->transport;
+
+    weact_epaper_deinit(dev);
+    if (transport != NULL)
+    {
+        transport->del(transport);
+    }
+}
+
+// A different image every time: a filled bar that moves down the panel
+static void draw_step(weact_epaper_t *dev, int step)
+{
+    int y = (step * 24) % (WEACT_EPAPER_HEIGHT - 24);
+
+    memset(dev->framebuffer, 0xFF, WEACT_EPAPER_BUFFER_SIZE);
+    weact_epaper_draw_rectangle(dev, 0, 0, WEACT_EPAPER_WIDTH - 1, WEACT_EPAPER_HEIGHT - 1, false);
+    weact_epaper_draw_rectangle(dev, 8, y, WEACT_EPAPER_WIDTH - 9, y + 20, true);
+}
+
+// =============================================================================
+// SPI AND COMMAND OVERHEAD
+// =============================================================================
+
+static void bench_spi(const epaper_bench_config_t *config, weact_epaper_t *dev, uint32_t spi_hz)
+{
+    weact_epaper_phase_stats_t upload = {0};
+    weact_epaper_phase_stats_t command = {0};
+    weact_epaper_stats_t before;
+    weact_epaper_stats_t after;
+
+    draw_step(dev, 0);
+    weact_epaper_get_stats(dev, &before);
+    for (int i = 0; i < config->iterations; i++)
+    {
+        int64_t t0 = esp_timer_get_time();
+        weact_epaper_upload(dev);
+        weact_epaper_phase_stats_add(&upload, esp_timer_get_time() - t0);
+    }
+    weact_epaper_get_stats(dev, &after);
+
+    // Frame plus address commands, as sent
+    double bytes = (double)(after.spi_bytes - before.spi_bytes) / config->iterations;
+    print_row("spi_upload", spi_hz, &upload, upload.mean_us > 0 ? bytes * 1000.0 / upload.mean_us : 0.0, "kB/s");
+
+    for (int i = 0; i < config->iterations; i++)
+    {
+        int64_t t0 = esp_timer_get_time();
+        weact_epaper_send_command(dev, WEACT_EPAPER_CMD_NOP);
+        weact_epaper_phase_stats_add(&command, esp_timer_get_time() - t0);
+    }
+    print_row("command", spi_hz, &command, 0.0, NULL);
+}
+
+// =============================================================================
+// REFRESH AND WAKE
+// =============================================================================
+
+// Refresh rows: the whole call, then its BUSY share from the driver
+static void print_refresh(const char *test, weact_epaper_t *dev, uint32_t spi_hz, const weact_epaper_phase_stats_t *call)
+{
+    weact_epaper_stats_t stats;
+    char name[32];
+
+    weact_epaper_get_stats(dev, &stats);
+    print_row(test, spi_hz, call, 0.0, NULL);
+    snprintf(name, sizeof(name), "%s_busy", test);
+    print_row(name, spi_hz, &stats.busy, 0.0, NULL);
+}
+
+static void bench_refresh(const epaper_bench_config_t *config, weact_epaper_t *dev, uint32_t spi_hz)
+{
+    static uint8_t previous[WEACT_EPAPER_BUFFER_SIZE];
+    weact_epaper_phase_stats_t p;
+    int64_t t0;
+
+    memset(&p, 0, sizeof(p));
+    weact_epaper_reset_stats(dev);
+    t0 = esp_timer_get_time();
+    weact_epaper_clear_screen(dev);
+    weact_epaper_phase_stats_add(&p, esp_timer_get_time() - t0);
+    print_refresh("clear", dev, spi_hz, &p);
+
+    // Full: upload + OTP mode 1 waveform
+    memset(&p, 0, sizeof(p));
+    weact_epaper_reset_stats(dev);
+    for (int i = 0; i < config->refreshes; i++)
+    {
+        draw_step(dev, i);
+        t0 = esp_timer_get_time();
+        weact_epaper_display_frame(dev);
+        weact_epaper_phase_stats_add(&p, esp_timer_get_time() - t0);
+    }
+    print_refresh("full", dev, spi_hz, &p);
+
+    // Partial: changed rows + mode 2 waveform
+    memset(&p, 0, sizeof(p));
+    weact_epaper_reset_stats(dev);
+    for (int i = 0; i < config->refreshes; i++)
+    {
+        memcpy(previous, dev->framebuffer, WEACT_EPAPER_BUFFER_SIZE);
+        weact_epaper_draw_rectangle_color(dev, 20, 200, 100, 230, true,
+                                          i % 2 ? WEACT_EPAPER_COLOR_WHITE : WEACT_EPAPER_COLOR_BLACK);
+        t0 = esp_timer_get_time();
+        weact_epaper_display_diff(dev, previous);
+        weact_epaper_phase_stats_add(&p, esp_timer_get_time() - t0);
+    }
+    print_refresh("partial", dev, spi_hz, &p);
+
+    // Page flip: custom page LUT (load hidden page, show it). Its waveform
+    // is longer than the partial one, so this is not the fastest refresh
+    memset(&p, 0, sizeof(p));
+    weact_epaper_reset_stats(dev);
+    for (int i = 0; i < config->refreshes; i++)
+    {
+        weact_epaper_page_t page = i % 2 ? WEACT_EPAPER_PAGE_0 : WEACT_EPAPER_PAGE_1;
+
+        draw_step(dev, i + 1);
+        t0 = esp_timer_get_time();
+        weact_epaper_page_load(dev, page, dev->framebuffer);
+        weact_epaper_page_show(dev, page);
+        weact_epaper_phase_stats_add(&p, esp_timer_get_time() - t0);
+    }
+    print_refresh("page_flip", dev, spi_hz, &p);
+
+    // Wake: reset pulse + cached configuration, from each deep sleep mode.
+    // _update adds the first partial refresh after it: deep sleep 2 lost the
+    // RAM, so that one re-uploads both images before it can start
+    static const struct {
+        weact_epaper_power_state_t state;
+        const char *name;
+    } sleeps[] = {
+        {WEACT_EPAPER_POWER_DEEP_SLEEP_1, "wake_ds1"},
+        {WEACT_EPAPER_POWER_DEEP_SLEEP_2, "wake_ds2"},
+    };
+    int step = 0;
+
+    // Known start (and out of page mode): the rectangle area is white
+    draw_step(dev, 0);
+    weact_epaper_display_frame(dev);
+
+    for (size_t s = 0; s < sizeof(sleeps) / sizeof(sleeps[0]); s++)
+    {
+        weact_epaper_phase_stats_t update;
+        char name[32];
+
+        memset(&p, 0, sizeof(p));
+        memset(&update, 0, sizeof(update));
+        for (int i = 0; i < config->refreshes; i++)
+        {
+            memcpy(previous, dev->framebuffer, WEACT_EPAPER_BUFFER_SIZE);
+            weact_epaper_draw_rectangle_color(dev, 20, 200, 100, 230, true,
+                                              step++ % 2 ? WEACT_EPAPER_COLOR_WHITE : WEACT_EPAPER_COLOR_BLACK);
+            weact_epaper_enter_sleep(dev, sleeps[s].state);
+            t0 = esp_timer_get_time();
+            weact_epaper_wake(dev);
+            weact_epaper_phase_stats_add(&p, esp_timer_get_time() - t0);
+            weact_epaper_display_diff(dev, previous);
+            weact_epaper_phase_stats_add(&update, esp_timer_get_time() - t0);
+        }
+        print_row(sleeps[s].name, spi_hz, &p, 0.0, NULL);
+        snprintf(name, sizeof(name), "%s_update", sleeps[s].name);
+        print_row(name, spi_hz, &update, 0.0, NULL);
+    }
+}
+
+bool epaper_bench_run(const epaper_bench_config_t *config)
+{
+    for (size_t c = 0; c < config->spi_clock_count; c++)
+    {
+        uint32_t spi_hz = config->spi_clocks_hz[c];
+        weact_epaper_phase_stats_t init = {0};
+        static weact_epaper_t dev;
+
+        if (!bench_open(config, spi_hz, &dev, &init))
+        {
+            return false;
+        }
+        print_row("init", spi_hz, &init, 0.0, NULL);
+
+        bench_spi(config, &dev, spi_hz);
+        if (c == 0)
+        {
+            bench_refresh(config, &dev, spi_hz);
+        }
+
+        bench_close(&dev);
+    }
+
+    return true;
+}
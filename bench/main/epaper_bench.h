@@ -0,0 +1,57 @@
+#ifndef EPAPER_BENCH_H
+#define EPAPER_BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "weact_epaper_2in13.h"
+
+/**
+ * @brief Benchmark harness for the WeAct 2.13" panel
+ *
+ * Measures SPI throughput and command overhead at several SPI clocks,
+ * init, full/partial/page_flip refresh and wake-from-sleep times, and (with
+ * epaper_bench_lvgl()) LVGL frame render times. Results go to stdout as
+ * CSV, one row per measurement:
+ *
+ *   test,spi_hz,n,mean_us,min_us,max_us,value,unit
+ *
+ * The same code runs on the device (SPI transport from the pins) and on
+ * the host against the SSD1680 model (see host/bench/bench_firmware.c).
+ */
+
+typedef weact_epaper_transport_t *(*epaper_bench_transport_fn_t)(void *ctx, uint32_t spi_hz);
+
+typedef struct {
+    weact_epaper_config_t panel;    // Pins and bus; spi_clock_speed_hz is set per run
+    const uint32_t *spi_clocks_hz;  // SPI and command tests run at each; refresh tests at the first
+    size_t spi_clock_count;
+    int iterations;                 // SPI and command repetitions
+    int refreshes;                  // Repetitions of each refresh, wake and LVGL frame
+    epaper_bench_transport_fn_t new_transport; // Transport per clock, deleted after the run (NULL = SPI from the pins)
+    void *ctx;
+} epaper_bench_config_t;
+
+/**
+ * @brief Print the CSV header
+ */
+void epaper_bench_print_header(void);
+
+/**
+ * @brief Run the panel benchmarks (SPI, commands, init, refresh, wake)
+ *
+ * @return false if the panel could not be initialized
+ */
+bool epaper_bench_run(const epaper_bench_config_t *config);
+
+/**
+ * @brief Run the LVGL frame benchmark at the first SPI clock
+ *
+ * Creates an lvgl_weact_epaper display (calls lv_init() if needed) and
+ * re-renders a screen of labels `refreshes` times: LVGL render, color
+ * conversion and the whole update from render start to BUSY low.
+ *
+ * @return false if the display could not be created
+ */
+bool epaper_bench_lvgl(const epaper_bench_config_t *config);
+
+#endif // EPAPER_BENCH_H
@@ -0,0 +1,85 @@
+/**
+ * @file epaper_bench_lvgl.c
+ * @brief LVGL frame benchmark: render, conversion and panel update per frame
+ */
+
+#include "epaper_bench.h"
+#include "lvgl.h"
+#include "lvgl_weact_epaper.h"
+#include <stdio.h>
+
+static void print_row(const char *test, uint32_t spi_hz, const weact_epaper_phase_stats_t *p)
+{
+    printf("%s,%lu,%lu,%lu,%lu,%lu,,\n", test, (unsigned long)spi_hz, (unsigned long)p->count,
+           (unsigned long)p->mean_us, (unsigned long)p->min_us, (unsigned long)p->max_us);
+}
+
+bool epaper_bench_lvgl(const epaper_bench_config_t *config)
+{
+    uint32_t spi_hz = config->spi_clocks_hz[0];
+
+    if (!lv_is_initialized())
+    {
+        lv_init();
+    }
+
+    lvgl_weact_epaper_config_t lv_config = lvgl_weact_epaper_get_default_config();
+    lv_config.pin_sck = config->panel.pin_sck;
+    lv_config.pin_mosi = config->panel.pin_mosi;
+    lv_config.pin_cs = config->panel.pin_cs;
+    lv_config.pin_dc = config->panel.pin_dc;
+    lv_config.pin_rst = config->panel.pin_rst;
+    lv_config.pin_busy = config->panel.pin_busy;
+    lv_config.spi_host = config->panel.spi_host;
+    lv_config.spi_bus_initialized = config->panel.spi_bus_initialized;
+    lv_config.spi_chunk_size = config->panel.spi_chunk_size;
+    lv_config.spi_clock_speed_hz = (int)spi_hz;
+    lv_config.transport = config->new_transport != NULL ? config->new_transport(config->ctx, spi_hz) : NULL;
+    lv_config.landscape = true; // As in main.c
+
+    lv_display_t *disp = lvgl_weact_epaper_create(&lv_config);
+    if (disp == NULL)
+    {
+        printf("# lvgl_weact_epaper_create failed\n");
+        return false;
+    }
+
+    // A thermostat-like screen: captions, two values, a separator
+    lv_obj_t *scr = lv_display_get_screen_active(disp);
+    lv_obj_set_style_bg_color(scr, lv_color_white(), LV_PART_MAIN);
+
+    lv_obj_t *caption = lv_label_create(scr);
+    lv_label_set_text(caption, "Current / Target");
+    lv_obj_align(caption, LV_ALIGN_TOP_MID, 0, 4);
+
+    lv_obj_t *value = lv_label_create(scr);
+    lv_obj_align(value, LV_ALIGN_CENTER, 0, 0);
+
+    lv_obj_t *bar = lv_bar_create(scr);
+    lv_obj_set_size(bar, 200, 12);
+    lv_obj_align(bar, LV_ALIGN_BOTTOM_MID, 0, -8);
+
+    // The clear at create time is not a frame
+    lvgl_weact_epaper_reset_stats(disp);
+
+    for (int i = 0; i < config->refreshes; i++)
+    {
+        lv_label_set_text_fmt(value, "%d.%d C  /  %d.%d C", 20 + i % 5, i % 10, 21, 0);
+        lv_bar_set_value(bar, (i * 17) % 100, LV_ANIM_OFF);
+        lv_refr_now(disp);
+    }
+
+    lvgl_weact_epaper_stats_t stats;
+    lvgl_weact_epaper_get_stats(disp, &stats);
+    print_row("lvgl_render", spi_hz, &stats.render);
+    print_row("lvgl_convert", spi_hz, &stats.convert);
+    print_row("lvgl_update", spi_hz, &stats.panel.update);
+
+    lvgl_weact_epaper_delete(disp);
+    if (lv_config.transport != NULL)
+    {
+        lv_config.transport->del(lv_config.transport);
+    }
+
+    return true;
+}
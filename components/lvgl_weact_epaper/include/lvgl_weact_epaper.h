@@ -3,6 +3,7 @@
 
 #include "lvgl.h"
 #include "weact_epaper_2in13.h"
+#include "lvgl_weact_epaper_dither.h"
 
 /**
  * @brief Configuration for LVGL WeAct E-Paper display
@@ -15,9 +16,29 @@ typedef struct {
     gpio_num_t pin_rst;      // Reset
     gpio_num_t pin_busy;     // Busy signal
     int spi_clock_speed_hz;  // SPI clock speed (default: 4MHz)
+    spi_host_device_t spi_host; // SPI host (default: SPI2_HOST); panels may share one or use one each
+    bool spi_bus_initialized; // true = the application already initialized the SPI bus
+    size_t spi_chunk_size;   // Longest SPI transaction, bus released in between (0 = whole frame)
+    weact_epaper_transport_t *transport; // Hardware access (NULL = SPI from the pins above)
+    size_t trace_size;       // Bus trace ring buffer in bytes (0 = off), see lvgl_weact_epaper_get_trace()
     bool landscape;          // true = landscape (250x122), false = portrait (122x250)
+    lvgl_weact_epaper_dither_t dither; // Color to black/white conversion (default: threshold)
+    bool grayscale;          // true = 4 gray levels via gray LUT (dither is ignored)
+    bool tricolor;           // true = black/white/red panel, reddish hues go to the red plane
+    uint32_t auto_sleep_ms;  // Panel deep sleep after this much idle time (0 = never)
+    bool warm_boot;          // true = keep the last frame in RTC memory, skip the clear after ESP32 deep sleep
+    bool async_init;         // true = panel init runs in the background until the first flush, no clear refresh
 } lvgl_weact_epaper_config_t;
 
+/**
+ * @brief Frame timing (see lvgl_weact_epaper_get_stats())
+ */
+typedef struct {
+    weact_epaper_phase_stats_t render;  // LVGL render start to flush
+    weact_epaper_phase_stats_t convert; // Color conversion into the panel framebuffer
+    weact_epaper_stats_t panel;         // Upload, activation, BUSY, update (from render start), SPI traffic
+} lvgl_weact_epaper_stats_t;
+
 /**
  * @brief Initialize LVGL with WeAct 2.13" E-Paper display
  *
@@ -32,6 +53,17 @@ typedef struct {
  */
 lv_disp_t *lvgl_weact_epaper_create(const lvgl_weact_epaper_config_t *config);
 
+/**
+ * @brief Delete a display and release its panel
+ *
+ * Frees the LVGL display, draw buffers, driver instance and context. The
+ * SPI bus is freed once no display created on it is left. create/delete
+ * can be called any number of times, for any number of panels.
+ *
+ * @param disp Display returned by lvgl_weact_epaper_create()
+ */
+void lvgl_weact_epaper_delete(lv_display_t *disp);
+
 /**
  * @brief Get default pin configuration
  *
@@ -41,4 +73,82 @@ lv_disp_t *lvgl_weact_epaper_create(const lvgl_weact_epaper_config_t *config);
  */
 lvgl_weact_epaper_config_t lvgl_weact_epaper_get_default_config(void);
 
+/**
+ * @brief Select the color to black/white conversion mode
+ *
+ * Threshold is fastest; Bayer keeps flat areas clean; Floyd-Steinberg and
+ * Atkinson give the best anti-aliased text and gradients. The mode can be
+ * changed per screen; the active screen is invalidated so it takes effect
+ * on the next refresh.
+ *
+ * @param disp Display returned by lvgl_weact_epaper_create()
+ * @param mode Conversion mode
+ */
+void lvgl_weact_epaper_set_dither(lv_display_t *disp, lvgl_weact_epaper_dither_t mode);
+
+/**
+ * @brief Switch between light and dark theme
+ *
+ * Inverts the panel through the controller (one command plus a refresh).
+ * LVGL keeps rendering black on white; nothing is re-rendered or uploaded.
+ *
+ * @param disp Display returned by lvgl_weact_epaper_create()
+ * @param dark true = white on black
+ */
+void lvgl_weact_epaper_set_dark_mode(lv_display_t *disp, bool dark);
+
+/**
+ * @brief Put the panel to sleep before the ESP32 enters deep sleep
+ *
+ * Waits for a running refresh, puts the panel into deep sleep 1 (RAM
+ * kept) and records in RTC memory that the panel RAM still holds the last
+ * frame. With warm_boot set, the next boot then skips the clear and
+ * writes only the rows that changed before one differential refresh.
+ * Call right before esp_deep_sleep_start(); keep the panel powered.
+ *
+ * @param disp Display returned by lvgl_weact_epaper_create()
+ */
+void lvgl_weact_epaper_prepare_deep_sleep(lv_display_t *disp);
+
+/**
+ * @brief Align the next screen update to a deadline
+ *
+ * The next flush converts and uploads the frame right away but starts the
+ * refresh only at at_us, so e.g. a clock changes visibly exactly on the
+ * minute with no conversion or SPI transfer on the latency path. Update the
+ * UI and force a refresh (lv_refr_now()) a few hundred ms before at_us.
+ *
+ * @param disp Display returned by lvgl_weact_epaper_create()
+ * @param at_us Activation time (esp_timer_get_time() time base)
+ */
+void lvgl_weact_epaper_schedule_next(lv_display_t *disp, int64_t at_us);
+
+/**
+ * @brief Bus trace of the panel (config.trace_size > 0)
+ *
+ * @param disp Display handle
+ * @return Trace, NULL when tracing is off
+ */
+weact_epaper_trace_t *lvgl_weact_epaper_get_trace(lv_display_t *disp);
+
+/**
+ * @brief Per-frame timing since create or the last reset
+ *
+ * Render and conversion per flushed frame, plus the panel's upload,
+ * activation and BUSY times; panel.update runs from the start of
+ * rendering to BUSY low, i.e. what the user waits for.
+ *
+ * @param disp Display handle
+ * @param stats Output
+ * @return false if disp is not a WeAct e-paper display
+ */
+bool lvgl_weact_epaper_get_stats(lv_display_t *disp, lvgl_weact_epaper_stats_t *stats);
+
+/**
+ * @brief Clear the frame timing and the panel statistics
+ *
+ * @param disp Display handle
+ */
+void lvgl_weact_epaper_reset_stats(lv_display_t *disp);
+
 #endif // LVGL_WEACT_EPAPER_H
@@ -0,0 +1,83 @@
+#ifndef LVGL_WEACT_EPAPER_DITHER_H
+#define LVGL_WEACT_EPAPER_DITHER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Luminance to monochrome conversion kernels
+ *
+ * Used by the LVGL flush path to turn one row of 8-bit luminance into
+ * black/white pixels. The kernels have no LVGL or ESP-IDF dependency so they
+ * can be benchmarked on the host.
+ *
+ * Error diffusion streams row by row: Floyd-Steinberg keeps a single error
+ * row, Atkinson keeps two (it pushes error two rows down). No full-frame
+ * buffer is ever allocated.
+ */
+
+// Longest row the kernels accept (landscape width is 250)
+#define LVGL_WEACT_EPAPER_DITHER_MAX_WIDTH 256
+
+/**
+ * @brief Conversion mode
+ */
+typedef enum {
+    LVGL_WEACT_EPAPER_DITHER_THRESHOLD = 0,    // Hard threshold at 128 (fastest, jagged)
+    LVGL_WEACT_EPAPER_DITHER_BAYER_4X4,        // Ordered dither, 4x4 Bayer matrix
+    LVGL_WEACT_EPAPER_DITHER_BAYER_8X8,        // Ordered dither, 8x8 Bayer matrix
+    LVGL_WEACT_EPAPER_DITHER_FLOYD_STEINBERG,  // Error diffusion, 7/3/5/1 weights
+    LVGL_WEACT_EPAPER_DITHER_ATKINSON,         // Error diffusion, 6/8 of error, higher contrast
+    LVGL_WEACT_EPAPER_DITHER_COUNT,
+} lvgl_weact_epaper_dither_t;
+
+/**
+ * @brief Streaming dither state
+ *
+ * err[cur] holds the error flowing into the current row, the other row the
+ * error for the row below it (Atkinson only). Entries are offset by 2 so
+ * kernels can write one column left and two columns right of the row
+ * without bounds checks.
+ */
+typedef struct {
+    lvgl_weact_epaper_dither_t mode;
+    uint8_t cur;
+    int16_t err[2][LVGL_WEACT_EPAPER_DITHER_MAX_WIDTH + 4];
+} lvgl_weact_epaper_dither_ctx_t;
+
+/**
+ * @brief Select a mode and reset the error rows
+ *
+ * @param ctx Dither state
+ * @param mode Conversion mode
+ */
+void lvgl_weact_epaper_dither_init(lvgl_weact_epaper_dither_ctx_t *ctx, lvgl_weact_epaper_dither_t mode);
+
+/**
+ * @brief Reset the error rows (call at the start of every flushed area)
+ *
+ * @param ctx Dither state
+ */
+void lvgl_weact_epaper_dither_begin(lvgl_weact_epaper_dither_ctx_t *ctx);
+
+/**
+ * @brief Convert one row of luminance to black/white
+ *
+ * Rows must be fed top to bottom. x0/y are absolute screen coordinates of the
+ * first pixel; ordered modes use them so the pattern stays fixed on screen.
+ *
+ * @param ctx Dither state
+ * @param luma Input luminance (0 = black, 255 = white), w entries
+ * @param w Row width (at most LVGL_WEACT_EPAPER_DITHER_MAX_WIDTH)
+ * @param x0 Screen X of luma[0]
+ * @param y Screen Y of the row
+ * @param black Output, one byte per pixel: 1 = BLACK, 0 = WHITE
+ */
+void lvgl_weact_epaper_dither_row(lvgl_weact_epaper_dither_ctx_t *ctx, const uint8_t *luma,
+                                  int32_t w, int32_t x0, int32_t y, uint8_t *black);
+
+/**
+ * @brief Human readable mode name (for logs and benchmarks)
+ */
+const char *lvgl_weact_epaper_dither_name(lvgl_weact_epaper_dither_t mode);
+
+#endif // LVGL_WEACT_EPAPER_DITHER_H
@@ -8,15 +8,21 @@
  * Compatible with LVGL 9.4.0 (ESP-IDF 5.5.1 managed component)
  *
  * Features:
- * - RGB to monochrome conversion (brightness threshold)
+ * - RGB to monochrome conversion (threshold, ordered or error diffusion dither)
+ * - Optional 4-level grayscale output (no dithering needed)
+ * - Optional black/white/red output for tri-color panels
+ * - Optional warm boot from RTC memory (no clear after ESP32 deep sleep)
  * - Proper handling of e-paper refresh delays
  * - 16-byte aligned framebuffer management
  * - Full LVGL 9 display driver integration (lv_display_t)
  */
 
 #include "lvgl_weact_epaper.h"
+#include "lvgl_weact_epaper_dither.h"
 #include "weact_epaper_2in13.h"
 #include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include <string.h>
@@ -36,41 +42,173 @@ typedef struct lvgl_weact_epaper_ctx_t
     void *draw_buf1;       // LVGL draw buffer 1
     void *draw_buf2;       // LVGL draw buffer 2 (optional)
     bool landscape;        // Landscape orientation flag
+
+    // Color conversion (one row at a time)
+    lvgl_weact_epaper_dither_ctx_t dither;
+    uint8_t luma_row[LVGL_WEACT_EPAPER_DITHER_MAX_WIDTH];
+    uint8_t mono_row[LVGL_WEACT_EPAPER_DITHER_MAX_WIDTH];
+    uint8_t red_row[LVGL_WEACT_EPAPER_DITHER_MAX_WIDTH];
+
+    int64_t activate_at_us; // Next flush: activate at this esp_timer time (0 = immediately)
+
+    // Frame timing (see lvgl_weact_epaper_get_stats())
+    int64_t render_start_us; // LV_EVENT_RENDER_START of the frame being rendered, 0 = none
+    weact_epaper_phase_stats_t render;
+    weact_epaper_phase_stats_t convert;
+
+    bool warm_boot;         // Keep the displayed frame in RTC memory
+    bool warm_pending;      // Next flush is the first one after a warm boot
 } lvgl_weact_epaper_ctx_t;
 
-// Static context (single display instance)
-static lvgl_weact_epaper_ctx_t g_ctx;
+// Shared by all instances: LVGL has one tick
+static esp_timer_handle_t s_tick_timer;
+static int s_instances;
+
+// Instance that owns the RTC slot (warm boot works for one panel)
+static lvgl_weact_epaper_ctx_t *s_retained_owner;
+
+#define LVGL_WEACT_EPAPER_RETAINED_MAGIC 0x57454132 // "WEA2"
+
+/**
+ * @brief Display state kept across ESP32 deep sleep
+ *
+ * RTC slow memory survives deep sleep and is reinitialised on power-on.
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t hash;          // FNV-1a of framebuffer (detects corruption)
+    bool landscape;         // Orientation the frame was rendered in
+    bool panel_ram_valid;   // Panel went to deep sleep 1 holding this frame in both banks
+    uint8_t framebuffer[WEACT_EPAPER_BUFFER_SIZE]; // Frame on the panel
+} lvgl_weact_epaper_retained_t;
+
+static RTC_DATA_ATTR lvgl_weact_epaper_retained_t s_retained;
+
+/**
+ * @brief Remember the frame now on the panel
+ */
+static void retained_save(lvgl_weact_epaper_ctx_t *ctx)
+{
+    memcpy(s_retained.framebuffer, ctx->epaper.framebuffer, WEACT_EPAPER_BUFFER_SIZE);
+    s_retained.hash = weact_epaper_hash(s_retained.framebuffer, WEACT_EPAPER_BUFFER_SIZE);
+    s_retained.landscape = ctx->landscape;
+    s_retained.panel_ram_valid = false;
+    s_retained.magic = LVGL_WEACT_EPAPER_RETAINED_MAGIC;
+}
+
+static bool retained_valid(bool landscape)
+{
+    return s_retained.magic == LVGL_WEACT_EPAPER_RETAINED_MAGIC &&
+           s_retained.landscape == landscape &&
+           s_retained.hash == weact_epaper_hash(s_retained.framebuffer, WEACT_EPAPER_BUFFER_SIZE);
+}
 
 /**
- * @brief Convert RGB color to monochrome
+ * @brief Convert one row of LVGL pixels to 8-bit luminance
  *
- * Uses brightness threshold to determine black vs white.
- * Hardware expects: 1 = BLACK, 0 = WHITE
- * LVGL colors: (0,0,0) = black, (255,255,255) = white
+ * Uses the perceptual weights R 0.30, G 0.59, B 0.11 in 8.8 fixed point.
+ * LVGL 9 stores 24/32-bit pixels little-endian, i.e. B, G, R(, A) in memory.
  *
- * @param color LVGL RGB color
- * @return 1 for black, 0 for white (hardware format)
+ * @param src First pixel of the row
+ * @param cf LVGL color format of src
+ * @param w Number of pixels
+ * @param luma Output, 0 = black, 255 = white
  */
-static inline uint8_t rgb_to_mono(lv_color_t color)
+static void px_row_to_luma(const uint8_t *src, lv_color_format_t cf, int32_t w, uint8_t *luma)
 {
-    // Extract RGB components (LVGL 9 uses lv_color32_t internally)
-    // Get brightness from color
-    uint8_t r = color.red;
-    uint8_t g = color.green;
-    uint8_t b = color.blue;
+    if (cf == LV_COLOR_FORMAT_RGB565)
+    {
+        const uint16_t *px = (const uint16_t *)src;
+        for (int32_t x = 0; x < w; x++)
+        {
+            uint16_t c = px[x];
+            uint32_t r = (c >> 11) & 0x1F;
+            uint32_t g = (c >> 5) & 0x3F;
+            uint32_t b = c & 0x1F;
+            r = (r << 3) | (r >> 2);
+            g = (g << 2) | (g >> 4);
+            b = (b << 3) | (b >> 2);
+            luma[x] = (uint8_t)((r * 77 + g * 151 + b * 28) >> 8);
+        }
+    }
+    else if (cf == LV_COLOR_FORMAT_RGB888)
+    {
+        for (int32_t x = 0; x < w; x++, src += 3)
+        {
+            luma[x] = (uint8_t)((src[2] * 77 + src[1] * 151 + src[0] * 28) >> 8);
+        }
+    }
+    else if (cf == LV_COLOR_FORMAT_XRGB8888 || cf == LV_COLOR_FORMAT_ARGB8888)
+    {
+        for (int32_t x = 0; x < w; x++, src += 4)
+        {
+            luma[x] = (uint8_t)((src[2] * 77 + src[1] * 151 + src[0] * 28) >> 8);
+        }
+    }
+    else
+    {
+        // L8 and other 8-bit formats are already luminance
+        memcpy(luma, src, (size_t)w);
+    }
+}
 
-    // Calculate brightness (weighted average for human perception)
-    uint16_t brightness = (r * 30 + g * 59 + b * 11) / 100;
+/**
+ * @brief Flag reddish pixels in one row of LVGL pixels (tri-color mode)
+ *
+ * A pixel is red when its red channel is bright and clearly dominates
+ * both green and blue, so orange/pink UI accents map to red while grays,
+ * yellows and skin-like tones stay black/white.
+ *
+ * @param src First pixel of the row
+ * @param cf LVGL color format of src
+ * @param w Number of pixels
+ * @param red Output, 1 = red, 0 = black/white
+ */
+static void px_row_to_red(const uint8_t *src, lv_color_format_t cf, int32_t w, uint8_t *red)
+{
+    for (int32_t x = 0; x < w; x++)
+    {
+        uint32_t r, g, b;
 
-    // Threshold: < 128 is black (1), >= 128 is white (0)
-    return (brightness < 128) ? 1 : 0;
+        if (cf == LV_COLOR_FORMAT_RGB565)
+        {
+            uint16_t c = ((const uint16_t *)src)[x];
+            r = ((c >> 11) & 0x1F) << 3;
+            g = ((c >> 5) & 0x3F) << 2;
+            b = (c & 0x1F) << 3;
+        }
+        else if (cf == LV_COLOR_FORMAT_RGB888)
+        {
+            b = src[x * 3];
+            g = src[x * 3 + 1];
+            r = src[x * 3 + 2];
+        }
+        else if (cf == LV_COLOR_FORMAT_XRGB8888 || cf == LV_COLOR_FORMAT_ARGB8888)
+        {
+            b = src[x * 4];
+            g = src[x * 4 + 1];
+            r = src[x * 4 + 2];
+        }
+        else
+        {
+            // Grayscale formats carry no hue
+            red[x] = 0;
+            continue;
+        }
+
+        uint32_t gb = g > b ? g : b;
+        red[x] = (r >= 128 && r >= gb + 64) ? 1 : 0;
+    }
 }
 
 /**
  * @brief LVGL 9 flush callback
  *
  * Called by LVGL when it needs to update the display.
- * Converts LVGL's RGB framebuffer to monochrome and updates the e-paper.
+ * Converts LVGL's framebuffer to luminance row by row, turns each row into
+ * black/white with the selected dither mode (or 4 gray levels in grayscale
+ * mode) and updates the e-paper.
  *
  * In LVGL 9, the signature changed:
  * - Parameter 1: lv_display_t * (not lv_disp_drv_t *)
@@ -83,58 +221,50 @@ static inline uint8_t rgb_to_mono(lv_color_t color)
 static void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
 {
     lvgl_weact_epaper_ctx_t *ctx = (lvgl_weact_epaper_ctx_t *)lv_display_get_user_data(disp);
+    int64_t flush_start_us = esp_timer_get_time();
 
     ESP_LOGI(TAG, "Flush: x=%ld..%ld, y=%ld..%ld",
              (long)area->x1, (long)area->x2, (long)area->y1, (long)area->y2);
 
+    // The panel update is timed from the start of rendering
+    if (ctx->render_start_us != 0)
+    {
+        weact_epaper_phase_stats_add(&ctx->render, flush_start_us - ctx->render_start_us);
+        weact_epaper_mark_update_start(&ctx->epaper, ctx->render_start_us);
+        ctx->render_start_us = 0;
+    }
+
     // In LVGL 9, px_map is uint8_t* raw pixel data
     // We need to interpret it based on the color format
     lv_color_format_t cf = lv_display_get_color_format(disp);
 
-    // Calculate pixel index
-    size_t px_index = 0;
     int32_t w = lv_area_get_width(area);
     int32_t h = lv_area_get_height(area);
+    uint32_t stride = lv_draw_buf_width_to_stride(w, cf);
+
+    bool gray = ctx->epaper.mode == WEACT_EPAPER_MODE_GRAY4;
+    bool tricolor = ctx->epaper.mode == WEACT_EPAPER_MODE_BWR;
+
+    // Error diffusion restarts for every flushed area
+    lvgl_weact_epaper_dither_begin(&ctx->dither);
 
     for (int32_t y = 0; y < h; y++)
     {
-        for (int32_t x = 0; x < w; x++)
-        {
-            // Get color from px_map based on color format
-            lv_color_t color;
+        int32_t lv_y = area->y1 + y;
 
-            // Most common formats
-            if (cf == LV_COLOR_FORMAT_RGB565)
-            {
-                // RGB565: 2 bytes per pixel
-                uint16_t rgb565 = ((uint16_t *)px_map)[px_index];
-                color.red = ((rgb565 >> 11) & 0x1F) * 255 / 31;
-                color.green = ((rgb565 >> 5) & 0x3F) * 255 / 63;
-                color.blue = (rgb565 & 0x1F) * 255 / 31;
-            }
-            else if (cf == LV_COLOR_FORMAT_RGB888)
-            {
-                // RGB888: 3 bytes per pixel
-                color.red = px_map[px_index * 3];
-                color.green = px_map[px_index * 3 + 1];
-                color.blue = px_map[px_index * 3 + 2];
-            }
-            else if (cf == LV_COLOR_FORMAT_XRGB8888 || cf == LV_COLOR_FORMAT_ARGB8888)
-            {
-                // 32-bit color: 4 bytes per pixel (A/X, R, G, B)
-                color.red = px_map[px_index * 4 + 1];
-                color.green = px_map[px_index * 4 + 2];
-                color.blue = px_map[px_index * 4 + 3];
-            }
-            else
-            {
-                // Fallback for other formats - treat as grayscale
-                color.red = color.green = color.blue = px_map[px_index];
-            }
+        px_row_to_luma(px_map + (size_t)y * stride, cf, w, ctx->luma_row);
 
-            // Convert RGB to monochrome
-            uint8_t mono_color = rgb_to_mono(color);
+        if (!gray)
+        {
+            lvgl_weact_epaper_dither_row(&ctx->dither, ctx->luma_row, w, area->x1, lv_y, ctx->mono_row);
+        }
+        if (tricolor)
+        {
+            px_row_to_red(px_map + (size_t)y * stride, cf, w, ctx->red_row);
+        }
 
+        for (int32_t x = 0; x < w; x++)
+        {
             // Transform coordinates for landscape mode
             int32_t hw_x, hw_y;
             if (ctx->landscape)
@@ -143,32 +273,206 @@ static void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px
                 // LVGL coords (0,0) is top-left of 250x122 display
                 // Hardware coords (0,0) is top-left of 122x250 display
                 // Transform: hw_x = y, hw_y = (WEACT_EPAPER_HEIGHT-1) - x
-                hw_x = area->y1 + y;
+                hw_x = lv_y;
                 hw_y = (WEACT_EPAPER_HEIGHT - 1) - (area->x1 + x);
             }
             else
             {
                 // Portrait: Direct mapping
                 hw_x = area->x1 + x;
-                hw_y = area->y1 + y;
+                hw_y = lv_y;
             }
 
             // Draw to low-level framebuffer
-            weact_epaper_draw_pixel(&ctx->epaper, hw_x, hw_y, mono_color);
-
-            px_index++;
+            if (gray)
+            {
+                // Nearest of 4 levels: 0-42 black, 43-127 dark, 128-212 light, 213-255 white
+                weact_epaper_draw_pixel_gray(&ctx->epaper, hw_x, hw_y, (uint8_t)((ctx->luma_row[x] + 42) / 85));
+            }
+            else if (tricolor && ctx->red_row[x])
+            {
+                weact_epaper_draw_pixel(&ctx->epaper, hw_x, hw_y, WEACT_EPAPER_COLOR_RED);
+            }
+            else
+            {
+                weact_epaper_draw_pixel(&ctx->epaper, hw_x, hw_y, ctx->mono_row[x]);
+            }
         }
     }
 
+    weact_epaper_phase_stats_add(&ctx->convert, esp_timer_get_time() - flush_start_us);
+
     // Tell LVGL we're done flushing first (LVGL 9 API)
     // This allows LVGL to continue while display refreshes
     lv_display_flush_ready(disp);
 
+    if (ctx->warm_pending)
+    {
+        // First frame after a warm boot: only what changed, no flashing
+        ctx->warm_pending = false;
+        weact_epaper_display_diff(&ctx->epaper, s_retained.framebuffer);
+        retained_save(ctx);
+        return;
+    }
+
+    if (ctx->warm_boot)
+    {
+        // Scheduled refreshes happen later; the saved frame is what will be shown
+        retained_save(ctx);
+    }
+
+    if (ctx->activate_at_us != 0)
+    {
+        // Stage now, refresh exactly at the deadline (returns immediately)
+        int64_t at_us = ctx->activate_at_us;
+        ctx->activate_at_us = 0;
+
+        weact_epaper_upload(&ctx->epaper);
+        if (weact_epaper_schedule_activation(&ctx->epaper, at_us))
+        {
+            return;
+        }
+        weact_epaper_refresh(&ctx->epaper);
+        return;
+    }
+
     // Update the physical display
     // Note: This takes ~2 seconds due to e-paper refresh time
     weact_epaper_display_frame(&ctx->epaper);
 }
 
+/**
+ * @brief LV_EVENT_RENDER_START: a frame starts rendering
+ */
+static void lvgl_render_start_cb(lv_event_t *e)
+{
+    lvgl_weact_epaper_ctx_t *ctx = (lvgl_weact_epaper_ctx_t *)lv_event_get_user_data(e);
+
+    // FULL render mode: one flush per frame, the first render start counts
+    if (ctx->render_start_us == 0)
+    {
+        ctx->render_start_us = esp_timer_get_time();
+    }
+}
+
+/**
+ * @brief Panel to deep sleep 1 and mark its RAM as retained for the next boot
+ */
+void lvgl_weact_epaper_prepare_deep_sleep(lv_display_t *disp)
+{
+    lvgl_weact_epaper_ctx_t *ctx = (lvgl_weact_epaper_ctx_t *)lv_display_get_user_data(disp);
+    if (ctx == NULL)
+    {
+        return;
+    }
+
+    weact_epaper_enter_sleep(&ctx->epaper, WEACT_EPAPER_POWER_DEEP_SLEEP_1);
+
+    // Both banks hold the shown frame only after a differential refresh or a clear
+    if (ctx->warm_boot && s_retained.magic == LVGL_WEACT_EPAPER_RETAINED_MAGIC)
+    {
+        s_retained.panel_ram_valid = ctx->epaper.diff_base_valid &&
+                                     memcmp(s_retained.framebuffer, ctx->epaper.framebuffer,
+                                            WEACT_EPAPER_BUFFER_SIZE) == 0;
+    }
+}
+
+/**
+ * @brief Make the next flush stage its frame and activate it at at_us
+ */
+void lvgl_weact_epaper_schedule_next(lv_display_t *disp, int64_t at_us)
+{
+    lvgl_weact_epaper_ctx_t *ctx = (lvgl_weact_epaper_ctx_t *)lv_display_get_user_data(disp);
+    if (ctx == NULL)
+    {
+        return;
+    }
+
+    ctx->activate_at_us = at_us;
+}
+
+/**
+ * @brief Bus trace of the panel, NULL when tracing is off
+ */
+weact_epaper_trace_t *lvgl_weact_epaper_get_trace(lv_display_t *disp)
+{
+    lvgl_weact_epaper_ctx_t *ctx = (lvgl_weact_epaper_ctx_t *)lv_display_get_user_data(disp);
+    if (ctx == NULL)
+    {
+        return NULL;
+    }
+
+    return ctx->epaper.trace;
+}
+
+/**
+ * @brief Frame timing: render, conversion and the panel update phases
+ */
+bool lvgl_weact_epaper_get_stats(lv_display_t *disp, lvgl_weact_epaper_stats_t *stats)
+{
+    lvgl_weact_epaper_ctx_t *ctx = (lvgl_weact_epaper_ctx_t *)lv_display_get_user_data(disp);
+    if (ctx == NULL)
+    {
+        return false;
+    }
+
+    stats->render = ctx->render;
+    stats->convert = ctx->convert;
+    return weact_epaper_get_stats(&ctx->epaper, &stats->panel);
+}
+
+/**
+ * @brief Clear the frame timing and the panel statistics
+ */
+void lvgl_weact_epaper_reset_stats(lv_display_t *disp)
+{
+    lvgl_weact_epaper_ctx_t *ctx = (lvgl_weact_epaper_ctx_t *)lv_display_get_user_data(disp);
+    if (ctx == NULL)
+    {
+        return;
+    }
+
+    memset(&ctx->render, 0, sizeof(ctx->render));
+    memset(&ctx->convert, 0, sizeof(ctx->convert));
+    weact_epaper_reset_stats(&ctx->epaper);
+}
+
+/**
+ * @brief Select the color conversion mode
+ *
+ * Invalidates the active screen so the next refresh uses the new mode.
+ */
+void lvgl_weact_epaper_set_dither(lv_display_t *disp, lvgl_weact_epaper_dither_t mode)
+{
+    lvgl_weact_epaper_ctx_t *ctx = (lvgl_weact_epaper_ctx_t *)lv_display_get_user_data(disp);
+    if (ctx == NULL)
+    {
+        return;
+    }
+
+    lvgl_weact_epaper_dither_init(&ctx->dither, mode);
+    lv_obj_invalidate(lv_display_get_screen_active(disp));
+
+    ESP_LOGI(TAG, "Dither mode: %s", lvgl_weact_epaper_dither_name(mode));
+}
+
+/**
+ * @brief Switch dark mode by inverting the BW RAM bank at refresh time
+ *
+ * LVGL does not re-render and no framebuffer is uploaded.
+ */
+void lvgl_weact_epaper_set_dark_mode(lv_display_t *disp, bool dark)
+{
+    lvgl_weact_epaper_ctx_t *ctx = (lvgl_weact_epaper_ctx_t *)lv_display_get_user_data(disp);
+    if (ctx == NULL)
+    {
+        return;
+    }
+
+    weact_epaper_set_inverted(&ctx->epaper, dark);
+    weact_epaper_refresh(&ctx->epaper);
+}
+
 /**
  * @brief Get default configuration
  *
@@ -187,6 +491,17 @@ lvgl_weact_epaper_config_t lvgl_weact_epaper_get_default_config(void)
         .pin_busy = 18,
         .spi_clock_speed_hz = 4000000, // 4 MHz
         .landscape = false,             // Default: portrait mode
+        .dither = LVGL_WEACT_EPAPER_DITHER_THRESHOLD,
+        .grayscale = false,
+        .tricolor = false,
+        .auto_sleep_ms = 0,
+        .warm_boot = false,
+        .async_init = false,
+        .spi_host = SPI2_HOST,
+        .spi_bus_initialized = false,
+        .spi_chunk_size = 0,
+        .transport = NULL,
+        .trace_size = 0,
     };
 
     return config;
@@ -202,6 +517,8 @@ static void lvgl_tick_timer_cb(void *arg)
     lv_tick_inc(10); // 10ms tick
 }
 
+static void lvgl_weact_epaper_release(lvgl_weact_epaper_ctx_t *ctx);
+
 /**
  * @brief Create LVGL display
  *
@@ -218,6 +535,13 @@ lv_display_t *lvgl_weact_epaper_create(const lvgl_weact_epaper_config_t *config)
         return NULL;
     }
 
+    lvgl_weact_epaper_ctx_t *ctx = heap_caps_calloc(1, sizeof(*ctx), MALLOC_CAP_8BIT);
+    if (ctx == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to allocate display context");
+        return NULL;
+    }
+
     // Initialize low-level driver
     weact_epaper_config_t epaper_config = {
         .pin_sck = config->pin_sck,
@@ -227,22 +551,88 @@ lv_display_t *lvgl_weact_epaper_create(const lvgl_weact_epaper_config_t *config)
         .pin_rst = config->pin_rst,
         .pin_busy = config->pin_busy,
         .spi_clock_speed_hz = config->spi_clock_speed_hz,
+        .spi_host = config->spi_host,
+        .spi_bus_initialized = config->spi_bus_initialized,
+        .spi_chunk_size = config->spi_chunk_size,
+        .transport = config->transport,
+        .trace_size = config->trace_size,
     };
 
     // Store landscape orientation preference
-    g_ctx.landscape = config->landscape;
+    ctx->landscape = config->landscape;
+    lvgl_weact_epaper_dither_init(&ctx->dither, config->dither);
+
+    // One RTC slot: warm boot for the first instance that asks for it
+    bool warm_boot = config->warm_boot && s_retained_owner == NULL;
+    if (config->warm_boot && !warm_boot)
+    {
+        ESP_LOGW(TAG, "Warm boot already used by another display, disabled");
+    }
 
-    if (!weact_epaper_init(&g_ctx.epaper, &epaper_config))
+    // Warm boot keeps the panel content, so RAM is not filled white
+    bool warm = warm_boot && retained_valid(config->landscape);
+
+    bool ok = config->async_init ? weact_epaper_init_async(&ctx->epaper, &epaper_config, !warm)
+                                 : weact_epaper_init(&ctx->epaper, &epaper_config);
+    if (!ok)
     {
         ESP_LOGE(TAG, "Failed to initialize low-level driver");
+        lvgl_weact_epaper_release(ctx);
         return NULL;
     }
 
     ESP_LOGI(TAG, "Low-level driver initialized");
 
-    // Clear display to start with clean slate
-    weact_epaper_clear_screen(&g_ctx.epaper);
-    ESP_LOGI(TAG, "Display cleared");
+    if (config->tricolor)
+    {
+        if (!weact_epaper_set_mode(&ctx->epaper, WEACT_EPAPER_MODE_BWR))
+        {
+            ESP_LOGW(TAG, "Tri-color mode unavailable, using black/white");
+        }
+    }
+    else if (config->grayscale && !weact_epaper_set_mode(&ctx->epaper, WEACT_EPAPER_MODE_GRAY4))
+    {
+        ESP_LOGW(TAG, "Grayscale mode unavailable, using black/white");
+    }
+
+    ctx->warm_boot = warm_boot;
+    if (warm_boot)
+    {
+        s_retained_owner = ctx;
+    }
+    ctx->warm_pending = false;
+
+    if (warm && ctx->epaper.mode == WEACT_EPAPER_MODE_BW)
+    {
+        // The panel still shows the retained frame: no clear, the first
+        // flush does a differential refresh against it
+        weact_epaper_restore(&ctx->epaper, s_retained.framebuffer, s_retained.panel_ram_valid);
+        ctx->warm_pending = true;
+        ESP_LOGI(TAG, "Warm boot, panel RAM %s", s_retained.panel_ram_valid ? "retained" : "reloaded");
+    }
+    else if (config->async_init && ctx->epaper.mode == WEACT_EPAPER_MODE_BW)
+    {
+        // RAM is filled white by the init; the first frame's full refresh
+        // repaints the whole panel, so a separate clear would only add a refresh
+        ESP_LOGI(TAG, "Panel initializing in the background");
+    }
+    else
+    {
+        // Clear display to start with clean slate
+        weact_epaper_clear_screen(&ctx->epaper);
+        ESP_LOGI(TAG, "Display cleared");
+
+        if (warm_boot)
+        {
+            retained_save(ctx);
+        }
+    }
+
+    // Deep sleep between updates; the next flush wakes the panel
+    if (config->auto_sleep_ms > 0)
+    {
+        weact_epaper_set_auto_sleep(&ctx->epaper, config->auto_sleep_ms, WEACT_EPAPER_POWER_DEEP_SLEEP_1);
+    }
 
     // ===============================================
     // LVGL 9 Display Creation
@@ -253,10 +643,11 @@ lv_display_t *lvgl_weact_epaper_create(const lvgl_weact_epaper_config_t *config)
     int32_t disp_height = config->landscape ? WEACT_EPAPER_WIDTH : WEACT_EPAPER_HEIGHT;
 
     // Create display object (LVGL 9 API)
-    g_ctx.disp = lv_display_create(disp_width, disp_height);
-    if (g_ctx.disp == NULL)
+    ctx->disp = lv_display_create(disp_width, disp_height);
+    if (ctx->disp == NULL)
     {
         ESP_LOGE(TAG, "Failed to create LVGL display");
+        lvgl_weact_epaper_release(ctx);
         return NULL;
     }
 
@@ -269,17 +660,17 @@ lv_display_t *lvgl_weact_epaper_create(const lvgl_weact_epaper_config_t *config)
     // 1/10 screen = 3050 pixels, use ~2500 to be safe
     size_t buf_size = 122 * 250; // 122 * 250 / 8 = 3812 bytes (1 bit per pixel)
 
-    g_ctx.draw_buf1 = heap_caps_malloc(buf_size * sizeof(lv_color_t), MALLOC_CAP_DMA);
-    if (g_ctx.draw_buf1 == NULL)
+    ctx->draw_buf1 = heap_caps_malloc(buf_size * sizeof(lv_color_t), MALLOC_CAP_DMA);
+    if (ctx->draw_buf1 == NULL)
     {
         ESP_LOGE(TAG, "Failed to allocate draw buffer 1");
-        lv_display_delete(g_ctx.disp);
+        lvgl_weact_epaper_release(ctx);
         return NULL;
     }
 
     // Optional: Use double buffering for smoother rendering
-    g_ctx.draw_buf2 = heap_caps_malloc(buf_size * sizeof(lv_color_t), MALLOC_CAP_DMA);
-    if (g_ctx.draw_buf2 == NULL)
+    ctx->draw_buf2 = heap_caps_malloc(buf_size * sizeof(lv_color_t), MALLOC_CAP_DMA);
+    if (ctx->draw_buf2 == NULL)
     {
         ESP_LOGW(TAG, "Failed to allocate draw buffer 2, using single buffer");
     }
@@ -288,35 +679,87 @@ lv_display_t *lvgl_weact_epaper_create(const lvgl_weact_epaper_config_t *config)
 
     // Set display buffers (LVGL 9 API)
     // For e-paper, use FULL render mode for complete screen updates
-    lv_display_set_buffers(g_ctx.disp,
-                           g_ctx.draw_buf1,
-                           g_ctx.draw_buf2,
+    lv_display_set_buffers(ctx->disp,
+                           ctx->draw_buf1,
+                           ctx->draw_buf2,
                            buf_size * sizeof(lv_color_t),
                            LV_DISPLAY_RENDER_MODE_FULL);
 
     // Set flush callback (LVGL 9 API)
-    lv_display_set_flush_cb(g_ctx.disp, lvgl_flush_cb);
+    lv_display_set_flush_cb(ctx->disp, lvgl_flush_cb);
 
     // Store context in user_data for callback access
-    lv_display_set_user_data(g_ctx.disp, &g_ctx);
+    lv_display_set_user_data(ctx->disp, ctx);
 
-    // Set default display
-    lv_display_set_default(g_ctx.disp);
+    // Render time (start of rendering to flush)
+    lv_display_add_event_cb(ctx->disp, lvgl_render_start_cb, LV_EVENT_RENDER_START, ctx);
+
+    // The first display becomes the default one
+    if (s_instances == 0)
+    {
+        lv_display_set_default(ctx->disp);
+    }
 
     ESP_LOGI(TAG, "LVGL 9 display registered successfully");
     ESP_LOGI(TAG, "Display: WeAct 2.13\" E-Paper (%dx%d) %s mode",
              (int)disp_width, (int)disp_height,
              config->landscape ? "landscape" : "portrait");
 
-    ESP_LOGI(TAG, "Setting up LVGL tick timer...");
+    // One tick timer for all displays
+    if (s_instances++ == 0)
+    {
+        ESP_LOGI(TAG, "Setting up LVGL tick timer...");
+
+        const esp_timer_create_args_t lvgl_tick_timer_args = {
+            .callback = lvgl_tick_timer_cb,
+            .name = "lvgl_tick"};
 
-    const esp_timer_create_args_t lvgl_tick_timer_args = {
-        .callback = lvgl_tick_timer_cb,
-        .name = "lvgl_tick"};
+        ESP_ERROR_CHECK(esp_timer_create(&lvgl_tick_timer_args, &s_tick_timer));
+        ESP_ERROR_CHECK(esp_timer_start_periodic(s_tick_timer, 10 * 1000)); // 10ms
+    }
 
-    esp_timer_handle_t lvgl_tick_timer = NULL;
-    ESP_ERROR_CHECK(esp_timer_create(&lvgl_tick_timer_args, &lvgl_tick_timer));
-    ESP_ERROR_CHECK(esp_timer_start_periodic(lvgl_tick_timer, 10 * 1000)); // 10ms
+    return ctx->disp;
+}
 
-    return g_ctx.disp;
+/**
+ * @brief Free everything an instance holds (display, buffers, driver, context)
+ */
+static void lvgl_weact_epaper_release(lvgl_weact_epaper_ctx_t *ctx)
+{
+    if (ctx->disp != NULL)
+    {
+        lv_display_delete(ctx->disp);
+    }
+
+    heap_caps_free(ctx->draw_buf1);
+    heap_caps_free(ctx->draw_buf2);
+    weact_epaper_deinit(&ctx->epaper);
+
+    if (s_retained_owner == ctx)
+    {
+        s_retained_owner = NULL;
+    }
+
+    heap_caps_free(ctx);
+}
+
+/**
+ * @brief Delete a display created by lvgl_weact_epaper_create()
+ */
+void lvgl_weact_epaper_delete(lv_display_t *disp)
+{
+    lvgl_weact_epaper_ctx_t *ctx = (lvgl_weact_epaper_ctx_t *)lv_display_get_user_data(disp);
+    if (ctx == NULL)
+    {
+        return;
+    }
+
+    lvgl_weact_epaper_release(ctx);
+
+    if (--s_instances == 0)
+    {
+        esp_timer_stop(s_tick_timer);
+        esp_timer_delete(s_tick_timer);
+        s_tick_timer = NULL;
+    }
 }
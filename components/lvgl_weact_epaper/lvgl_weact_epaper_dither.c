@@ -0,0 +1,210 @@
+/**
+ * @file lvgl_weact_epaper_dither.c
+ * @brief Luminance to monochrome conversion kernels
+ *
+ * All kernels work on one row at a time and write 1 = BLACK, 0 = WHITE,
+ * matching weact_epaper_draw_pixel().
+ */
+
+#include "lvgl_weact_epaper_dither.h"
+#include <string.h>
+
+// Bayer thresholds, pre-scaled to 0..255: (index + 0.5) * 256 / N²
+static const uint8_t bayer4_threshold[4][4] = {
+    {8, 136, 40, 168},
+    {200, 72, 232, 104},
+    {56, 184, 24, 152},
+    {248, 120, 216, 88},
+};
+
+static const uint8_t bayer8_threshold[8][8] = {
+    {2, 130, 34, 162, 10, 138, 42, 170},
+    {194, 66, 226, 98, 202, 74, 234, 106},
+    {50, 178, 18, 146, 58, 186, 26, 154},
+    {242, 114, 210, 82, 250, 122, 218, 90},
+    {14, 142, 46, 174, 6, 134, 38, 166},
+    {206, 78, 238, 110, 198, 70, 230, 102},
+    {62, 190, 30, 158, 54, 182, 22, 150},
+    {254, 126, 222, 94, 246, 118, 214, 86},
+};
+
+void lvgl_weact_epaper_dither_init(lvgl_weact_epaper_dither_ctx_t *ctx, lvgl_weact_epaper_dither_t mode)
+{
+    if (mode >= LVGL_WEACT_EPAPER_DITHER_COUNT)
+    {
+        mode = LVGL_WEACT_EPAPER_DITHER_THRESHOLD;
+    }
+
+    ctx->mode = mode;
+    lvgl_weact_epaper_dither_begin(ctx);
+}
+
+void lvgl_weact_epaper_dither_begin(lvgl_weact_epaper_dither_ctx_t *ctx)
+{
+    // Ordered modes carry no state between rows
+    if (ctx->mode != LVGL_WEACT_EPAPER_DITHER_FLOYD_STEINBERG &&
+        ctx->mode != LVGL_WEACT_EPAPER_DITHER_ATKINSON)
+    {
+        return;
+    }
+
+    ctx->cur = 0;
+    memset(ctx->err, 0, sizeof(ctx->err));
+}
+
+static void dither_threshold(const uint8_t *luma, int32_t w, uint8_t *black)
+{
+    for (int32_t x = 0; x < w; x++)
+    {
+        black[x] = luma[x] < 128;
+    }
+}
+
+static void dither_bayer4(const uint8_t *luma, int32_t w, int32_t x0, int32_t y, uint8_t *black)
+{
+    const uint8_t *t = bayer4_threshold[y & 3];
+    for (int32_t x = 0; x < w; x++)
+    {
+        black[x] = luma[x] < t[(x0 + x) & 3];
+    }
+}
+
+static void dither_bayer8(const uint8_t *luma, int32_t w, int32_t x0, int32_t y, uint8_t *black)
+{
+    const uint8_t *t = bayer8_threshold[y & 7];
+    for (int32_t x = 0; x < w; x++)
+    {
+        black[x] = luma[x] < t[(x0 + x) & 7];
+    }
+}
+
+/**
+ * Floyd-Steinberg with a single error row.
+ *
+ * e[x] is read for the current row and then reused for the next row. Writes
+ * to the next row lag one column behind the read position: e[x-1] has already
+ * been consumed, so it is finalised with the 3/16 share, while the 5/16 and
+ * 1/16 shares for columns x and x+1 are held in registers until then.
+ */
+static void dither_floyd_steinberg(lvgl_weact_epaper_dither_ctx_t *ctx, const uint8_t *luma,
+                                   int32_t w, uint8_t *black)
+{
+    int16_t *e = &ctx->err[0][2];
+    int32_t right = 0;  // 7/16 share for x+1 on this row
+    int32_t below = 0;  // Pending next-row error for column x-1
+    int32_t below_r = 0; // Pending next-row error for column x
+
+    for (int32_t x = 0; x < w; x++)
+    {
+        int32_t v = luma[x] + e[x] + right;
+        int32_t err;
+
+        if (v < 128)
+        {
+            black[x] = 1;
+            err = v;
+        }
+        else
+        {
+            black[x] = 0;
+            err = v - 255;
+        }
+
+        right = err * 7 / 16;
+        e[x - 1] = (int16_t)(below + err * 3 / 16);
+        below = below_r + err * 5 / 16;
+        below_r = err / 16;
+    }
+
+    e[w - 1] = (int16_t)below;
+}
+
+/**
+ * Atkinson with two error rows.
+ *
+ * Each 1/8 share goes to x+1, x+2, (x-1, x, x+1) on the next row and x two
+ * rows down. The two-rows-down share is written into the current row's slot
+ * right after it is read, so after the row the buffers simply swap roles.
+ */
+static void dither_atkinson(lvgl_weact_epaper_dither_ctx_t *ctx, const uint8_t *luma,
+                            int32_t w, uint8_t *black)
+{
+    int16_t *cur = &ctx->err[ctx->cur][2];
+    int16_t *next = &ctx->err[ctx->cur ^ 1][2];
+    int32_t right1 = 0; // Error for x+1 on this row
+    int32_t right2 = 0; // Error for x+2 on this row
+
+    for (int32_t x = 0; x < w; x++)
+    {
+        int32_t v = luma[x] + cur[x] + right1;
+        int32_t q;
+
+        if (v < 128)
+        {
+            black[x] = 1;
+            q = v / 8;
+        }
+        else
+        {
+            black[x] = 0;
+            q = (v - 255) / 8;
+        }
+
+        right1 = right2 + q;
+        right2 = q;
+        next[x - 1] += q;
+        next[x] += q;
+        next[x + 1] += q;
+        cur[x] = (int16_t)q;
+    }
+
+    ctx->cur ^= 1;
+}
+
+void lvgl_weact_epaper_dither_row(lvgl_weact_epaper_dither_ctx_t *ctx, const uint8_t *luma,
+                                  int32_t w, int32_t x0, int32_t y, uint8_t *black)
+{
+    if (w > LVGL_WEACT_EPAPER_DITHER_MAX_WIDTH)
+    {
+        w = LVGL_WEACT_EPAPER_DITHER_MAX_WIDTH;
+    }
+
+    switch (ctx->mode)
+    {
+    case LVGL_WEACT_EPAPER_DITHER_BAYER_4X4:
+        dither_bayer4(luma, w, x0, y, black);
+        break;
+    case LVGL_WEACT_EPAPER_DITHER_BAYER_8X8:
+        dither_bayer8(luma, w, x0, y, black);
+        break;
+    case LVGL_WEACT_EPAPER_DITHER_FLOYD_STEINBERG:
+        dither_floyd_steinberg(ctx, luma, w, black);
+        break;
+    case LVGL_WEACT_EPAPER_DITHER_ATKINSON:
+        dither_atkinson(ctx, luma, w, black);
+        break;
+    case LVGL_WEACT_EPAPER_DITHER_THRESHOLD:
+    default:
+        dither_threshold(luma, w, black);
+        break;
+    }
+}
+
+const char *lvgl_weact_epaper_dither_name(lvgl_weact_epaper_dither_t mode)
+{
+    switch (mode)
+    {
+    case LVGL_WEACT_EPAPER_DITHER_THRESHOLD:
+        return "threshold";
+    case LVGL_WEACT_EPAPER_DITHER_BAYER_4X4:
+        return "bayer4x4";
+    case LVGL_WEACT_EPAPER_DITHER_BAYER_8X8:
+        return "bayer8x8";
+    case LVGL_WEACT_EPAPER_DITHER_FLOYD_STEINBERG:
+        return "floyd-steinberg";
+    case LVGL_WEACT_EPAPER_DITHER_ATKINSON:
+        return "atkinson";
+    default:
+        return "unknown";
+    }
+}
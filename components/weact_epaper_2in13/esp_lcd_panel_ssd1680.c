@@ -0,0 +1,359 @@
+/**
+ * @file esp_lcd_panel_ssd1680.c
+ * @brief SSD1680 panel driver for the esp_lcd framework
+ *
+ * The esp_lcd_panel_t callbacks on top of the weact_epaper_* driver: each
+ * panel embeds a weact_epaper_t running on the panel IO transport
+ * (weact_epaper_transport_panel_io.c), so init, sleep, refresh, stats and
+ * energy accounting are the driver's own. This file only maps esp_lcd
+ * coordinates, mirroring and swap_xy onto the controller's address counter.
+ */
+
+#include "esp_lcd_panel_ssd1680.h"
+#include "weact_epaper_2in13.h"
+#include "weact_epaper_private.h"
+#include "esp_lcd_panel_interface.h"
+#include "esp_lcd_panel_ops.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "SSD1680_PANEL";
+
+// RAM is 128 x 250; the panel shows columns 0..121
+#define SSD1680_RAM_WIDTH     128
+
+// Data Entry Mode (0x11) bits
+#define SSD1680_ENTRY_X_INC   (1 << 0)
+#define SSD1680_ENTRY_Y_INC   (1 << 1)
+#define SSD1680_ENTRY_Y_FIRST (1 << 2)
+
+// Driver Output Control (0x01) third byte: TB = scan G295 -> G0
+#define SSD1680_GATE_TB       (1 << 0)
+
+typedef struct {
+    esp_lcd_panel_t base;
+    weact_epaper_t dev;               // Driver state on the panel IO transport
+    weact_epaper_transport_t *transport;
+    gpio_num_t reset_gpio;
+    esp_lcd_ssd1680_refresh_done_cb_t on_refresh_done;
+    void *user_ctx;
+    volatile bool refresh_armed;      // esp_lcd_ssd1680_refresh(panel, false) waits for its BUSY edge
+    int x_gap;
+    int y_gap;
+    bool mirror_x;
+    bool mirror_y;
+    bool swap_xy;
+    uint8_t *scratch; // Bit-reversed rows for mirror_x (allocated on first use)
+} ssd1680_panel_t;
+
+static uint8_t reverse_bits(uint8_t b)
+{
+    b = (uint8_t)((b & 0xF0) >> 4 | (b & 0x0F) << 4);
+    b = (uint8_t)((b & 0xCC) >> 2 | (b & 0x33) << 2);
+    b = (uint8_t)((b & 0xAA) >> 1 | (b & 0x55) << 1);
+    return b;
+}
+
+// Installed by esp_lcd_ssd1680_refresh(panel, false): BUSY also falls
+// after resets and wake, which are not refreshes
+static void IRAM_ATTR ssd1680_busy_isr(void *arg)
+{
+    ssd1680_panel_t *p = (ssd1680_panel_t *)arg;
+
+    if (!p->refresh_armed)
+    {
+        return;
+    }
+
+    p->refresh_armed = false;
+    if (p->on_refresh_done(&p->base, p->user_ctx))
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static void ssd1680_send_orientation(ssd1680_panel_t *p)
+{
+    uint8_t entry = SSD1680_ENTRY_Y_INC;
+    if (!p->mirror_x)
+    {
+        entry |= SSD1680_ENTRY_X_INC;
+    }
+    if (p->swap_xy)
+    {
+        entry |= SSD1680_ENTRY_Y_FIRST;
+    }
+
+    weact_epaper_set_orientation(&p->dev, entry, p->mirror_y ? SSD1680_GATE_TB : 0x00);
+}
+
+// =============================================================================
+// esp_lcd_panel_t callbacks
+// =============================================================================
+
+static esp_err_t panel_ssd1680_reset(esp_lcd_panel_t *panel)
+{
+    ssd1680_panel_t *p = __containerof(panel, ssd1680_panel_t, base);
+
+    // init() waits for BUSY before its own SW reset
+    if (p->reset_gpio >= 0)
+    {
+        weact_epaper_reset(&p->dev);
+    }
+    else
+    {
+        weact_epaper_send_command(&p->dev, WEACT_EPAPER_CMD_SW_RESET);
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t panel_ssd1680_init(esp_lcd_panel_t *panel)
+{
+    ssd1680_panel_t *p = __containerof(panel, ssd1680_panel_t, base);
+
+    // Orientation and inversion come from the cached state
+    weact_epaper_init_registers(&p->dev);
+    return ESP_OK;
+}
+
+/**
+ * Windowed RAM write. The window is given in RAM coordinates (after gap and
+ * swap_xy); with mirror_x the X counter runs right to left, so the window
+ * start is the higher byte column and each byte is bit-reversed.
+ */
+static esp_err_t panel_ssd1680_draw_bitmap(esp_lcd_panel_t *panel, int x_start, int y_start,
+                                           int x_end, int y_end, const void *color_data)
+{
+    ssd1680_panel_t *p = __containerof(panel, ssd1680_panel_t, base);
+
+    ESP_RETURN_ON_FALSE(x_start < x_end && y_start < y_end, ESP_ERR_INVALID_ARG, TAG, "empty area");
+
+    if (p->swap_xy)
+    {
+        int t;
+        t = x_start; x_start = y_start; y_start = t;
+        t = x_end; x_end = y_end; y_end = t;
+    }
+
+    x_start += p->x_gap;
+    x_end += p->x_gap;
+    y_start += p->y_gap;
+    y_end += p->y_gap;
+
+    ESP_RETURN_ON_FALSE((x_start % 8) == 0 && ((x_end % 8) == 0 || x_end == WEACT_EPAPER_WIDTH),
+                        ESP_ERR_INVALID_ARG, TAG, "x must be byte aligned");
+    ESP_RETURN_ON_FALSE(x_start >= 0 && y_start >= 0 && x_end <= SSD1680_RAM_WIDTH && y_end <= WEACT_EPAPER_HEIGHT,
+                        ESP_ERR_INVALID_ARG, TAG, "area outside RAM");
+
+    uint8_t xs = (uint8_t)(x_start / 8);
+    uint8_t xe = (uint8_t)((x_end - 1) / 8);
+    size_t len = (size_t)(xe - xs + 1) * (size_t)(y_end - y_start);
+    const uint8_t *data = color_data;
+
+    if (p->mirror_x)
+    {
+        // Mirror around the 128-pixel RAM row: column c -> 15 - c
+        xs = (uint8_t)(WEACT_EPAPER_WIDTH_BYTES - 1 - xs);
+        xe = (uint8_t)(WEACT_EPAPER_WIDTH_BYTES - 1 - xe);
+
+        for (size_t i = 0; i < len; i++)
+        {
+            p->scratch[i] = reverse_bits(data[i]);
+        }
+        data = p->scratch;
+    }
+
+    // Waits for a running refresh and wakes the panel from deep sleep first
+    weact_epaper_write_window(&p->dev, WEACT_EPAPER_CMD_WRITE_RAM_BW, xs, xe, y_start, y_end - 1, data, len);
+    return ESP_OK;
+}
+
+static esp_err_t panel_ssd1680_mirror(esp_lcd_panel_t *panel, bool mirror_x, bool mirror_y)
+{
+    ssd1680_panel_t *p = __containerof(panel, ssd1680_panel_t, base);
+
+    if (mirror_x && p->scratch == NULL)
+    {
+        p->scratch = heap_caps_malloc(WEACT_EPAPER_BUFFER_SIZE, MALLOC_CAP_DMA);
+        ESP_RETURN_ON_FALSE(p->scratch, ESP_ERR_NO_MEM, TAG, "no memory for mirror_x scratch buffer");
+    }
+
+    p->mirror_x = mirror_x;
+    p->mirror_y = mirror_y;
+    ssd1680_send_orientation(p); // Cached while asleep, sent on wake
+    return ESP_OK;
+}
+
+static esp_err_t panel_ssd1680_swap_xy(esp_lcd_panel_t *panel, bool swap_axes)
+{
+    ssd1680_panel_t *p = __containerof(panel, ssd1680_panel_t, base);
+
+    p->swap_xy = swap_axes;
+    ssd1680_send_orientation(p);
+    return ESP_OK;
+}
+
+static esp_err_t panel_ssd1680_set_gap(esp_lcd_panel_t *panel, int x_gap, int y_gap)
+{
+    ssd1680_panel_t *p = __containerof(panel, ssd1680_panel_t, base);
+
+    p->x_gap = x_gap;
+    p->y_gap = y_gap;
+    return ESP_OK;
+}
+
+static esp_err_t panel_ssd1680_invert_color(esp_lcd_panel_t *panel, bool invert_color_data)
+{
+    ssd1680_panel_t *p = __containerof(panel, ssd1680_panel_t, base);
+
+    weact_epaper_set_inverted(&p->dev, invert_color_data);
+    return ESP_OK;
+}
+
+/**
+ * E-paper keeps its image without power, so "off" and "sleep" both mean
+ * deep sleep mode 1 (RAM retained). Only a hardware reset wakes the
+ * controller, and the driver wakes it by itself for the next draw or
+ * refresh, so both directions need the reset GPIO.
+ */
+static esp_err_t panel_ssd1680_disp_sleep(esp_lcd_panel_t *panel, bool sleep)
+{
+    ssd1680_panel_t *p = __containerof(panel, ssd1680_panel_t, base);
+
+    ESP_RETURN_ON_FALSE(p->reset_gpio >= 0, ESP_ERR_NOT_SUPPORTED, TAG, "deep sleep needs a reset GPIO to wake");
+
+    if (sleep)
+    {
+        weact_epaper_enter_sleep(&p->dev, WEACT_EPAPER_POWER_DEEP_SLEEP_1);
+    }
+    else
+    {
+        weact_epaper_wake(&p->dev);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t panel_ssd1680_disp_on_off(esp_lcd_panel_t *panel, bool on_off)
+{
+    return panel_ssd1680_disp_sleep(panel, !on_off);
+}
+
+static esp_err_t panel_ssd1680_del(esp_lcd_panel_t *panel)
+{
+    ssd1680_panel_t *p = __containerof(panel, ssd1680_panel_t, base);
+
+    // Waits for a running refresh; the transport is the panel's, not the driver's
+    weact_epaper_deinit(&p->dev);
+    p->transport->del(p->transport);
+
+    heap_caps_free(p->scratch);
+    free(p);
+    return ESP_OK;
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+esp_err_t esp_lcd_new_panel_ssd1680(const esp_lcd_panel_io_handle_t io,
+                                    const esp_lcd_panel_dev_config_t *panel_dev_config,
+                                    esp_lcd_panel_handle_t *ret_panel)
+{
+    esp_err_t ret = ESP_OK;
+    ssd1680_panel_t *p = NULL;
+
+    ESP_RETURN_ON_FALSE(io && panel_dev_config && ret_panel, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    const esp_lcd_ssd1680_config_t *vendor = panel_dev_config->vendor_config;
+    ESP_RETURN_ON_FALSE(vendor, ESP_ERR_INVALID_ARG, TAG, "vendor_config with busy_gpio_num required");
+    ESP_RETURN_ON_FALSE(panel_dev_config->bits_per_pixel == 0 || panel_dev_config->bits_per_pixel == 1,
+                        ESP_ERR_INVALID_ARG, TAG, "only 1 bit per pixel");
+
+    p = calloc(1, sizeof(ssd1680_panel_t));
+    ESP_RETURN_ON_FALSE(p, ESP_ERR_NO_MEM, TAG, "no memory for panel");
+
+    p->reset_gpio = (gpio_num_t)panel_dev_config->reset_gpio_num;
+    p->on_refresh_done = vendor->on_refresh_done;
+    p->user_ctx = vendor->user_ctx;
+
+    p->transport = weact_epaper_transport_new_panel_io(io, p->reset_gpio, panel_dev_config->flags.reset_active_high,
+                                                       vendor->busy_gpio_num);
+    ESP_GOTO_ON_FALSE(p->transport, ESP_ERR_NO_MEM, err, TAG, "no memory for panel IO transport");
+
+    // No panel traffic yet: esp_lcd_panel_reset() and esp_lcd_panel_init() follow
+    const weact_epaper_config_t config = {
+        .pin_rst = p->reset_gpio,
+        .pin_busy = vendor->busy_gpio_num,
+        .transport = p->transport,
+    };
+    ESP_GOTO_ON_FALSE(weact_epaper_setup(&p->dev, &config), ESP_ERR_NO_MEM, err, TAG, "driver setup failed");
+
+    p->base.reset = panel_ssd1680_reset;
+    p->base.init = panel_ssd1680_init;
+    p->base.draw_bitmap = panel_ssd1680_draw_bitmap;
+    p->base.mirror = panel_ssd1680_mirror;
+    p->base.swap_xy = panel_ssd1680_swap_xy;
+    p->base.set_gap = panel_ssd1680_set_gap;
+    p->base.invert_color = panel_ssd1680_invert_color;
+    p->base.disp_on_off = panel_ssd1680_disp_on_off;
+    p->base.disp_sleep = panel_ssd1680_disp_sleep;
+    p->base.del = panel_ssd1680_del;
+
+    *ret_panel = &p->base;
+    ESP_LOGI(TAG, "SSD1680 panel created (BUSY=%d, RST=%d)", vendor->busy_gpio_num, p->reset_gpio);
+    return ESP_OK;
+
+err:
+    if (p->transport != NULL)
+    {
+        p->transport->del(p->transport);
+    }
+    free(p);
+    return ret;
+}
+
+esp_err_t esp_lcd_ssd1680_refresh(esp_lcd_panel_handle_t panel, bool wait)
+{
+    ssd1680_panel_t *p = __containerof(panel, ssd1680_panel_t, base);
+    weact_epaper_t *dev = &p->dev;
+
+    if (!wait && p->on_refresh_done != NULL)
+    {
+        // A running refresh's edge must not be taken for this one
+        if (weact_epaper_is_busy(dev))
+        {
+            weact_epaper_wait_until_idle(dev);
+        }
+
+        p->refresh_armed = true;
+        esp_err_t err = dev->transport->set_busy_callback(dev->transport, ssd1680_busy_isr, p);
+        if (err != ESP_OK)
+        {
+            p->refresh_armed = false;
+            ESP_LOGE(TAG, "BUSY interrupt failed (%s)", esp_err_to_name(err));
+            return err;
+        }
+    }
+
+    // Standard profile, OTP waveform (0xF7); waits for a running refresh first
+    weact_epaper_activate(dev);
+
+    if (!wait)
+    {
+        return ESP_OK;
+    }
+
+    weact_epaper_wait_until_idle(dev);
+    ESP_RETURN_ON_FALSE(!weact_epaper_is_busy(dev), ESP_ERR_TIMEOUT, TAG, "BUSY still high after the refresh timeout");
+    return ESP_OK;
+}
+
+weact_epaper_t *esp_lcd_ssd1680_get_device(esp_lcd_panel_handle_t panel)
+{
+    return &__containerof(panel, ssd1680_panel_t, base)->dev;
+}
@@ -0,0 +1,124 @@
+#ifndef ESP_LCD_PANEL_SSD1680_H
+#define ESP_LCD_PANEL_SSD1680_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_vendor.h"
+#include "driver/gpio.h"
+#include "weact_epaper_2in13.h"
+
+/**
+ * @brief SSD1680 as an esp_lcd panel
+ *
+ * The weact_epaper_* driver behind the esp_lcd panel interface, for
+ * applications built on esp_lcd: the panel IO (esp_lcd_new_panel_io_spi()
+ * with lcd_cmd_bits = 8, lcd_param_bits = 8 and dc_gpio_num set) handles
+ * DC, queues color transfers with DMA and reports on_color_trans_done for
+ * each RAM write. Each panel runs a weact_epaper_t on
+ * weact_epaper_transport_new_panel_io():
+ *
+ * - esp_lcd_panel_reset() / esp_lcd_panel_init(): reset and register setup
+ * - esp_lcd_panel_draw_bitmap(): windowed write into BW RAM, 1 bit per
+ *   pixel, MSB = leftmost, 1 = white. x_start and x_end must be multiples
+ *   of 8 (or x_end = 122). No refresh: call esp_lcd_ssd1680_refresh().
+ * - esp_lcd_panel_mirror(): y through the gate scan direction (TB bit of
+ *   Driver Output Control), x through X-decrement data entry plus per-byte
+ *   bit reversal. X mirrors around the 128-pixel RAM width, so the visible
+ *   columns become x = 6..127.
+ * - esp_lcd_panel_swap_xy(): Y-first address counter (data entry AM bit);
+ *   bitmap bytes are then column-major, still 8 horizontal pixels each.
+ * - esp_lcd_panel_invert_color(): RAM inversion (Display Update Control 1)
+ * - esp_lcd_panel_disp_on_off() / esp_lcd_panel_disp_sleep(): deep sleep
+ *   mode 1 and wake (needs the reset GPIO; RAM is kept). Drawing or
+ *   refreshing wakes the panel as well.
+ *
+ * esp_lcd_ssd1680_get_device() gives access to the driver for stats,
+ * energy, temperature, refresh profiles and auto sleep (deep sleep 1 only:
+ * the driver cannot restore RAM written through draw_bitmap). Its
+ * full-frame functions (weact_epaper_display_frame(), display_diff, pages,
+ * modes) write RAM from address 0 and need the default orientation (no
+ * mirror, no swap_xy).
+ */
+
+/**
+ * @brief Called from the BUSY interrupt when a refresh has finished
+ *
+ * Only for refreshes started with esp_lcd_ssd1680_refresh(panel, false);
+ * resets, wake and refreshes with wait = true do not call it. Runs in ISR
+ * context.
+ *
+ * @param panel Panel handle
+ * @param user_ctx esp_lcd_ssd1680_config_t::user_ctx
+ * @return true if a higher priority task was woken
+ */
+typedef bool (*esp_lcd_ssd1680_refresh_done_cb_t)(esp_lcd_panel_handle_t panel, void *user_ctx);
+
+/**
+ * @brief Vendor config (esp_lcd_panel_dev_config_t::vendor_config)
+ */
+typedef struct {
+    gpio_num_t busy_gpio_num;                        // BUSY input (HIGH = busy)
+    esp_lcd_ssd1680_refresh_done_cb_t on_refresh_done; // Optional, installs the GPIO ISR service if needed
+    void *user_ctx;                                  // Passed to on_refresh_done
+} esp_lcd_ssd1680_config_t;
+
+/**
+ * @brief Create an SSD1680 panel on an esp_lcd panel IO
+ *
+ * @param io Panel IO (SPI, 8-bit commands and parameters)
+ * @param panel_dev_config reset_gpio_num, flags.reset_active_high and a
+ *        vendor_config pointing to esp_lcd_ssd1680_config_t
+ * @param ret_panel Returned panel handle
+ * @return ESP_OK, ESP_ERR_INVALID_ARG or ESP_ERR_NO_MEM
+ */
+esp_err_t esp_lcd_new_panel_ssd1680(const esp_lcd_panel_io_handle_t io,
+                                    const esp_lcd_panel_dev_config_t *panel_dev_config,
+                                    esp_lcd_panel_handle_t *ret_panel);
+
+/**
+ * @brief Show the RAM content (full OTP waveform, 0xF7)
+ *
+ * weact_epaper_activate() on the panel's device: waits for a running
+ * refresh first and follows its refresh profile (standard unless changed
+ * through esp_lcd_ssd1680_get_device()).
+ *
+ * @param panel Panel handle
+ * @param wait true = return after BUSY went low; false = return at once,
+ *        completion is reported through on_refresh_done
+ * @return ESP_OK, ESP_ERR_TIMEOUT if BUSY stayed high, or the GPIO error
+ *         if the BUSY interrupt could not be installed
+ */
+esp_err_t esp_lcd_ssd1680_refresh(esp_lcd_panel_handle_t panel, bool wait);
+
+/**
+ * @brief Driver instance behind a panel
+ *
+ * Valid until esp_lcd_panel_del(). Do not call weact_epaper_deinit() on it.
+ *
+ * @param panel Panel handle
+ * @return Device handle
+ */
+weact_epaper_t *esp_lcd_ssd1680_get_device(esp_lcd_panel_handle_t panel);
+
+/**
+ * @brief weact_epaper_transport_t on an esp_lcd panel IO
+ *
+ * Commands and short parameters go through esp_lcd_panel_io_tx_param(),
+ * RAM data is queued through esp_lcd_panel_io_tx_color(), which splits it
+ * at the bus max_transfer_sz. BUSY and RST are plain GPIOs. The panel
+ * above runs on it. As weact_epaper_config_t::transport (or the transport
+ * of lvgl_weact_epaper's config) it also puts weact_epaper_init() on a bus
+ * the application already drives through esp_lcd. Register reads need a panel IO that can
+ * read (3-wire: flags.sio_mode).
+ *
+ * @param io Panel IO (8-bit commands and parameters, dc_gpio_num set); not deleted with the transport
+ * @param pin_rst Reset output, GPIO_NUM_NC = none
+ * @param rst_active_high Reset pin polarity
+ * @param pin_busy BUSY input (HIGH = busy)
+ * @return Transport, NULL on failure
+ */
+weact_epaper_transport_t *weact_epaper_transport_new_panel_io(esp_lcd_panel_io_handle_t io, gpio_num_t pin_rst,
+                                                              bool rst_active_high, gpio_num_t pin_busy);
+
+#endif // ESP_LCD_PANEL_SSD1680_H
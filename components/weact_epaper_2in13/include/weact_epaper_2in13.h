@@ -5,6 +5,13 @@
 #include <stdbool.h>
 #include "driver/spi_master.h"
 #include "driver/gpio.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "weact_epaper_transport.h"
+#include "weact_epaper_trace.h"
 
 /**
  * @brief SSD1680 E-Paper Display Low-Level Driver
@@ -32,6 +39,21 @@
 #define WEACT_EPAPER_WIDTH_BYTES 16      // Bytes per row (round up 122/8 = 15.25 to 16)
 #define WEACT_EPAPER_BUFFER_SIZE (WEACT_EPAPER_WIDTH_BYTES * WEACT_EPAPER_HEIGHT)  // 16 * 250 = 4000 bytes
 
+// 4-level grayscale framebuffer: 2 bits per pixel, 4 pixels per byte (MSB = leftmost)
+#define WEACT_EPAPER_GRAY_WIDTH_BYTES 32      // 2 * WEACT_EPAPER_WIDTH_BYTES
+#define WEACT_EPAPER_GRAY_BUFFER_SIZE (WEACT_EPAPER_GRAY_WIDTH_BYTES * WEACT_EPAPER_HEIGHT)  // 32 * 250 = 8000 bytes
+
+// Drawing colors
+#define WEACT_EPAPER_COLOR_WHITE     0
+#define WEACT_EPAPER_COLOR_BLACK     1
+#define WEACT_EPAPER_COLOR_RED       2       // Tri-color panels; black elsewhere
+
+// Gray levels (luminance order)
+#define WEACT_EPAPER_GRAY_BLACK      0
+#define WEACT_EPAPER_GRAY_DARK       1
+#define WEACT_EPAPER_GRAY_LIGHT      2
+#define WEACT_EPAPER_GRAY_WHITE      3
+
 // =============================================================================
 // SSD1680 COMMAND DEFINITIONS
 // =============================================================================
@@ -44,6 +66,7 @@
 #define WEACT_EPAPER_CMD_SW_RESET                        0x12
 #define WEACT_EPAPER_CMD_TEMP_SENSOR_CONTROL             0x18
 #define WEACT_EPAPER_CMD_TEMP_SENSOR_WRITE               0x1A
+#define WEACT_EPAPER_CMD_TEMP_SENSOR_READ                0x1B
 #define WEACT_EPAPER_CMD_MASTER_ACTIVATION               0x20
 #define WEACT_EPAPER_CMD_DISPLAY_UPDATE_CONTROL_1        0x21
 #define WEACT_EPAPER_CMD_DISPLAY_UPDATE_CONTROL_2        0x22
@@ -55,6 +78,7 @@
 #define WEACT_EPAPER_CMD_WRITE_VCOM_REGISTER             0x2C
 #define WEACT_EPAPER_CMD_OTP_REGISTER_READ               0x2D
 #define WEACT_EPAPER_CMD_WRITE_LUT_REGISTER              0x32
+#define WEACT_EPAPER_CMD_END_OPTION                      0x3F
 #define WEACT_EPAPER_CMD_DUMMY_LINE_PERIOD               0x3A
 #define WEACT_EPAPER_CMD_GATE_LINE_WIDTH                 0x3B
 #define WEACT_EPAPER_CMD_BORDER_WAVEFORM_CONTROL         0x3C
@@ -81,15 +105,219 @@ typedef struct {
     gpio_num_t pin_rst;     // Reset (active LOW)
     gpio_num_t pin_busy;    // Busy signal (HIGH=busy)
     int spi_clock_speed_hz; // SPI clock speed (typically 4-20 MHz)
+    spi_host_device_t spi_host; // SPI host (SPI2_HOST or SPI3_HOST; 0 = SPI2_HOST)
+    bool spi_bus_initialized;   // true = the application owns the bus (already initialized), only a device is added
+    size_t spi_chunk_size;      // Longest SPI transaction in bytes; the bus is released between chunks (0 = whole frame, capped at the bus max_transfer_sz)
+    weact_epaper_transport_t *transport; // Hardware access; NULL = SPI transport from the pins above
+    size_t trace_size;          // Bus trace ring buffer in bytes (0 = no trace), see weact_epaper_trace.h
 } weact_epaper_config_t;
 
+/**
+ * @brief SPI + GPIO transport (ESP-IDF)
+ *
+ * Configures the DC/RST/BUSY pins, initializes the SPI bus unless
+ * spi_bus_initialized is set (refcounted between instances) and adds a
+ * half-duplex 3-wire device. The first instance on a host sizes the bus for
+ * its spi_chunk_size; later instances and application-owned buses keep
+ * their max_transfer_sz, and the driver chunks no larger than it. weact_epaper_init() calls this when
+ * config->transport is NULL.
+ *
+ * @param config Pin and bus configuration
+ * @return Transport, NULL on failure
+ */
+weact_epaper_transport_t *weact_epaper_transport_new_spi(const weact_epaper_config_t *config);
+
+/**
+ * @brief Framebuffer / refresh mode
+ */
+typedef enum {
+    WEACT_EPAPER_MODE_BW = 0,   // 1 bit per pixel, OTP waveform (default)
+    WEACT_EPAPER_MODE_GRAY4,    // 2 bits per pixel, both RAM banks + gray LUT
+    WEACT_EPAPER_MODE_BWR,      // Tri-color panel: BW RAM + RED RAM (1 = red)
+} weact_epaper_mode_t;
+
+/**
+ * @brief RAM bank option applied at refresh time (Display Update Control 1)
+ *
+ * Applied by the controller while it reads RAM for a refresh, so the RAM
+ * contents and the host framebuffer are left untouched.
+ */
+typedef enum {
+    WEACT_EPAPER_RAM_NORMAL = 0x0,    // Use RAM content as is
+    WEACT_EPAPER_RAM_BYPASS_0 = 0x4,  // Ignore RAM, read every bit as 0
+    WEACT_EPAPER_RAM_INVERT = 0x8,    // Invert RAM content
+} weact_epaper_ram_option_t;
+
+/**
+ * @brief RAM bank used as a display page (black/white mode only)
+ */
+typedef enum {
+    WEACT_EPAPER_PAGE_0 = 0,    // BW RAM
+    WEACT_EPAPER_PAGE_1 = 1,    // RED RAM
+} weact_epaper_page_t;
+
+/**
+ * @brief Refresh profile (what each update sequence includes)
+ */
+typedef enum {
+    WEACT_EPAPER_PROFILE_STANDARD = 0, // Every refresh: power up, temperature, LUT, display, power down (0xF7)
+    WEACT_EPAPER_PROFILE_BURST,        // Temperature + LUT once, analog stays on, off after idle timeout
+} weact_epaper_refresh_profile_t;
+
+/**
+ * @brief Controller power state
+ */
+typedef enum {
+    WEACT_EPAPER_POWER_ACTIVE = 0,     // Display update running (BUSY high)
+    WEACT_EPAPER_POWER_ANALOG_ON,      // Idle, analog circuits kept on (burst profile)
+    WEACT_EPAPER_POWER_IDLE,           // Idle, clock and analog off, registers and RAM kept
+    WEACT_EPAPER_POWER_DEEP_SLEEP_1,   // Deep sleep, RAM kept, wake needs a reset
+    WEACT_EPAPER_POWER_DEEP_SLEEP_2,   // Deep sleep, RAM lost, lowest current
+} weact_epaper_power_state_t;
+
+#define WEACT_EPAPER_POWER_STATES (WEACT_EPAPER_POWER_DEEP_SLEEP_2 + 1)
+
+/**
+ * @brief Panel supply current per power state, for the energy estimate
+ *
+ * Defaults (weact_epaper_default_currents()) are typical SSD1680 2.13"
+ * figures; measure the panel at hand for real numbers.
+ */
+typedef struct {
+    float state_ua[WEACT_EPAPER_POWER_STATES]; // Indexed by weact_epaper_power_state_t
+    float spi_ua;               // Extra current while SPI is clocking
+} weact_epaper_currents_t;
+
+/**
+ * @brief Energy accounting (see weact_epaper_get_energy())
+ */
+typedef struct {
+    uint32_t full_refreshes;    // OTP waveform, display mode 1
+    uint32_t partial_refreshes; // Display mode 2 (differential)
+    uint32_t lut_refreshes;     // Custom LUT (grayscale, pages)
+    uint32_t power_offs;        // Analog off after a burst
+    uint64_t busy_us;           // BUSY time of all refreshes
+    uint64_t analog_on_us;      // Analog circuits on (refreshing or burst idle)
+    uint64_t state_us[WEACT_EPAPER_POWER_STATES]; // Time in each power state
+    uint64_t spi_bytes;
+    uint64_t spi_us;            // SPI clocking time at the configured clock
+    uint64_t elapsed_us;        // Since init or the last reset
+    float charge_uah;           // Estimated charge drawn by the panel
+    float update_uah_last;      // Last update: refresh plus its SPI traffic
+    float update_uah_mean;
+    float uah_per_hour;         // Average over elapsed_us, scaled to one hour
+} weact_epaper_energy_t;
+
+// Update timing histogram: bucket i counts durations below 4^i ms, the
+// last one everything from 4096 ms up
+#define WEACT_EPAPER_STATS_BUCKETS 8
+
+/**
+ * @brief Durations of one update phase
+ */
+typedef struct {
+    uint32_t last_us;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint32_t mean_us;
+    uint64_t total_us;
+    uint32_t count;
+    uint32_t buckets[WEACT_EPAPER_STATS_BUCKETS]; // < 1, 4, 16, 64, 256, 1024, 4096 ms, rest
+} weact_epaper_phase_stats_t;
+
+/**
+ * @brief Update timing and SPI traffic (see weact_epaper_get_stats())
+ */
+typedef struct {
+    weact_epaper_phase_stats_t upload;   // RAM writes (framebuffer, changed rows, page)
+    weact_epaper_phase_stats_t activate; // LUT, update sequence and MASTER_ACTIVATION
+    weact_epaper_phase_stats_t busy;     // MASTER_ACTIVATION to BUSY low
+    weact_epaper_phase_stats_t update;   // Update start (first upload or marked start) to BUSY low
+    uint64_t spi_bytes;                  // Command and data bytes sent, register bytes read
+    uint32_t spi_transactions;
+} weact_epaper_stats_t;
+
+/**
+ * @brief Asynchronous init steps (see weact_epaper_init_async())
+ */
+typedef enum {
+    WEACT_EPAPER_INIT_RESET = 0,   // Hardware reset pulse, wait for BUSY
+    WEACT_EPAPER_INIT_SW_RESET,    // SW reset, wait for BUSY
+    WEACT_EPAPER_INIT_CONFIG,      // Configuration registers
+    WEACT_EPAPER_INIT_FILL_RED,    // RED RAM auto-filled white, wait for BUSY
+    WEACT_EPAPER_INIT_FILL_BW,     // BW RAM auto-filled white, wait for BUSY
+    WEACT_EPAPER_INIT_DONE,
+} weact_epaper_init_state_t;
+
 /**
  * @brief SSD1680 device handle
  */
 typedef struct {
-    spi_device_handle_t spi;
+    weact_epaper_transport_t *transport; // SPI, GPIO and clock access
+    bool owns_transport;    // Created by the driver (deleted in weact_epaper_deinit())
+    weact_epaper_trace_t *trace; // Bus trace (config.trace_size > 0), deleted in weact_epaper_deinit()
+    size_t chunk_size;      // Longest SPI transaction in bytes
     weact_epaper_config_t config;
-    uint8_t *framebuffer;   // Pointer to framebuffer in memory
+    uint8_t *framebuffer;   // Pointer to framebuffer in memory (BW RAM image)
+    weact_epaper_mode_t mode;
+    uint8_t *framebuffer_red; // RED RAM image (GRAY4/BWR, allocated on demand)
+    uint8_t *gray_buffer;   // 2bpp framebuffer (GRAY4 mode only)
+    const uint8_t *loaded_lut; // Custom LUT in the LUT register, NULL = OTP waveform
+    uint8_t update_control_1; // Last DISPLAY_UPDATE_CONTROL_1 A byte (RED << 4 | BW option)
+    uint8_t data_entry_mode; // DATA_ENTRY_MODE value (0x03; other values only through the esp_lcd panel)
+    uint8_t gate_scan;      // DRIVER_OUTPUT_CONTROL gate scan byte (0x00; TB set by the esp_lcd panel's mirror)
+    bool inverted;          // Dark mode (visible bank inverted)
+    int8_t page;            // Page being shown, -1 = page mode off
+    uint8_t pages_loaded;   // Bit n: page n is in its RAM bank (see weact_epaper_page_show())
+    esp_timer_handle_t activation_timer; // Deadline-aligned activation (created on demand)
+    volatile bool activation_pending;    // Scheduled activation has not fired yet
+    int64_t activation_at_us;            // esp_timer time the pending activation is due
+    volatile int64_t activated_at_us;    // esp_timer time of the last MASTER_ACTIVATION
+    uint8_t armed_sequence; // DISPLAY_UPDATE_CONTROL_2 value waiting for activation
+
+    // Refresh profile state
+    weact_epaper_refresh_profile_t profile;
+    uint32_t idle_power_off_ms; // Burst: analog off after this much idle time (0 = never)
+    uint32_t lut_reload_ms;     // Burst: reload temperature + LUT after this age (0 = never)
+    bool analog_on;             // Analog circuits left on by the last sequence
+    bool otp_lut_loaded;        // OTP waveform is in the LUT register
+    int64_t otp_lut_loaded_at_us;
+    esp_timer_handle_t power_timer; // Idle power-off (created on demand)
+    SemaphoreHandle_t lock;     // Serialises command sequences with timer callbacks
+
+    // Cached temperature (what is in the controller's temperature register)
+    int16_t temperature_x16;    // 1/16 °C
+    int64_t temperature_at_us;  // When it was written or read
+    uint32_t temperature_ttl_ms; // Validity, 0 = until replaced
+    bool temperature_valid;
+
+    // Power state machine
+    volatile weact_epaper_power_state_t power_state;
+    uint32_t auto_sleep_ms;     // Deep sleep after this much idle time (0 = off)
+    weact_epaper_power_state_t auto_sleep_state; // DEEP_SLEEP_1 or DEEP_SLEEP_2
+    esp_timer_handle_t sleep_timer; // Auto-sleep (created on demand)
+    bool ram_valid;             // Controller RAM holds the framebuffer (false after deep sleep 2)
+    bool diff_base_valid;       // Both RAM banks hold the displayed image (differential refresh)
+
+    // Asynchronous init
+    TaskHandle_t init_task;     // Runs the init state machine (NULL when done)
+    EventGroupHandle_t ready;   // Ready bit, NULL after blocking init
+    volatile weact_epaper_init_state_t init_state;
+    bool init_clear;            // Fill both RAM banks white during init
+    bool init_busy_irq;         // BUSY edges wake the init task (else it polls)
+
+    // Update timing (see weact_epaper_get_stats())
+    weact_epaper_stats_t stats;
+    int64_t update_start_us;    // Start of the update in progress, 0 = none
+
+    // Energy accounting (see weact_epaper_get_energy())
+    weact_epaper_currents_t currents;
+    weact_epaper_energy_t energy; // Counters; state time up to power_state_since_us
+    int64_t power_state_since_us; // Entry into the current power state
+    int64_t energy_since_us;      // Accounting start
+    uint64_t update_spi_bytes;    // stats.spi_bytes when the update in progress started
+    float update_uah_total;       // Sum over updates, for the mean
+    uint32_t update_count;
 } weact_epaper_t;
 
 // =============================================================================
@@ -99,12 +327,58 @@ typedef struct {
 /**
  * @brief Initialize the SSD1680 display
  *
+ * On failure everything set up so far is released again.
+ *
  * @param dev Pointer to device handle
  * @param config Pointer to pin configuration
  * @return true on success, false on failure
  */
 bool weact_epaper_init(weact_epaper_t *dev, const weact_epaper_config_t *config);
 
+/**
+ * @brief Release an instance (SPI device, bus reference, timers, buffers)
+ *
+ * Waits for a running init or refresh. The bus is freed with its last
+ * driver-initialized user; a bus owned by the application stays up, and so
+ * does a transport passed in the config. The handle can be passed to
+ * weact_epaper_init() again afterwards. Calling it again, or on a handle
+ * whose init failed, releases nothing twice.
+ *
+ * @param dev Device handle
+ */
+void weact_epaper_deinit(weact_epaper_t *dev);
+
+/**
+ * @brief Start initialization in the background
+ *
+ * Sets up GPIO, SPI and the framebuffer, then returns. Reset, SW reset and
+ * the register setup run as a state machine in a small task that sleeps
+ * on the BUSY falling-edge interrupt between steps, so the caller can
+ * build its UI meanwhile. Any call that talks to the panel waits for the
+ * init to finish first; drawing into the framebuffer does not. On failure
+ * everything set up so far is released again.
+ *
+ * @param dev Pointer to device handle
+ * @param config Pointer to pin configuration
+ * @param clear true = fill both RAM banks white (auto write pattern, no refresh)
+ * @return true if the init was started
+ */
+bool weact_epaper_init_async(weact_epaper_t *dev, const weact_epaper_config_t *config, bool clear);
+
+/**
+ * @brief Wait for an asynchronous init to finish
+ *
+ * @param dev Device handle
+ * @param timeout_ms Maximum wait (0 = just check)
+ * @return true when the panel is ready (always true after weact_epaper_init())
+ */
+bool weact_epaper_wait_ready(weact_epaper_t *dev, uint32_t timeout_ms);
+
+/**
+ * @brief Check whether init has finished
+ */
+bool weact_epaper_is_ready(weact_epaper_t *dev);
+
 /**
  * @brief Send a command to SSD1680
  *
@@ -157,7 +431,7 @@ void weact_epaper_clear_screen(weact_epaper_t *dev);
  * @param dev Device handle
  * @param x X coordinate (0 to WEACT_EPAPER_WIDTH-1)
  * @param y Y coordinate (0 to WEACT_EPAPER_HEIGHT-1)
- * @param color 1 = BLACK, 0 = WHITE
+ * @param color WEACT_EPAPER_COLOR_WHITE (0), _BLACK (1) or _RED (2)
  */
 void weact_epaper_draw_pixel(weact_epaper_t *dev, int x, int y, uint8_t color);
 
@@ -173,16 +447,385 @@ void weact_epaper_draw_pixel(weact_epaper_t *dev, int x, int y, uint8_t color);
  */
 void weact_epaper_draw_rectangle(weact_epaper_t *dev, int x0, int y0, int x1, int y1, bool filled);
 
+/**
+ * @brief Draw a rectangle in the framebuffer with a given color
+ *
+ * @param dev Device handle
+ * @param x0 Top-left X coordinate
+ * @param y0 Top-left Y coordinate
+ * @param x1 Bottom-right X coordinate
+ * @param y1 Bottom-right Y coordinate
+ * @param filled true = filled rectangle, false = outline only
+ * @param color WEACT_EPAPER_COLOR_WHITE, _BLACK or _RED
+ */
+void weact_epaper_draw_rectangle_color(weact_epaper_t *dev, int x0, int y0, int x1, int y1, bool filled,
+                                       uint8_t color);
+
+/**
+ * @brief Switch between black/white, 4-level grayscale and tri-color mode
+ *
+ * GRAY4 allocates the 2bpp framebuffer and the RED RAM plane on first use
+ * and fills them with white. In GRAY4 mode weact_epaper_draw_pixel() maps
+ * 1 to black and 0 to white so the other drawing functions keep working.
+ * BWR (black/white/red panels) allocates the red plane and clears it.
+ * Waits for a running refresh; the RAM options are re-sent for the new
+ * mode, so dark mode (weact_epaper_set_inverted()) carries over.
+ *
+ * @param dev Device handle
+ * @param mode New mode
+ * @return true on success, false if a buffer could not be allocated
+ */
+bool weact_epaper_set_mode(weact_epaper_t *dev, weact_epaper_mode_t mode);
+
+/**
+ * @brief Draw a gray pixel in the 2bpp framebuffer (GRAY4 mode)
+ *
+ * @param dev Device handle
+ * @param x X coordinate (0 to WEACT_EPAPER_WIDTH-1)
+ * @param y Y coordinate (0 to WEACT_EPAPER_HEIGHT-1)
+ * @param level WEACT_EPAPER_GRAY_BLACK (0) to WEACT_EPAPER_GRAY_WHITE (3)
+ */
+void weact_epaper_draw_pixel_gray(weact_epaper_t *dev, int x, int y, uint8_t level);
+
+/**
+ * @brief Split a 2bpp buffer into the two RAM bit planes
+ *
+ * Every two input bytes (8 pixels) produce one byte per plane. The high
+ * bit of each level goes to the BW RAM plane, the low bit to the RED RAM
+ * plane, which is the pairing the gray LUT expects.
+ *
+ * @param gray 2bpp input, 4 pixels per byte, MSB first
+ * @param gray_len Input length in bytes (multiple of 2)
+ * @param plane_bw Output BW RAM plane (gray_len / 2 bytes)
+ * @param plane_red Output RED RAM plane (gray_len / 2 bytes)
+ */
+void weact_epaper_gray4_split(const uint8_t *gray, size_t gray_len, uint8_t *plane_bw, uint8_t *plane_red);
+
 /**
  * @brief Send the framebuffer to the display and refresh
  *
+ * In GRAY4 mode the 2bpp framebuffer is split into both RAM banks and the
+ * refresh runs the gray LUT instead of the OTP waveform. In GRAY4 and BWR
+ * mode both planes go out as one queued SPI sequence.
+ *
  * @param dev Device handle
  */
 void weact_epaper_display_frame(weact_epaper_t *dev);
 
+/**
+ * @brief Stage the framebuffer in controller RAM without refreshing
+ *
+ * Does the color split (GRAY4) and the whole SPI upload, so a later
+ * weact_epaper_activate() has nothing but the refresh command left.
+ * Waits first if a refresh is running or scheduled.
+ *
+ * @param dev Device handle
+ */
+void weact_epaper_upload(weact_epaper_t *dev);
+
+/**
+ * @brief Start a refresh from the current RAM contents (non-blocking)
+ *
+ * Waits first if a refresh is running or scheduled. Follow with weact_epaper_wait_until_idle() or poll weact_epaper_is_busy().
+ *
+ * @param dev Device handle
+ */
+void weact_epaper_activate(weact_epaper_t *dev);
+
+/**
+ * @brief Refresh the panel from the current RAM contents and wait
+ *
+ * Runs the update sequence for the current mode without uploading
+ * anything, e.g. after weact_epaper_set_inverted().
+ *
+ * @param dev Device handle
+ */
+void weact_epaper_refresh(weact_epaper_t *dev);
+
+/**
+ * @brief Check whether a refresh is running or scheduled
+ *
+ * @param dev Device handle
+ * @return true while BUSY is high or a scheduled activation is pending
+ */
+bool weact_epaper_is_busy(weact_epaper_t *dev);
+
+/**
+ * @brief Activate the staged frame at an exact time
+ *
+ * Call after weact_epaper_upload(). The LUT and update sequence are sent
+ * immediately; at at_us (esp_timer_get_time() time base) an esp_timer
+ * callback sends the single MASTER_ACTIVATION byte. A deadline in the past
+ * activates at once. Waits first if a refresh is running or another
+ * activation is scheduled. Do not use the device until weact_epaper_is_busy()
+ * turns false or weact_epaper_wait_until_idle() returns.
+ *
+ * @param dev Device handle
+ * @param at_us Activation time in microseconds since boot
+ * @return true if the activation was scheduled (or done)
+ */
+bool weact_epaper_schedule_activation(weact_epaper_t *dev, int64_t at_us);
+
+/**
+ * @brief Set how each RAM bank is read at refresh time
+ *
+ * One command (3 bytes on the bus), sent once a running refresh is done.
+ * Takes effect on the next refresh and stays in effect until changed again.
+ *
+ * @param dev Device handle
+ * @param bw BW RAM option
+ * @param red RED RAM option
+ */
+void weact_epaper_set_ram_options(weact_epaper_t *dev, weact_epaper_ram_option_t bw, weact_epaper_ram_option_t red);
+
+/**
+ * @brief Invert the displayed image (dark mode) without touching RAM
+ *
+ * Inverts the BW bank (both banks in GRAY4 mode, so gray levels invert too).
+ * Follow with weact_epaper_refresh() to show it; no framebuffer upload needed.
+ *
+ * @param dev Device handle
+ * @param inverted true = dark mode
+ */
+void weact_epaper_set_inverted(weact_epaper_t *dev, bool inverted);
+
+/**
+ * @brief Upload a complete screen into one RAM bank without refreshing
+ *
+ * Black/white mode only. Preload both pages once, then flip between them
+ * with weact_epaper_page_show() without any further SPI upload.
+ *
+ * @param dev Device handle
+ * @param page Target bank
+ * @param image WEACT_EPAPER_BUFFER_SIZE bytes, same format as the framebuffer
+ *              (e.g. dev->framebuffer after drawing)
+ * @return false if the current mode needs the RED RAM
+ */
+bool weact_epaper_page_load(weact_epaper_t *dev, weact_epaper_page_t page, const uint8_t *image);
+
+/**
+ * @brief Show a preloaded page
+ *
+ * Bypasses the other bank through Display Update Control 1 and refreshes
+ * with the page LUT. Costs one command plus a refresh; RAM is untouched.
+ * The next weact_epaper_display_frame() leaves page mode.
+ *
+ * The page must still be in its bank. Anything else written to that bank
+ * (a frame, a differential refresh, a clear) replaces it, and deep sleep 2
+ * loses both pages. The driver does not keep copies to restore them, so
+ * page_show() then fails and the page has to be loaded again.
+ *
+ * @param dev Device handle
+ * @param page Bank to show
+ * @return false if the current mode needs the RED RAM or the page is no
+ *         longer in its bank
+ */
+bool weact_epaper_page_show(weact_epaper_t *dev, weact_epaper_page_t page);
+
+/**
+ * @brief Select the refresh profile
+ *
+ * STANDARD (default) powers up, reads the temperature, loads the OTP LUT
+ * and powers down on every refresh. BURST does the temperature + LUT load
+ * once, keeps the analog circuits on between refreshes and switches them
+ * off after idle_power_off_ms without a refresh, so a burst of
+ * button-driven updates skips those fixed costs. Custom LUT modes (GRAY4,
+ * pages) never reload the OTP LUT.
+ *
+ * @param dev Device handle
+ * @param profile Refresh profile
+ * @param idle_power_off_ms BURST: idle time before analog power-off (0 = keep on)
+ * @param lut_reload_ms BURST: reload temperature + LUT when older than this (0 = never)
+ * @return false if the idle timer could not be created
+ */
+bool weact_epaper_set_refresh_profile(weact_epaper_t *dev, weact_epaper_refresh_profile_t profile,
+                                      uint32_t idle_power_off_ms, uint32_t lut_reload_ms);
+
+/**
+ * @brief Differential refresh against the image currently on the panel
+ *
+ * Uses the display mode 2 waveform, which only drives pixels that differ
+ * between BW RAM (new) and RED RAM (old): no flashing. Only the RAM rows
+ * that changed are written when both banks already hold the old image.
+ * Black/white mode only; other modes fall back to
+ * weact_epaper_display_frame(). Ghosting builds up over many differential
+ * refreshes, so do a full one from time to time.
+ *
+ * @param dev Device handle
+ * @param previous Image on the panel (WEACT_EPAPER_BUFFER_SIZE bytes)
+ * @return false if nothing changed (no refresh done)
+ */
+bool weact_epaper_display_diff(weact_epaper_t *dev, const uint8_t *previous);
+
+/**
+ * @brief First and last framebuffer row that differ between two images
+ *
+ * @param image New image (WEACT_EPAPER_BUFFER_SIZE bytes)
+ * @param previous Old image
+ * @param row0 Output, first changed row
+ * @param row1 Output, last changed row
+ * @return false if the images are identical
+ */
+bool weact_epaper_diff_rows(const uint8_t *image, const uint8_t *previous, int *row0, int *row1);
+
+/**
+ * @brief FNV-1a hash of a framebuffer (change and corruption checks)
+ */
+uint32_t weact_epaper_hash(const uint8_t *data, size_t len);
+
+/**
+ * @brief Restore the framebuffer after a warm boot (no SPI traffic)
+ *
+ * @param dev Device handle
+ * @param image Image on the panel (WEACT_EPAPER_BUFFER_SIZE bytes)
+ * @param panel_ram_valid Both RAM banks still hold image (panel was kept
+ *        powered in deep sleep 1 and only reset since)
+ */
+void weact_epaper_restore(weact_epaper_t *dev, const uint8_t *image, bool panel_ram_valid);
+
+/**
+ * @brief Write an externally measured temperature (TEMP_SENSOR_WRITE)
+ *
+ * While the value is valid, refreshes skip the internal sensor conversion
+ * and the controller selects the OTP waveform for this temperature. Once
+ * it expires, refreshes read the internal sensor again.
+ *
+ * @param dev Device handle
+ * @param celsius Temperature in °C (1/16 °C resolution)
+ * @param ttl_ms How long the value stays valid (0 = until replaced)
+ */
+void weact_epaper_set_temperature(weact_epaper_t *dev, float celsius, uint32_t ttl_ms);
+
+/**
+ * @brief Measure with the internal sensor and read the result back
+ *
+ * Runs a temperature-only update sequence (0xA1) and reads the
+ * temperature register over SDA. The reading is cached like an external one.
+ *
+ * @param dev Device handle
+ * @param celsius Output temperature in °C (may be NULL)
+ * @param ttl_ms How long the cached value stays valid (0 = until replaced)
+ * @return false if the controller did not answer
+ */
+bool weact_epaper_read_temperature(weact_epaper_t *dev, float *celsius, uint32_t ttl_ms);
+
+/**
+ * @brief Get the cached temperature for waveform/policy decisions
+ *
+ * @param dev Device handle
+ * @param celsius Output temperature in °C
+ * @return false if there is no valid cached value
+ */
+bool weact_epaper_get_temperature(weact_epaper_t *dev, float *celsius);
+
+/**
+ * @brief Enter deep sleep 1 or 2
+ *
+ * Waits for a running refresh first. Any later call that needs the
+ * controller (upload, refresh, clear...) wakes it transparently; RAM
+ * options and temperature set while asleep are sent on wake.
+ *
+ * @param dev Device handle
+ * @param state WEACT_EPAPER_POWER_DEEP_SLEEP_1 (RAM kept) or _2 (RAM lost)
+ */
+void weact_epaper_enter_sleep(weact_epaper_t *dev, weact_epaper_power_state_t state);
+
+/**
+ * @brief Wake from deep sleep now
+ *
+ * Short reset pulse plus the configuration registers from the cached
+ * state (no SW reset, no RAM upload). No-op when awake.
+ *
+ * @param dev Device handle
+ */
+void weact_epaper_wake(weact_epaper_t *dev);
+
+/**
+ * @brief Enter deep sleep automatically after an idle time
+ *
+ * The timer restarts after every refresh.
+ *
+ * @param dev Device handle
+ * @param idle_ms Idle time before sleeping (0 = off)
+ * @param state WEACT_EPAPER_POWER_DEEP_SLEEP_1 or _2
+ * @return false if the timer could not be created
+ */
+bool weact_epaper_set_auto_sleep(weact_epaper_t *dev, uint32_t idle_ms, weact_epaper_power_state_t state);
+
+/**
+ * @brief Current power state
+ */
+weact_epaper_power_state_t weact_epaper_get_power_state(weact_epaper_t *dev);
+
+/**
+ * @brief Update timing and SPI traffic since init or the last reset
+ *
+ * Each update is split into upload, activation and BUSY time; the update
+ * phase runs from the first RAM write (or weact_epaper_mark_update_start())
+ * to BUSY low. BUSY low is seen when the driver waits for it or polls
+ * weact_epaper_is_busy(), every 10 ms while waiting.
+ *
+ * @param dev Device handle
+ * @param stats Output
+ * @return false if dev is not initialized
+ */
+bool weact_epaper_get_stats(weact_epaper_t *dev, weact_epaper_stats_t *stats);
+
+/**
+ * @brief Clear the timing statistics, SPI counters and energy accounting
+ */
+void weact_epaper_reset_stats(weact_epaper_t *dev);
+
+/**
+ * @brief Typical SSD1680 2.13" panel currents
+ */
+weact_epaper_currents_t weact_epaper_default_currents(void);
+
+/**
+ * @brief Set the currents the energy estimate uses
+ *
+ * Applies to all time accounted so far, so policies can be compared on
+ * one run with different current figures.
+ *
+ * @param dev Device handle
+ * @param currents Current per power state and for SPI
+ */
+void weact_epaper_set_currents(weact_epaper_t *dev, const weact_epaper_currents_t *currents);
+
+/**
+ * @brief Estimated panel charge since init or weact_epaper_reset_stats()
+ *
+ * Counts refreshes by type, BUSY and analog-on time, time in each power
+ * state and SPI bytes, and turns them into charge with the configured
+ * currents: in total, per update and per hour at the observed mix.
+ *
+ * @param dev Device handle
+ * @param energy Output
+ * @return false if dev is not initialized
+ */
+bool weact_epaper_get_energy(weact_epaper_t *dev, weact_epaper_energy_t *energy);
+
+/**
+ * @brief Start timing the next update earlier than its first RAM write
+ *
+ * E.g. when rendering starts, so the update phase covers the whole
+ * path to the panel. Ignored while an update is in progress.
+ *
+ * @param dev Device handle
+ * @param at_us Start time (esp_timer_get_time() time base)
+ */
+void weact_epaper_mark_update_start(weact_epaper_t *dev, int64_t at_us);
+
+/**
+ * @brief Add one duration to phase statistics
+ */
+void weact_epaper_phase_stats_add(weact_epaper_phase_stats_t *stats, int64_t us);
+
 /**
  * @brief Enter deep sleep mode (low power)
  *
+ * Deep sleep 1; same as weact_epaper_enter_sleep(dev, WEACT_EPAPER_POWER_DEEP_SLEEP_1).
+ *
  * @param dev Device handle
  */
 void weact_epaper_sleep(weact_epaper_t *dev);
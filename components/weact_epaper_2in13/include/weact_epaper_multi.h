@@ -0,0 +1,61 @@
+#ifndef WEACT_EPAPER_MULTI_H
+#define WEACT_EPAPER_MULTI_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "weact_epaper_2in13.h"
+
+/**
+ * @brief Overlapped refresh of several SSD1680 panels
+ *
+ * Uploads go out one after the other (they share the SPI bus or at least
+ * the calling task), but each panel is activated as soon as its upload is
+ * done, so the next upload runs during the previous panel's refresh and
+ * all busy periods overlap. Activations are spaced by at least
+ * stagger_us so the boost converters of all panels never start together;
+ * the total time is about one refresh plus the uploads and offsets.
+ */
+
+/**
+ * @brief Per-panel timing of one overlapped refresh (esp_timer time base)
+ */
+typedef struct {
+    int64_t uploaded_at_us;  // Upload finished
+    int64_t activated_at_us; // MASTER_ACTIVATION sent
+    int64_t done_at_us;      // BUSY went low (or timeout)
+    bool timed_out;          // BUSY did not go low in time
+} weact_epaper_multi_result_t;
+
+/**
+ * @brief Called once per panel as soon as its refresh has completed
+ *
+ * @param dev Panel that finished
+ * @param index Index of the panel in the array passed in
+ * @param result Timing of that panel
+ * @param arg User argument
+ */
+typedef void (*weact_epaper_multi_done_cb_t)(weact_epaper_t *dev, size_t index,
+                                             const weact_epaper_multi_result_t *result, void *arg);
+
+/**
+ * @brief Refresh several panels with overlapped busy periods
+ *
+ * Returns when every panel has finished. Panels must be in a mode that
+ * weact_epaper_upload() supports; their framebuffers are drawn beforehand.
+ * The calling task sleeps on the BUSY interrupts when every panel's
+ * transport provides one and polls every millisecond otherwise.
+ *
+ * @param panels Panels to refresh
+ * @param count Number of panels
+ * @param stagger_us Minimum spacing between two activations (0 = none)
+ * @param results Per-panel timing, count entries (may be NULL)
+ * @param done_cb Completion callback (may be NULL)
+ * @param arg Passed to done_cb
+ * @return false if any panel timed out
+ */
+bool weact_epaper_multi_refresh(weact_epaper_t *const *panels, size_t count, uint32_t stagger_us,
+                                weact_epaper_multi_result_t *results,
+                                weact_epaper_multi_done_cb_t done_cb, void *arg);
+
+#endif // WEACT_EPAPER_MULTI_H
@@ -0,0 +1,168 @@
+#ifndef WEACT_EPAPER_TRACE_H
+#define WEACT_EPAPER_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "weact_epaper_transport.h"
+
+/**
+ * @brief Bus trace of an SSD1680 panel
+ *
+ * A trace sits between the driver and its transport and records every
+ * command, data burst, register read, DC level change, BUSY edge and RST
+ * change with a microsecond timestamp into a ring buffer; when the ring is
+ * full the oldest records are dropped. Set weact_epaper_config_t::trace_size
+ * to trace a panel from init on, or wrap any transport with
+ * weact_epaper_trace_new() yourself.
+ *
+ * BUSY edges are what the driver observes: levels it polls, plus the
+ * falling edges reported by the BUSY interrupt (at interrupt time).
+ *
+ * Traces dump as CSV or as a compact binary (written raw or as base64
+ * lines on the console), load back with weact_epaper_trace_load() and
+ * replay into any transport: the panel, or the SSD1680 model on the host.
+ */
+
+typedef enum {
+    WEACT_EPAPER_TRACE_COMMAND = 0, // value = command byte
+    WEACT_EPAPER_TRACE_DATA,        // Payload = data bytes
+    WEACT_EPAPER_TRACE_READ,        // value = command, payload = bytes read
+    WEACT_EPAPER_TRACE_DC,          // value = new DC level
+    WEACT_EPAPER_TRACE_BUSY,        // value = new BUSY level
+    WEACT_EPAPER_TRACE_RST,         // value = new RST level
+    WEACT_EPAPER_TRACE_MARK,        // value = application marker
+} weact_epaper_trace_type_t;
+
+/**
+ * @brief One record (12 bytes, followed by `stored` payload bytes)
+ */
+typedef struct {
+    uint32_t time_us;   // Since the trace was created or cleared (wraps after 71 min)
+    uint16_t len;       // Payload length on the bus
+    uint16_t stored;    // Payload bytes kept (< len when cut by data_limit)
+    uint8_t type;       // weact_epaper_trace_type_t
+    uint8_t value;
+    uint8_t reserved[2];
+} weact_epaper_trace_record_t;
+
+typedef enum {
+    WEACT_EPAPER_TRACE_CSV = 0,     // time_us,type,value,len,data (hex)
+    WEACT_EPAPER_TRACE_BINARY,      // Header + records, little-endian
+} weact_epaper_trace_format_t;
+
+/**
+ * @brief Binary trace header
+ */
+typedef struct {
+    char magic[4];          // "WEPT"
+    uint16_t version;       // 1
+    uint16_t record_size;   // sizeof(weact_epaper_trace_record_t)
+    uint32_t records;       // Records that follow
+    uint32_t dropped;       // Records lost to ring overflow before the first one
+} weact_epaper_trace_header_t;
+
+/**
+ * @brief Replay options
+ */
+typedef struct {
+    bool keep_timing;       // Keep the recorded gaps between transfers
+    bool wait_busy;         // At each recorded BUSY falling edge, wait for the target's BUSY
+    uint32_t busy_timeout_ms; // Longest BUSY wait (0 = the driver's own timeout, 10 s)
+} weact_epaper_trace_replay_config_t;
+
+typedef struct weact_epaper_trace_t weact_epaper_trace_t;
+
+typedef void (*weact_epaper_trace_write_fn_t)(void *ctx, const void *data, size_t len);
+
+/**
+ * @brief Start tracing a transport
+ *
+ * @param inner Transport the driver would otherwise use
+ * @param ring_size Ring buffer in bytes (a full frame upload takes 4012)
+ * @param data_limit Keep at most this many bytes of each payload (0 = all);
+ *                   cut payloads cannot be replayed byte for byte
+ * @param owns_inner Delete inner together with the trace
+ * @return Trace, NULL on failure
+ */
+weact_epaper_trace_t *weact_epaper_trace_new(weact_epaper_transport_t *inner, size_t ring_size, size_t data_limit,
+                                             bool owns_inner);
+
+/**
+ * @brief Transport to hand to the driver (records, then forwards to inner)
+ *
+ * Deleting it deletes the trace.
+ */
+weact_epaper_transport_t *weact_epaper_trace_transport(weact_epaper_trace_t *trace);
+
+/**
+ * @brief Delete a trace (and its inner transport if it owns it)
+ */
+void weact_epaper_trace_delete(weact_epaper_trace_t *trace);
+
+/**
+ * @brief Pause or resume recording (transfers are forwarded either way)
+ */
+void weact_epaper_trace_set_enabled(weact_epaper_trace_t *trace, bool enabled);
+
+/**
+ * @brief Drop all records and restart the time base
+ */
+void weact_epaper_trace_clear(weact_epaper_trace_t *trace);
+
+/**
+ * @brief Add an application marker (e.g. "LVGL flush started")
+ */
+void weact_epaper_trace_mark(weact_epaper_trace_t *trace, uint8_t value);
+
+/**
+ * @brief Records in the ring and records dropped so far
+ */
+size_t weact_epaper_trace_count(weact_epaper_trace_t *trace, uint32_t *dropped);
+
+/**
+ * @brief Read the next record
+ *
+ * Start with *cursor = 0. A cursor that fell behind the ring continues at
+ * the oldest record.
+ *
+ * @param payload Receives up to payload_size stored payload bytes (may be NULL)
+ * @return false when there are no more records
+ */
+bool weact_epaper_trace_next(weact_epaper_trace_t *trace, uint64_t *cursor, weact_epaper_trace_record_t *record,
+                             uint8_t *payload, size_t payload_size);
+
+/**
+ * @brief Write the trace through a callback
+ */
+void weact_epaper_trace_dump(weact_epaper_trace_t *trace, weact_epaper_trace_format_t format,
+                             weact_epaper_trace_write_fn_t write, void *ctx);
+
+/**
+ * @brief Print the trace on the console (stdout)
+ *
+ * CSV prints as is; binary prints as base64 lines between
+ * "-----BEGIN WEACT EPAPER TRACE-----" and "-----END WEACT EPAPER TRACE-----".
+ */
+void weact_epaper_trace_dump_console(weact_epaper_trace_t *trace, weact_epaper_trace_format_t format);
+
+/**
+ * @brief Trace from a binary dump (replay and analysis only, no transport)
+ *
+ * @return Trace, NULL if data is not a valid binary trace
+ */
+weact_epaper_trace_t *weact_epaper_trace_load(const uint8_t *data, size_t len);
+
+/**
+ * @brief Send a recorded trace to a transport
+ *
+ * Commands, data, reads and RST changes are replayed; DC follows from the
+ * transfers and BUSY comes from the target. Payloads cut by data_limit are
+ * skipped with a warning.
+ *
+ * @return Records replayed
+ */
+size_t weact_epaper_trace_replay(weact_epaper_trace_t *trace, weact_epaper_transport_t *target,
+                                 const weact_epaper_trace_replay_config_t *config);
+
+#endif // WEACT_EPAPER_TRACE_H
@@ -0,0 +1,78 @@
+#ifndef WEACT_EPAPER_TRANSPORT_H
+#define WEACT_EPAPER_TRANSPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/**
+ * @brief Hardware access used by the SSD1680 driver
+ *
+ * Everything the driver does to the outside world goes through this table:
+ * SPI bytes with the DC level, the BUSY and RST lines, delays and the
+ * clock. The ESP-IDF implementation (weact_epaper_transport_new_spi(),
+ * declared in weact_epaper_2in13.h) is created from the pins in
+ * weact_epaper_config_t; the host build provides its own so the protocol
+ * and pixel code runs on Linux.
+ *
+ * Implementations embed this struct as their first member.
+ */
+
+// Most transfers the driver hands to write_batch() at once
+#define WEACT_EPAPER_TRANSPORT_BATCH_MAX 12
+
+typedef struct weact_epaper_transport_t weact_epaper_transport_t;
+
+/**
+ * @brief One command or data transfer of a batch
+ */
+typedef struct {
+    const uint8_t *data;    // Payload (points to inline_data for short ones)
+    size_t len;
+    uint8_t dc;             // DC level: 0 = command, 1 = data
+    uint8_t inline_data[4]; // Copy of payloads up to 4 bytes
+} weact_epaper_transfer_t;
+
+/**
+ * @brief Called when BUSY falls (interrupt context on the device)
+ */
+typedef void (*weact_epaper_busy_cb_t)(void *arg);
+
+struct weact_epaper_transport_t {
+    // Send one command byte (DC low)
+    void (*write_command)(weact_epaper_transport_t *t, uint8_t cmd);
+
+    // Send data bytes (DC high); the driver splits long payloads into chunks
+    void (*write_data)(weact_epaper_transport_t *t, const uint8_t *data, size_t len);
+
+    // Optional: send a sequence back to back (NULL = one call per transfer)
+    void (*write_batch)(weact_epaper_transport_t *t, const weact_epaper_transfer_t *transfers, size_t count);
+
+    // Optional: send a command and read up to 4 response bytes
+    void (*read_register)(weact_epaper_transport_t *t, uint8_t cmd, uint8_t *data, size_t len);
+
+    // BUSY level (1 = busy)
+    int (*read_busy)(weact_epaper_transport_t *t);
+
+    // Drive RST (0 = reset asserted)
+    void (*set_rst)(weact_epaper_transport_t *t, int level);
+
+    // Wait at least us microseconds (may yield to other tasks)
+    void (*delay_us)(weact_epaper_transport_t *t, uint32_t us);
+
+    // Monotonic time in microseconds
+    int64_t (*now_us)(weact_epaper_transport_t *t);
+
+    // Optional: call cb on each BUSY falling edge (cb = NULL disables)
+    esp_err_t (*set_busy_callback)(weact_epaper_transport_t *t, weact_epaper_busy_cb_t cb, void *arg);
+
+    // Release the transport
+    void (*del)(weact_epaper_transport_t *t);
+
+    // Longest payload one write_data() or batch transfer can carry in bytes
+    // (0 = no limit); the driver never chunks above it
+    size_t max_write;
+};
+
+#endif // WEACT_EPAPER_TRANSPORT_H
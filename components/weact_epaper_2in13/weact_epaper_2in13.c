@@ -1,8 +1,13 @@
 #include "weact_epaper_2in13.h"
+#include "weact_epaper_private.h"
 #include "esp_log.h"
 #include "esp_task_wdt.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <assert.h>
 #include <string.h>
 
 static const char *TAG = "WEACT_EPAPER";
@@ -53,35 +58,147 @@ static const uint8_t weact_epaper_lut_full_update[] = {
 //     0x00, 0x00, 0x00, 0x00, 0x00,
 // };
 
+/**
+ * 4-level grayscale LUT for SSD1680 (153 bytes waveform + 6 bytes voltages)
+ *
+ * Each pixel selects one of LUT0..LUT3 through its (BW RAM, RED RAM) bit
+ * pair, so the four gray levels get four different drive durations. Layout:
+ * VS for LUT0-4 (5 x 12 bytes), TP/SR/RP for 12 groups (12 x 7 bytes),
+ * frame rate (6), XON (3), then EOPT, VGH, VSH1, VSH2, VSL, VCOM.
+ * Values are the vendor 4-gray reference waveform for SSD1680 panels.
+ */
+static const uint8_t weact_epaper_lut_gray4[159] = {
+    0x00, 0x60, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // VS LUT0
+    0x20, 0x60, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // VS LUT1
+    0x28, 0x60, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // VS LUT2
+    0x2A, 0x60, 0x15, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // VS LUT3
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // VS LUT4 (VCOM)
+    0x00, 0x02, 0x00, 0x05, 0x14, 0x00, 0x00, // TP, SR, RP group 0
+    0x1E, 0x1E, 0x00, 0x00, 0x00, 0x00, 0x01, // Group 1
+    0x00, 0x02, 0x00, 0x05, 0x14, 0x00, 0x00, // Group 2
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Group 3
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Group 4
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Group 5
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Group 6
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Group 7
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Group 8
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Group 9
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Group 10
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Group 11
+    0x24, 0x22, 0x22, 0x22, 0x23, 0x32,       // Frame rate
+    0x00, 0x00, 0x00,                         // XON
+    0x22,                                     // EOPT
+    0x17,                                     // VGH
+    0x41, 0xAE, 0x32,                         // VSH1, VSH2, VSL
+    0x28,                                     // VCOM
+};
+
+/**
+ * Two-page LUT: shows whichever RAM bank is not bypassed.
+ *
+ * With one bank bypassed as 0 every pixel selects LUT0 (bit 0 → black) or
+ * LUT1/LUT2 (bit 1 → white, from either bank). VSH1 drives black, VSL drives
+ * white; group 0 shakes the particles four times to limit ghosting, group 1
+ * settles on the target. Same layout as weact_epaper_lut_gray4.
+ */
+static const uint8_t weact_epaper_lut_page[159] = {
+    0x99, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // VS LUT0 → black
+    0x66, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // VS LUT1 → white
+    0x66, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // VS LUT2 → white
+    0x66, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // VS LUT3 → white
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // VS LUT4 (VCOM)
+    0x0A, 0x0A, 0x00, 0x0A, 0x0A, 0x00, 0x01, // TP, SR, RP group 0
+    0x28, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Group 1
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Group 2
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Group 3
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Group 4
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Group 5
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Group 6
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Group 7
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Group 8
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Group 9
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Group 10
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Group 11
+    0x22, 0x22, 0x22, 0x22, 0x22, 0x22,       // Frame rate
+    0x00, 0x00, 0x00,                         // XON
+    0x22,                                     // EOPT
+    0x17,                                     // VGH
+    0x41, 0x00, 0x32,                         // VSH1, VSH2, VSL
+    0x36,                                     // VCOM
+};
+
+#define WEACT_EPAPER_LUT_WAVEFORM_SIZE 153
+
+static void weact_epaper_apply_ram_options(weact_epaper_t *dev);
+static void weact_epaper_power_timer_start(weact_epaper_t *dev);
+static void weact_epaper_power_timer_stop(weact_epaper_t *dev);
+static void weact_epaper_note_sequence(weact_epaper_t *dev, uint8_t sequence);
+static bool weact_epaper_temperature_fresh(weact_epaper_t *dev);
+static void weact_epaper_wake_locked(weact_epaper_t *dev);
+static void weact_epaper_sleep_timer_start(weact_epaper_t *dev);
+
+// Serialises command sequences between the caller and the esp_timer
+// callbacks (scheduled activation, idle power-off). Recursive because
+// public functions call each other.
+static inline void weact_epaper_lock(weact_epaper_t *dev)
+{
+    xSemaphoreTakeRecursive(dev->lock, portMAX_DELAY);
+}
+
+static inline void weact_epaper_unlock(weact_epaper_t *dev)
+{
+    xSemaphoreGiveRecursive(dev->lock);
+}
+
+// Ready bit in dev->ready (set when asynchronous init has finished)
+#define WEACT_EPAPER_READY_BIT (1 << 0)
+
+// Lock for a sequence that needs the controller awake (wakes it from deep
+// sleep, waits for a running asynchronous init)
+static inline void weact_epaper_lock_awake(weact_epaper_t *dev)
+{
+    if (dev->ready != NULL)
+    {
+        xEventGroupWaitBits(dev->ready, WEACT_EPAPER_READY_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+
+    weact_epaper_lock(dev);
+    weact_epaper_wake_locked(dev);
+}
+
+static inline bool weact_epaper_is_asleep(const weact_epaper_t *dev)
+{
+    return dev->power_state == WEACT_EPAPER_POWER_DEEP_SLEEP_1 ||
+           dev->power_state == WEACT_EPAPER_POWER_DEEP_SLEEP_2;
+}
+
 // =============================================================================
 // LOW-LEVEL SPI COMMUNICATION FUNCTIONS
 // =============================================================================
 
 void weact_epaper_send_command(weact_epaper_t *dev, uint8_t cmd)
 {
-    spi_transaction_t trans = {
-        .length = 8,
-        .tx_buffer = &cmd,
-        .rx_buffer = NULL,
-    };
-
-    gpio_set_level(dev->config.pin_dc, 0); // Command mode
-    ESP_ERROR_CHECK(spi_device_polling_transmit(dev->spi, &trans));
+    dev->transport->write_command(dev->transport, cmd);
+    dev->stats.spi_bytes++;
+    dev->stats.spi_transactions++;
 }
 
 void weact_epaper_send_data(weact_epaper_t *dev, const uint8_t *data, size_t len)
 {
-    if (len == 0)
-        return;
+    // One transaction per chunk: each acquires and releases the bus, so
+    // other devices on it wait at most one chunk. The controller keeps
+    // writing RAM across CS toggles as long as no command comes in between.
+    while (len > 0)
+    {
+        size_t n = len < dev->chunk_size ? len : dev->chunk_size;
 
-    spi_transaction_t trans = {
-        .length = len * 8,
-        .tx_buffer = data,
-        .rx_buffer = NULL,
-    };
+        dev->transport->write_data(dev->transport, data, n);
+        dev->stats.spi_bytes += n;
+        dev->stats.spi_transactions++;
 
-    gpio_set_level(dev->config.pin_dc, 1); // Data mode
-    ESP_ERROR_CHECK(spi_device_polling_transmit(dev->spi, &trans));
+        data += n;
+        len -= n;
+    }
 }
 
 void weact_epaper_send_data_byte(weact_epaper_t *dev, uint8_t data)
@@ -89,354 +206,2300 @@ void weact_epaper_send_data_byte(weact_epaper_t *dev, uint8_t data)
     weact_epaper_send_data(dev, &data, 1);
 }
 
-// =============================================================================
-// CONTROL FUNCTIONS
-// =============================================================================
-
-void weact_epaper_wait_until_idle(weact_epaper_t *dev)
+/**
+ * @brief Send a command and read its response
+ *
+ * @param dev Device handle
+ * @param cmd Command byte
+ * @param data Response buffer
+ * @param len Number of bytes to read (at most 4); left untouched if the
+ *        transport cannot read
+ */
+static void weact_epaper_read_register(weact_epaper_t *dev, uint8_t cmd, uint8_t *data, size_t len)
 {
-    ESP_LOGI(TAG, "Waiting for display...");
-
-    uint32_t timeout = 0;
-    const uint32_t MAX_TIMEOUT_MS = 5000; // 5 second timeout
+    assert(len <= 4);
 
-    // Wait while BUSY is HIGH (display is busy)
-    // SSD1680 BUSY logic: HIGH = busy, LOW = ready
-    while (gpio_get_level(dev->config.pin_busy) == 1)
+    if (dev->transport->read_register != NULL)
     {
-        vTaskDelay(pdMS_TO_TICKS(100));
-        timeout += 10;
-
-        // ESP_LOGI(TAG, "...still busy (%lu ms elapsed)", timeout);
-
-        // Feed the watchdog every 100ms to prevent timeout during long refresh
-        // if (timeout % 100 == 0)
-        // {
-        //     esp_task_wdt_reset();
-        // }
-
-        if (timeout > MAX_TIMEOUT_MS)
-        {
-            ESP_LOGW(TAG, "Display busy timeout! Continuing anyway...");
-            break;
-        }
+        dev->transport->read_register(dev->transport, cmd, data, len);
+        dev->stats.spi_bytes += 1 + len;
+        dev->stats.spi_transactions += 2; // Command, then the read
     }
+}
 
-    ESP_LOGI(TAG, "Display ready (waited %lu ms)", timeout);
+static inline void weact_epaper_delay_us(weact_epaper_t *dev, uint32_t us)
+{
+    dev->transport->delay_us(dev->transport, us);
 }
 
-void weact_epaper_reset(weact_epaper_t *dev)
+static inline void weact_epaper_delay_ms(weact_epaper_t *dev, uint32_t ms)
 {
-    ESP_LOGI(TAG, "Hardware reset");
+    dev->transport->delay_us(dev->transport, ms * 1000);
+}
 
-    gpio_set_level(dev->config.pin_rst, 1);
-    vTaskDelay(pdMS_TO_TICKS(20));
+static inline int64_t weact_epaper_now_us(weact_epaper_t *dev)
+{
+    return dev->transport->now_us(dev->transport);
+}
 
-    gpio_set_level(dev->config.pin_rst, 0);
-    vTaskDelay(pdMS_TO_TICKS(2));
+static inline int weact_epaper_busy_level(weact_epaper_t *dev)
+{
+    return dev->transport->read_busy(dev->transport);
+}
 
-    gpio_set_level(dev->config.pin_rst, 1);
-    vTaskDelay(pdMS_TO_TICKS(20));
+static inline void weact_epaper_set_rst(weact_epaper_t *dev, int level)
+{
+    dev->transport->set_rst(dev->transport, level);
 }
 
 // =============================================================================
-// INITIALIZATION
+// ENERGY ACCOUNTING
 // =============================================================================
 
-bool weact_epaper_init(weact_epaper_t *dev, const weact_epaper_config_t *config)
+// µA x µs per µAh
+#define WEACT_EPAPER_UA_US_PER_UAH 3600000000.0
+
+/**
+ * @brief Change the power state, charging the time spent in the old one
+ */
+static void weact_epaper_set_power_state(weact_epaper_t *dev, weact_epaper_power_state_t state)
 {
-    ESP_LOGI(TAG, "=================================================");
-    ESP_LOGI(TAG, "Initializing SSD1680 (250x122 e-paper)");
-    ESP_LOGI(TAG, "=================================================");
+    int64_t now = weact_epaper_now_us(dev);
 
-    memcpy(&dev->config, config, sizeof(weact_epaper_config_t));
+    dev->energy.state_us[dev->power_state] += (uint64_t)(now - dev->power_state_since_us);
+    dev->power_state_since_us = now;
+    dev->power_state = state;
+}
 
-    // -------------------------------------------------------------------------
-    // GPIO Configuration
-    // -------------------------------------------------------------------------
-    ESP_LOGI(TAG, "Configuring GPIO pins");
-
-    gpio_config_t io_conf = {
-        .pin_bit_mask = (1ULL << config->pin_dc) | (1ULL << config->pin_rst),
-        .mode = GPIO_MODE_OUTPUT,
-        .pull_up_en = GPIO_PULLUP_DISABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE,
-    };
-    ESP_ERROR_CHECK(gpio_config(&io_conf));
+// SPI clocking time of len bytes
+static uint64_t weact_epaper_spi_us(const weact_epaper_t *dev, uint64_t bytes)
+{
+    // Transports without a configured clock (host, custom) count as 4 MHz
+    uint32_t hz = dev->config.spi_clock_speed_hz > 0 ? (uint32_t)dev->config.spi_clock_speed_hz : 4000000;
 
-    io_conf.pin_bit_mask = (1ULL << config->pin_busy);
-    io_conf.mode = GPIO_MODE_INPUT;
-    io_conf.pull_up_en = GPIO_PULLUP_ENABLE;
-    ESP_ERROR_CHECK(gpio_config(&io_conf));
+    return bytes * 8 * 1000000 / hz;
+}
 
-    // -------------------------------------------------------------------------
-    // SPI Bus Configuration
-    // -------------------------------------------------------------------------
-    ESP_LOGI(TAG, "Configuring SPI bus");
-
-    spi_bus_config_t buscfg = {
-        .mosi_io_num = config->pin_mosi,
-        .miso_io_num = -1,
-        .sclk_io_num = config->pin_sck,
-        .quadwp_io_num = -1,
-        .quadhd_io_num = -1,
-        .max_transfer_sz = WEACT_EPAPER_BUFFER_SIZE,
+weact_epaper_currents_t weact_epaper_default_currents(void)
+{
+    weact_epaper_currents_t currents = {
+        .state_ua = {
+            [WEACT_EPAPER_POWER_ACTIVE] = 8000.0f,      // Booster and drivers, ~26 mW at 3.3 V
+            [WEACT_EPAPER_POWER_ANALOG_ON] = 1200.0f,   // Booster on, no waveform running
+            [WEACT_EPAPER_POWER_IDLE] = 20.0f,          // Clock and analog off
+            [WEACT_EPAPER_POWER_DEEP_SLEEP_1] = 1.0f,
+            [WEACT_EPAPER_POWER_DEEP_SLEEP_2] = 0.5f,
+        },
+        .spi_ua = 500.0f,
     };
 
-    ESP_ERROR_CHECK(spi_bus_initialize(SPI2_HOST, &buscfg, SPI_DMA_CH_AUTO));
+    return currents;
+}
 
-    spi_device_interface_config_t devcfg = {
-        .clock_speed_hz = config->spi_clock_speed_hz,
-        .mode = 0,
-        .spics_io_num = config->pin_cs,
-        .queue_size = 1,
-        .flags = SPI_DEVICE_HALFDUPLEX,
-    };
+void weact_epaper_set_currents(weact_epaper_t *dev, const weact_epaper_currents_t *currents)
+{
+    weact_epaper_lock(dev);
+    dev->currents = *currents;
+    weact_epaper_unlock(dev);
+}
 
-    ESP_ERROR_CHECK(spi_bus_add_device(SPI2_HOST, &devcfg, &dev->spi));
+// An update finished: its refresh plus the SPI traffic since it started
+static void weact_epaper_energy_update_done(weact_epaper_t *dev, int64_t busy_us)
+{
+    double ua_us = (double)busy_us * dev->currents.state_ua[WEACT_EPAPER_POWER_ACTIVE] +
+                   (double)weact_epaper_spi_us(dev, dev->stats.spi_bytes - dev->update_spi_bytes) *
+                       dev->currents.spi_ua;
 
-    // -------------------------------------------------------------------------
-    // Framebuffer Allocation
-    // -------------------------------------------------------------------------
-    ESP_LOGI(TAG, "Allocating framebuffer (%d bytes)", WEACT_EPAPER_BUFFER_SIZE);
+    dev->energy.update_uah_last = (float)(ua_us / WEACT_EPAPER_UA_US_PER_UAH);
+    dev->update_uah_total += dev->energy.update_uah_last;
+    dev->update_count++;
+}
 
-    dev->framebuffer = heap_caps_malloc(WEACT_EPAPER_BUFFER_SIZE, MALLOC_CAP_DMA);
-    if (dev->framebuffer == NULL)
+bool weact_epaper_get_energy(weact_epaper_t *dev, weact_epaper_energy_t *energy)
+{
+    if (dev->lock == NULL)
     {
-        ESP_LOGE(TAG, "Failed to allocate framebuffer!");
         return false;
     }
 
-    // Initialize to white (0xFF in e-paper RAM = white)
-    memset(dev->framebuffer, 0xFF, WEACT_EPAPER_BUFFER_SIZE);
+    weact_epaper_lock(dev);
 
-    // -------------------------------------------------------------------------
-    // Hardware Reset
-    // -------------------------------------------------------------------------
-    weact_epaper_reset(dev);
-    weact_epaper_wait_until_idle(dev);
+    int64_t now = weact_epaper_now_us(dev);
+    *energy = dev->energy;
+    energy->state_us[dev->power_state] += (uint64_t)(now - dev->power_state_since_us);
+    energy->analog_on_us = energy->state_us[WEACT_EPAPER_POWER_ACTIVE] + energy->state_us[WEACT_EPAPER_POWER_ANALOG_ON];
+    energy->busy_us = dev->stats.busy.total_us;
+    energy->spi_bytes = dev->stats.spi_bytes;
+    energy->spi_us = weact_epaper_spi_us(dev, dev->stats.spi_bytes);
+    energy->elapsed_us = (uint64_t)(now - dev->energy_since_us);
 
-    // -------------------------------------------------------------------------
-    // SSD1680 Initialization Sequence
-    // -------------------------------------------------------------------------
-    ESP_LOGI(TAG, "Sending SSD1680 initialization sequence");
+    double ua_us = (double)energy->spi_us * dev->currents.spi_ua;
+    for (int i = 0; i < WEACT_EPAPER_POWER_STATES; i++)
+    {
+        ua_us += (double)energy->state_us[i] * dev->currents.state_ua[i];
+    }
+    energy->charge_uah = (float)(ua_us / WEACT_EPAPER_UA_US_PER_UAH);
+    energy->update_uah_mean = dev->update_count > 0 ? dev->update_uah_total / dev->update_count : 0.0f;
+    energy->uah_per_hour = energy->elapsed_us > 0 ? (float)(ua_us / energy->elapsed_us) : 0.0f;
 
-    // Software Reset
-    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_SW_RESET);
-    weact_epaper_wait_until_idle(dev);
+    weact_epaper_unlock(dev);
+    return true;
+}
 
-    // Driver Output Control
-    // A[7:0]: MUX Gate lines = 250-1 = 249 = 0xF9
-    // A[8] and B[2:0]: Gate scanning sequence
-    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_DRIVER_OUTPUT_CONTROL);
-    weact_epaper_send_data_byte(dev, 0xF9); // 250-1 (height - 1) LOW byte
-    weact_epaper_send_data_byte(dev, 0x00); // HIGH byte
-    weact_epaper_send_data_byte(dev, 0x00); // GD=0, SM=0, TB=0
+// =============================================================================
+// UPDATE TIMING
+// =============================================================================
 
-    // Data Entry Mode
-    // Sets how data is written to RAM
-    // Bit 0-1: Address counter direction (00=Y-, 01=Y+, 10=X-, 11=X+)
-    // Bit 2: I/D mode (0=X direction, 1=Y direction)
-    // 0x03 = X direction, X increment, Y increment
-    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_DATA_ENTRY_MODE);
-    weact_epaper_send_data_byte(dev, 0x03);
+void weact_epaper_phase_stats_add(weact_epaper_phase_stats_t *stats, int64_t us)
+{
+    uint32_t v = us < 0 ? 0 : (us > UINT32_MAX ? UINT32_MAX : (uint32_t)us);
 
-    // Set RAM X address start/end
-    // For portrait with aligned rows: 16 bytes per row (128 pixels, using 122)
-    // X is in bytes: 0-15 (0x00 to 0x0F)
-    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_SET_RAM_X_ADDRESS_START_END);
-    weact_epaper_send_data_byte(dev, 0x00); // X start (0)
-    weact_epaper_send_data_byte(dev, 0x0F); // X end (15)
+    stats->last_us = v;
+    if (stats->count == 0 || v < stats->min_us)
+    {
+        stats->min_us = v;
+    }
+    if (v > stats->max_us)
+    {
+        stats->max_us = v;
+    }
+    stats->total_us += v;
+    stats->count++;
+    stats->mean_us = (uint32_t)(stats->total_us / stats->count);
 
-    // Set RAM Y address start/end
-    // For portrait: treat as rows (tall dimension)
-    // Y is in pixels: 0 to 249 (0xF9)
-    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_SET_RAM_Y_ADDRESS_START_END);
-    weact_epaper_send_data_byte(dev, 0x00); // Y start LOW
-    weact_epaper_send_data_byte(dev, 0x00); // Y start HIGH
-    weact_epaper_send_data_byte(dev, 0xF9); // Y end LOW (249)
-    weact_epaper_send_data_byte(dev, 0x00); // Y end HIGH
+    // Bucket i: below 4^i ms
+    int bucket = 0;
+    for (uint64_t limit = 1000; bucket < WEACT_EPAPER_STATS_BUCKETS - 1 && v >= limit; limit *= 4)
+    {
+        bucket++;
+    }
+    stats->buckets[bucket]++;
+}
 
-    // Border Waveform Control
-    // This controls the border color during refresh
-    // 0x05 = Follow LUT (normal behavior)
-    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_BORDER_WAVEFORM_CONTROL);
-    weact_epaper_send_data_byte(dev, 0x05);
+// First timed step of an update starts it, unless the start was marked earlier
+static void weact_epaper_stats_begin(weact_epaper_t *dev, int64_t start_us)
+{
+    if (dev->update_start_us == 0)
+    {
+        dev->update_start_us = start_us;
+        dev->update_spi_bytes = dev->stats.spi_bytes;
+    }
+}
 
-    // Display Update Control 1
-    // This sets the display update sequence options
-    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_DISPLAY_UPDATE_CONTROL_1);
-    weact_epaper_send_data_byte(dev, 0x00);
-    weact_epaper_send_data_byte(dev, 0x80);
+// RAM writes that started at start_us are done
+static void weact_epaper_stats_uploaded(weact_epaper_t *dev, int64_t start_us)
+{
+    weact_epaper_phase_stats_add(&dev->stats.upload, weact_epaper_now_us(dev) - start_us);
+    weact_epaper_stats_begin(dev, start_us);
+}
 
-    // Temperature Sensor Control
-    // 0x80 = Internal temperature sensor
-    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_TEMP_SENSOR_CONTROL);
-    weact_epaper_send_data_byte(dev, 0x80);
+// MASTER_ACTIVATION just went out, arming started at start_us
+static void weact_epaper_stats_activated(weact_epaper_t *dev, int64_t start_us)
+{
+    int64_t now = weact_epaper_now_us(dev);
 
-    // Load LUT (optional - comment out to use internal LUT)
-    // ESP_LOGI(TAG, "Loading custom LUT");
-    // weact_epaper_send_command(dev, WEACT_EPAPER_CMD_WRITE_LUT_REGISTER);
-    // weact_epaper_send_data(dev, weact_epaper_lut_full_update, sizeof(weact_epaper_lut_full_update));
+    weact_epaper_phase_stats_add(&dev->stats.activate, now - start_us);
+    weact_epaper_stats_begin(dev, start_us);
+    dev->activated_at_us = now;
+}
 
-    ESP_LOGI(TAG, "=================================================");
-    ESP_LOGI(TAG, "SSD1680 initialization complete!");
-    ESP_LOGI(TAG, "=================================================");
+// BUSY went low: the update is complete
+static void weact_epaper_stats_done(weact_epaper_t *dev)
+{
+    int64_t now = weact_epaper_now_us(dev);
+
+    weact_epaper_phase_stats_add(&dev->stats.busy, now - dev->activated_at_us);
+    if (dev->update_start_us != 0)
+    {
+        weact_epaper_phase_stats_add(&dev->stats.update, now - dev->update_start_us);
+        weact_epaper_energy_update_done(dev, now - dev->activated_at_us);
+        dev->update_start_us = 0;
+    }
+}
+
+bool weact_epaper_get_stats(weact_epaper_t *dev, weact_epaper_stats_t *stats)
+{
+    if (dev->lock == NULL)
+    {
+        return false;
+    }
 
+    weact_epaper_lock(dev);
+    *stats = dev->stats;
+    weact_epaper_unlock(dev);
     return true;
 }
 
-// =============================================================================
-// DRAWING FUNCTIONS
-// =============================================================================
+void weact_epaper_reset_stats(weact_epaper_t *dev)
+{
+    weact_epaper_lock(dev);
+    memset(&dev->stats, 0, sizeof(dev->stats));
+    memset(&dev->energy, 0, sizeof(dev->energy));
+    dev->energy_since_us = weact_epaper_now_us(dev);
+    dev->power_state_since_us = dev->energy_since_us;
+    dev->update_spi_bytes = 0;
+    dev->update_uah_total = 0.0f;
+    dev->update_count = 0;
+    weact_epaper_unlock(dev);
+}
 
-void weact_epaper_draw_pixel(weact_epaper_t *dev, int x, int y, uint8_t color)
+void weact_epaper_mark_update_start(weact_epaper_t *dev, int64_t at_us)
 {
-    if (x < 0 || x >= WEACT_EPAPER_WIDTH || y < 0 || y >= WEACT_EPAPER_HEIGHT)
+    weact_epaper_lock(dev);
+    weact_epaper_stats_begin(dev, at_us);
+    weact_epaper_unlock(dev);
+}
+
+/**
+ * @brief Queued command/data sequence
+ *
+ * Collected and handed to the transport in one go, so the SPI peripheral
+ * moves from one transaction to the next without waiting for the CPU.
+ * Payloads up to 4 bytes are copied; larger ones must stay valid until
+ * weact_epaper_batch_run() returns.
+ */
+typedef struct {
+    weact_epaper_transfer_t trans[WEACT_EPAPER_TRANSPORT_BATCH_MAX];
+    size_t count;
+} weact_epaper_batch_t;
+
+static void weact_epaper_batch_run(weact_epaper_t *dev, weact_epaper_batch_t *batch);
+
+static void weact_epaper_batch_add(weact_epaper_t *dev, weact_epaper_batch_t *batch, int dc,
+                                   const uint8_t *data, size_t len)
+{
+    // Long payloads become one transaction per chunk (see weact_epaper_send_data())
+    while (len > dev->chunk_size)
     {
-        return;
+        weact_epaper_batch_add(dev, batch, dc, data, dev->chunk_size);
+        data += dev->chunk_size;
+        len -= dev->chunk_size;
     }
 
-    // Calculate byte position with aligned row width
-    // Each row is WEACT_EPAPER_WIDTH_BYTES (16) bytes, even though we only use 15.25
-    int byte_index = y * WEACT_EPAPER_WIDTH_BYTES + (x / 8);
-    int bit_index = x % 8;
+    // Queue full: send what is there, keep going
+    if (batch->count == WEACT_EPAPER_TRANSPORT_BATCH_MAX)
+    {
+        weact_epaper_batch_run(dev, batch);
+    }
+
+    weact_epaper_transfer_t *t = &batch->trans[batch->count++];
+    t->len = len;
+    t->dc = (uint8_t)dc;
 
-    if (color == 0)
+    if (len <= sizeof(t->inline_data))
     {
-        // WHITE: Set bit to 1
-        dev->framebuffer[byte_index] |= (1 << (7 - bit_index));
+        memcpy(t->inline_data, data, len);
+        t->data = t->inline_data;
     }
     else
     {
-        // BLACK: Clear bit to 0
-        dev->framebuffer[byte_index] &= ~(1 << (7 - bit_index));
+        t->data = data;
     }
 }
 
-void weact_epaper_draw_rectangle(weact_epaper_t *dev, int x0, int y0, int x1, int y1, bool filled)
+static void weact_epaper_batch_command(weact_epaper_t *dev, weact_epaper_batch_t *batch, uint8_t cmd,
+                                       const uint8_t *data, size_t len)
 {
-    if (x0 > x1)
+    weact_epaper_batch_add(dev, batch, 0, &cmd, 1);
+    if (len > 0)
     {
-        int temp = x0;
-        x0 = x1;
-        x1 = temp;
+        weact_epaper_batch_add(dev, batch, 1, data, len);
     }
-    if (y0 > y1)
+}
+
+static void weact_epaper_batch_run(weact_epaper_t *dev, weact_epaper_batch_t *batch)
+{
+    weact_epaper_transport_t *t = dev->transport;
+
+    if (t->write_batch != NULL)
     {
-        int temp = y0;
-        y0 = y1;
-        y1 = temp;
+        t->write_batch(t, batch->trans, batch->count);
     }
-
-    if (filled)
+    else
     {
-        for (int y = y0; y <= y1; y++)
+        for (size_t i = 0; i < batch->count; i++)
         {
-            for (int x = x0; x <= x1; x++)
+            if (batch->trans[i].dc == 0)
             {
-                weact_epaper_draw_pixel(dev, x, y, 1);
+                t->write_command(t, batch->trans[i].data[0]);
+            }
+            else
+            {
+                t->write_data(t, batch->trans[i].data, batch->trans[i].len);
             }
         }
     }
-    else
+
+    for (size_t i = 0; i < batch->count; i++)
     {
-        for (int x = x0; x <= x1; x++)
-        {
-            weact_epaper_draw_pixel(dev, x, y0, 1);
-            weact_epaper_draw_pixel(dev, x, y1, 1);
-        }
-        for (int y = y0; y <= y1; y++)
-        {
-            weact_epaper_draw_pixel(dev, x0, y, 1);
-            weact_epaper_draw_pixel(dev, x1, y, 1);
-        }
+        dev->stats.spi_bytes += batch->trans[i].len;
     }
+    dev->stats.spi_transactions += batch->count;
+    batch->count = 0;
 }
 
-void weact_epaper_clear_screen(weact_epaper_t *dev)
+// Page bit of the bank a RAM write command targets (see dev->pages_loaded)
+static inline uint8_t weact_epaper_page_bit(uint8_t ram_cmd)
 {
-    ESP_LOGI(TAG, "Clearing screen to white");
+    return ram_cmd == WEACT_EPAPER_CMD_WRITE_RAM_RED ? 1 << WEACT_EPAPER_PAGE_1 : 1 << WEACT_EPAPER_PAGE_0;
+}
 
-    // Fill framebuffer with 0xFF (all white)
-    memset(dev->framebuffer, 0xFF, WEACT_EPAPER_BUFFER_SIZE);
+/**
+ * @brief Upload both RAM planes in one queued sequence
+ *
+ * @param dev Device handle
+ * @param bw BW RAM image (WEACT_EPAPER_BUFFER_SIZE bytes)
+ * @param red RED RAM image (WEACT_EPAPER_BUFFER_SIZE bytes)
+ */
+static void weact_epaper_write_planes(weact_epaper_t *dev, const uint8_t *bw, const uint8_t *red)
+{
+    static const uint8_t zero[2] = {0x00, 0x00};
+    weact_epaper_batch_t batch = {.count = 0};
 
-    // Set RAM address to start position
-    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_SET_RAM_X_ADDRESS_COUNTER);
-    weact_epaper_send_data_byte(dev, 0x00);
+    weact_epaper_batch_command(dev, &batch, WEACT_EPAPER_CMD_SET_RAM_X_ADDRESS_COUNTER, zero, 1);
+    weact_epaper_batch_command(dev, &batch, WEACT_EPAPER_CMD_SET_RAM_Y_ADDRESS_COUNTER, zero, 2);
+    weact_epaper_batch_command(dev, &batch, WEACT_EPAPER_CMD_WRITE_RAM_BW, bw, WEACT_EPAPER_BUFFER_SIZE);
 
-    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_SET_RAM_Y_ADDRESS_COUNTER);
-    weact_epaper_send_data_byte(dev, 0x00);
-    weact_epaper_send_data_byte(dev, 0x00);
+    weact_epaper_batch_command(dev, &batch, WEACT_EPAPER_CMD_SET_RAM_X_ADDRESS_COUNTER, zero, 1);
+    weact_epaper_batch_command(dev, &batch, WEACT_EPAPER_CMD_SET_RAM_Y_ADDRESS_COUNTER, zero, 2);
+    weact_epaper_batch_command(dev, &batch, WEACT_EPAPER_CMD_WRITE_RAM_RED, red, WEACT_EPAPER_BUFFER_SIZE);
 
-    // Write white data to both BW and RED RAM (if applicable)
-    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_WRITE_RAM_BW);
-    weact_epaper_send_data(dev, dev->framebuffer, WEACT_EPAPER_BUFFER_SIZE);
+    weact_epaper_batch_run(dev, &batch);
+    dev->pages_loaded = 0;
+}
+
+// =============================================================================
+// CONTROL FUNCTIONS
+// =============================================================================
+
+/**
+ * @brief Leave the ACTIVE state once a display update has finished
+ *
+ * Starts the idle timers: analog power-off (burst profile) and auto-sleep.
+ */
+static void weact_epaper_update_done(weact_epaper_t *dev)
+{
+    if (dev->power_state != WEACT_EPAPER_POWER_ACTIVE)
+    {
+        return;
+    }
+
+    weact_epaper_set_power_state(dev, dev->analog_on ? WEACT_EPAPER_POWER_ANALOG_ON : WEACT_EPAPER_POWER_IDLE);
+    weact_epaper_stats_done(dev);
+
+    // Burst profile: analog stays on until the display has been idle a while
+    if (dev->analog_on)
+    {
+        weact_epaper_power_timer_start(dev);
+    }
+
+    weact_epaper_sleep_timer_start(dev);
+}
+
+void weact_epaper_wait_until_idle(weact_epaper_t *dev)
+{
+    ESP_LOGI(TAG, "Waiting for display...");
+
+    const int64_t start_us = weact_epaper_now_us(dev);
+
+    // BUSY stays high in deep sleep, there is nothing to wait for
+    if (weact_epaper_is_asleep(dev))
+    {
+        return;
+    }
+
+    // A scheduled activation has not fired yet, BUSY is still low. The
+    // timeout counts from its deadline (esp_timer time, as the timer)
+    while (dev->activation_pending)
+    {
+        if (esp_timer_get_time() - dev->activation_at_us > WEACT_EPAPER_BUSY_TIMEOUT_US)
+        {
+            weact_epaper_lock(dev);
+            if (dev->activation_pending)
+            {
+                ESP_LOGW(TAG, "Scheduled activation did not fire, cancelled");
+                esp_timer_stop(dev->activation_timer);
+                dev->activation_pending = false;
+            }
+            weact_epaper_unlock(dev);
+            break;
+        }
+        weact_epaper_delay_ms(dev, 1);
+    }
+
+    // Wait while BUSY is HIGH (display is busy)
+    // SSD1680 BUSY logic: HIGH = busy, LOW = ready
+    // Polled every 10 ms: the update timing sees the end within one poll
+    while (weact_epaper_busy_level(dev) == 1)
+    {
+        weact_epaper_delay_ms(dev, 10);
+
+        if (weact_epaper_now_us(dev) - start_us > WEACT_EPAPER_BUSY_TIMEOUT_US)
+        {
+            ESP_LOGW(TAG, "Display busy timeout! Continuing anyway...");
+            break;
+        }
+    }
+
+    ESP_LOGI(TAG, "Display ready (waited %lu ms)",
+             (unsigned long)((weact_epaper_now_us(dev) - start_us) / 1000));
+
+    weact_epaper_update_done(dev);
+}
+
+void weact_epaper_reset(weact_epaper_t *dev)
+{
+    ESP_LOGI(TAG, "Hardware reset");
+
+    weact_epaper_set_rst(dev, 1);
+    weact_epaper_delay_ms(dev, 20);
+
+    weact_epaper_set_rst(dev, 0);
+    weact_epaper_delay_ms(dev, 2);
+
+    weact_epaper_set_rst(dev, 1);
+    weact_epaper_delay_ms(dev, 20);
+}
+
+// =============================================================================
+// INITIALIZATION
+// =============================================================================
+
+/**
+ * @brief Send gate scan, data entry mode and the full RAM window
+ *
+ * The window start is where the address counter begins, so it follows the
+ * X and Y directions of the data entry mode.
+ */
+static void weact_epaper_send_orientation(weact_epaper_t *dev)
+{
+    const bool x_inc = dev->data_entry_mode & 0x01;
+    const bool y_inc = dev->data_entry_mode & 0x02;
+
+    // Driver Output Control
+    // A[7:0]: MUX Gate lines = 250-1 = 249 = 0xF9
+    // A[8] and B[2:0]: Gate scanning sequence
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_DRIVER_OUTPUT_CONTROL);
+    weact_epaper_send_data_byte(dev, 0xF9); // 250-1 (height - 1) LOW byte
+    weact_epaper_send_data_byte(dev, 0x00); // HIGH byte
+    weact_epaper_send_data_byte(dev, dev->gate_scan); // GD, SM, TB (0x00 by default)
+
+    // Data Entry Mode
+    // Sets how data is written to RAM
+    // Bit 0-1: Address counter direction (00=Y-, 01=Y+, 10=X-, 11=X+)
+    // Bit 2: I/D mode (0=X direction, 1=Y direction)
+    // 0x03 = X direction, X increment, Y increment (default)
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_DATA_ENTRY_MODE);
+    weact_epaper_send_data_byte(dev, dev->data_entry_mode);
+
+    // Set RAM X address start/end
+    // For portrait with aligned rows: 16 bytes per row (128 pixels, using 122)
+    // X is in bytes: 0-15 (0x00 to 0x0F), start is where the counter begins
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_SET_RAM_X_ADDRESS_START_END);
+    weact_epaper_send_data_byte(dev, x_inc ? 0x00 : 0x0F); // X start
+    weact_epaper_send_data_byte(dev, x_inc ? 0x0F : 0x00); // X end
+
+    // Set RAM Y address start/end
+    // For portrait: treat as rows (tall dimension)
+    // Y is in pixels: 0 to 249 (0xF9)
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_SET_RAM_Y_ADDRESS_START_END);
+    weact_epaper_send_data_byte(dev, y_inc ? 0x00 : 0xF9); // Y start LOW
+    weact_epaper_send_data_byte(dev, 0x00); // Y start HIGH
+    weact_epaper_send_data_byte(dev, y_inc ? 0xF9 : 0x00); // Y end LOW (249)
+    weact_epaper_send_data_byte(dev, 0x00); // Y end HIGH
+}
+
+/**
+ * @brief Send the panel configuration registers
+ *
+ * Everything a hardware reset clears, taken from the cached state, so the
+ * same sequence serves the first init and a wake from deep sleep.
+ */
+static void weact_epaper_send_config(weact_epaper_t *dev)
+{
+    weact_epaper_send_orientation(dev);
+
+    // Border Waveform Control
+    // This controls the border color during refresh
+    // 0x05 = Follow LUT (normal behavior)
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_BORDER_WAVEFORM_CONTROL);
+    weact_epaper_send_data_byte(dev, 0x05);
+
+    // Display Update Control 1
+    // This sets the display update sequence options
+    // RAM bank inversion/bypass, see weact_epaper_set_ram_options()
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_DISPLAY_UPDATE_CONTROL_1);
+    weact_epaper_send_data_byte(dev, dev->update_control_1);
+    weact_epaper_send_data_byte(dev, 0x80);
+
+    // Temperature Sensor Control
+    // 0x80 = Internal temperature sensor
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_TEMP_SENSOR_CONTROL);
+    weact_epaper_send_data_byte(dev, 0x80);
+
+    // External temperature is lost with the register contents
+    if (weact_epaper_temperature_fresh(dev))
+    {
+        uint8_t value[2] = {(uint8_t)((uint16_t)dev->temperature_x16 >> 4), (uint8_t)(dev->temperature_x16 << 4)};
+        weact_epaper_send_command(dev, WEACT_EPAPER_CMD_TEMP_SENSOR_WRITE);
+        weact_epaper_send_data(dev, value, sizeof(value));
+    }
+}
+
+bool weact_epaper_setup(weact_epaper_t *dev, const weact_epaper_config_t *config)
+{
+    // Everything weact_epaper_deinit() releases, so a failure below can unwind through it
+    dev->lock = NULL;
+    dev->transport = NULL;
+    dev->owns_transport = false;
+    dev->trace = NULL;
+    dev->framebuffer = NULL;
+
+    memcpy(&dev->config, config, sizeof(weact_epaper_config_t));
+    dev->mode = WEACT_EPAPER_MODE_BW;
+    dev->framebuffer_red = NULL;
+    dev->gray_buffer = NULL;
+    dev->loaded_lut = NULL;
+    dev->page = -1;
+    dev->pages_loaded = 0;
+    dev->inverted = false;
+    dev->activation_timer = NULL;
+    dev->activation_pending = false;
+    dev->activation_at_us = 0;
+    dev->activated_at_us = 0;
+    memset(&dev->stats, 0, sizeof(dev->stats));
+    dev->update_start_us = 0;
+    memset(&dev->energy, 0, sizeof(dev->energy));
+    dev->currents = weact_epaper_default_currents();
+    dev->update_spi_bytes = 0;
+    dev->update_uah_total = 0.0f;
+    dev->update_count = 0;
+    dev->profile = WEACT_EPAPER_PROFILE_STANDARD;
+    dev->idle_power_off_ms = 0;
+    dev->lut_reload_ms = 0;
+    dev->analog_on = false;
+    dev->otp_lut_loaded = false;
+    dev->otp_lut_loaded_at_us = 0;
+    dev->power_timer = NULL;
+    dev->temperature_x16 = 0;
+    dev->temperature_at_us = 0;
+    dev->temperature_ttl_ms = 0;
+    dev->temperature_valid = false;
+    dev->power_state = WEACT_EPAPER_POWER_IDLE;
+    dev->auto_sleep_ms = 0;
+    dev->auto_sleep_state = WEACT_EPAPER_POWER_DEEP_SLEEP_1;
+    dev->sleep_timer = NULL;
+    dev->ram_valid = true;
+    dev->diff_base_valid = false;
+    dev->update_control_1 = 0x00; // Both RAM banks normal
+    dev->data_entry_mode = 0x03;  // X then Y, both increment
+    dev->gate_scan = 0x00;
+    dev->init_task = NULL;
+    dev->ready = NULL;
+    dev->init_busy_irq = false;
+
+    dev->lock = xSemaphoreCreateRecursiveMutex();
+    if (dev->lock == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to create device lock!");
+        weact_epaper_deinit(dev);
+        return false;
+    }
+
+    // -------------------------------------------------------------------------
+    // Transport (SPI + GPIO unless the application brings its own)
+    // -------------------------------------------------------------------------
+    dev->chunk_size = config->spi_chunk_size > 0 ? config->spi_chunk_size : WEACT_EPAPER_BUFFER_SIZE;
+    dev->owns_transport = config->transport == NULL;
+    dev->transport = dev->owns_transport ? weact_epaper_transport_new_spi(config) : config->transport;
+    if (dev->transport == NULL)
+    {
+        ESP_LOGE(TAG, "No transport!");
+        weact_epaper_deinit(dev);
+        return false;
+    }
+
+    // A transfer never outgrows what the transport (e.g. the SPI bus) can carry
+    if (dev->transport->max_write > 0 && dev->chunk_size > dev->transport->max_write)
+    {
+        dev->chunk_size = dev->transport->max_write;
+    }
+
+    // Bus trace wraps whichever transport is in use
+    dev->trace = NULL;
+    if (config->trace_size > 0)
+    {
+        dev->trace = weact_epaper_trace_new(dev->transport, config->trace_size, 0, dev->owns_transport);
+        if (dev->trace == NULL)
+        {
+            ESP_LOGE(TAG, "Failed to create bus trace!");
+            weact_epaper_deinit(dev);
+            return false;
+        }
+        dev->transport = weact_epaper_trace_transport(dev->trace);
+        dev->owns_transport = true;
+    }
+
+    // Energy accounting starts in IDLE (set above)
+    dev->energy_since_us = weact_epaper_now_us(dev);
+    dev->power_state_since_us = dev->energy_since_us;
+
+    // -------------------------------------------------------------------------
+    // Framebuffer Allocation
+    // -------------------------------------------------------------------------
+    ESP_LOGI(TAG, "Allocating framebuffer (%d bytes)", WEACT_EPAPER_BUFFER_SIZE);
+
+    dev->framebuffer = heap_caps_malloc(WEACT_EPAPER_BUFFER_SIZE, MALLOC_CAP_DMA);
+    if (dev->framebuffer == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to allocate framebuffer!");
+        weact_epaper_deinit(dev);
+        return false;
+    }
+
+    // Initialize to white (0xFF in e-paper RAM = white)
+    memset(dev->framebuffer, 0xFF, WEACT_EPAPER_BUFFER_SIZE);
+
+    return true;
+}
+
+void weact_epaper_init_registers(weact_epaper_t *dev)
+{
+    weact_epaper_lock(dev);
+
+    // A hardware reset (if any) has just ended deep sleep and cleared the LUT register
+    weact_epaper_set_power_state(dev, WEACT_EPAPER_POWER_IDLE);
+    dev->analog_on = false;
+    dev->otp_lut_loaded = false;
+    dev->loaded_lut = NULL;
+    weact_epaper_wait_until_idle(dev);
+
+    // Software Reset
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_SW_RESET);
+    weact_epaper_wait_until_idle(dev);
+
+    weact_epaper_send_config(dev);
+    weact_epaper_unlock(dev);
+}
+
+bool weact_epaper_init(weact_epaper_t *dev, const weact_epaper_config_t *config)
+{
+    ESP_LOGI(TAG, "=================================================");
+    ESP_LOGI(TAG, "Initializing SSD1680 (250x122 e-paper)");
+    ESP_LOGI(TAG, "=================================================");
+
+    if (!weact_epaper_setup(dev, config))
+    {
+        return false;
+    }
+
+    // -------------------------------------------------------------------------
+    // Hardware Reset
+    // -------------------------------------------------------------------------
+    weact_epaper_reset(dev);
+
+    // -------------------------------------------------------------------------
+    // SSD1680 Initialization Sequence
+    // -------------------------------------------------------------------------
+    ESP_LOGI(TAG, "Sending SSD1680 initialization sequence");
+
+    // Waits for the reset first
+    weact_epaper_init_registers(dev);
+
+    // Load LUT (optional - comment out to use internal LUT)
+    // ESP_LOGI(TAG, "Loading custom LUT");
+    // weact_epaper_send_command(dev, WEACT_EPAPER_CMD_WRITE_LUT_REGISTER);
+    // weact_epaper_send_data(dev, weact_epaper_lut_full_update, sizeof(weact_epaper_lut_full_update));
+
+    ESP_LOGI(TAG, "=================================================");
+    ESP_LOGI(TAG, "SSD1680 initialization complete!");
+    ESP_LOGI(TAG, "=================================================");
+
+    return true;
+}
+
+void weact_epaper_deinit(weact_epaper_t *dev)
+{
+    ESP_LOGI(TAG, "Releasing SSD1680 instance");
+
+    // Let a running init or refresh finish before pulling the bus (a
+    // failed setup has no lock or transport, and nothing running)
+    if (dev->lock != NULL && dev->transport != NULL)
+    {
+        weact_epaper_wait_ready(dev, portMAX_DELAY);
+        if (weact_epaper_is_busy(dev))
+        {
+            weact_epaper_wait_until_idle(dev);
+        }
+    }
+
+    esp_timer_handle_t timers[] = {dev->activation_timer, dev->power_timer, dev->sleep_timer};
+    for (size_t i = 0; i < sizeof(timers) / sizeof(timers[0]); i++)
+    {
+        if (timers[i] != NULL)
+        {
+            esp_timer_stop(timers[i]);
+            esp_timer_delete(timers[i]);
+        }
+    }
+    dev->activation_timer = NULL;
+    dev->power_timer = NULL;
+    dev->sleep_timer = NULL;
+
+    if (dev->owns_transport && dev->transport != NULL)
+    {
+        dev->transport->del(dev->transport);
+    }
+    dev->transport = NULL;
+    dev->owns_transport = false;
+    dev->trace = NULL;
+
+    heap_caps_free(dev->framebuffer);
+    heap_caps_free(dev->framebuffer_red);
+    heap_caps_free(dev->gray_buffer);
+    dev->framebuffer = NULL;
+    dev->framebuffer_red = NULL;
+    dev->gray_buffer = NULL;
+
+    if (dev->ready != NULL)
+    {
+        vEventGroupDelete(dev->ready);
+        dev->ready = NULL;
+    }
+
+    if (dev->lock != NULL)
+    {
+        vSemaphoreDelete(dev->lock);
+        dev->lock = NULL;
+    }
+}
+
+// =============================================================================
+// ASYNCHRONOUS INITIALIZATION
+// =============================================================================
+
+static void IRAM_ATTR weact_epaper_busy_isr(void *arg)
+{
+    weact_epaper_t *dev = (weact_epaper_t *)arg;
+    BaseType_t woken = pdFALSE;
+
+    if (dev->init_task != NULL)
+    {
+        vTaskNotifyGiveFromISR(dev->init_task, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+/**
+ * @brief Block the init task until BUSY falls
+ *
+ * Interrupt driven when the transport reports BUSY edges, polled otherwise.
+ *
+ * @return false on timeout
+ */
+static bool weact_epaper_init_wait_busy(weact_epaper_t *dev, uint32_t timeout_ms)
+{
+    if (!dev->init_busy_irq)
+    {
+        for (uint32_t waited = 0; weact_epaper_busy_level(dev) == 1; waited++)
+        {
+            if (waited >= timeout_ms)
+            {
+                ESP_LOGW(TAG, "Init step %d: busy timeout, continuing anyway", (int)dev->init_state);
+                return false;
+            }
+            weact_epaper_delay_ms(dev, 1);
+        }
+        return true;
+    }
+
+    // Drop edges from earlier steps; an edge after the level check is kept
+    ulTaskNotifyTake(pdTRUE, 0);
+
+    while (weact_epaper_busy_level(dev) == 1)
+    {
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms)) == 0)
+        {
+            ESP_LOGW(TAG, "Init step %d: busy timeout, continuing anyway", (int)dev->init_state);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Runs the init state machine; sleeps on the BUSY interrupt between steps
+ */
+static void weact_epaper_init_task(void *arg)
+{
+    weact_epaper_t *dev = (weact_epaper_t *)arg;
+    int64_t start = weact_epaper_now_us(dev);
+
+    while (dev->init_state != WEACT_EPAPER_INIT_DONE)
+    {
+        switch (dev->init_state)
+        {
+        case WEACT_EPAPER_INIT_RESET:
+            // RST is already high from GPIO setup
+            weact_epaper_set_rst(dev, 0);
+            weact_epaper_delay_us(dev, 200);
+            weact_epaper_set_rst(dev, 1);
+            weact_epaper_delay_ms(dev, 10);
+            weact_epaper_init_wait_busy(dev, 100);
+            dev->init_state = WEACT_EPAPER_INIT_SW_RESET;
+            break;
+
+        case WEACT_EPAPER_INIT_SW_RESET:
+            weact_epaper_send_command(dev, WEACT_EPAPER_CMD_SW_RESET);
+            weact_epaper_init_wait_busy(dev, 100);
+            dev->init_state = WEACT_EPAPER_INIT_CONFIG;
+            break;
+
+        case WEACT_EPAPER_INIT_CONFIG:
+            weact_epaper_send_config(dev);
+            dev->init_state = dev->init_clear ? WEACT_EPAPER_INIT_FILL_RED : WEACT_EPAPER_INIT_DONE;
+            break;
+
+        case WEACT_EPAPER_INIT_FILL_RED:
+            // Auto write pattern: the controller fills the bank with white
+            // itself, so the framebuffer stays free for the first frame
+            weact_epaper_send_command(dev, WEACT_EPAPER_CMD_AUTO_WRITE_RED_PATTERN);
+            weact_epaper_send_data_byte(dev, 0xF7);
+            weact_epaper_init_wait_busy(dev, 100);
+            dev->init_state = WEACT_EPAPER_INIT_FILL_BW;
+            break;
+
+        case WEACT_EPAPER_INIT_FILL_BW:
+            weact_epaper_send_command(dev, WEACT_EPAPER_CMD_AUTO_WRITE_BW_PATTERN);
+            weact_epaper_send_data_byte(dev, 0xF7);
+            weact_epaper_init_wait_busy(dev, 100);
+            dev->init_state = WEACT_EPAPER_INIT_DONE;
+            break;
+
+        default:
+            dev->init_state = WEACT_EPAPER_INIT_DONE;
+            break;
+        }
+    }
+
+    if (dev->init_busy_irq)
+    {
+        dev->transport->set_busy_callback(dev->transport, NULL, NULL);
+        dev->init_busy_irq = false;
+    }
+
+    ESP_LOGI(TAG, "SSD1680 ready after %lld us (asynchronous init)", (long long)(weact_epaper_now_us(dev) - start));
+
+    dev->init_task = NULL;
+    xEventGroupSetBits(dev->ready, WEACT_EPAPER_READY_BIT);
+    vTaskDelete(NULL);
+}
+
+bool weact_epaper_init_async(weact_epaper_t *dev, const weact_epaper_config_t *config, bool clear)
+{
+    ESP_LOGI(TAG, "Initializing SSD1680 (asynchronous)");
+
+    if (!weact_epaper_setup(dev, config))
+    {
+        return false;
+    }
+
+    dev->ready = xEventGroupCreate();
+    if (dev->ready == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to create ready event group!");
+        weact_epaper_deinit(dev);
+        return false;
+    }
+
+    dev->init_state = WEACT_EPAPER_INIT_RESET;
+    dev->init_clear = clear;
+
+    // Installed before the task exists; the ISR ignores edges until then
+    dev->init_busy_irq = dev->transport->set_busy_callback != NULL &&
+                         dev->transport->set_busy_callback(dev->transport, weact_epaper_busy_isr, dev) == ESP_OK;
+    if (!dev->init_busy_irq)
+    {
+        ESP_LOGI(TAG, "No BUSY interrupt, init task polls");
+    }
+
+    // Higher priority than the UI so each step runs as soon as BUSY falls
+    if (xTaskCreate(weact_epaper_init_task, "epaper_init", 3072, dev, 5, &dev->init_task) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create init task!");
+        if (dev->init_busy_irq)
+        {
+            dev->transport->set_busy_callback(dev->transport, NULL, NULL);
+            dev->init_busy_irq = false;
+        }
+
+        // No task will set the ready bit, deinit must not wait for it
+        dev->init_task = NULL;
+        vEventGroupDelete(dev->ready);
+        dev->ready = NULL;
+        weact_epaper_deinit(dev);
+        return false;
+    }
+
+    return true;
+}
+
+bool weact_epaper_wait_ready(weact_epaper_t *dev, uint32_t timeout_ms)
+{
+    if (dev->ready == NULL)
+    {
+        return true;
+    }
+
+    EventBits_t bits = xEventGroupWaitBits(dev->ready, WEACT_EPAPER_READY_BIT, pdFALSE, pdTRUE,
+                                           timeout_ms == 0 ? 0 : pdMS_TO_TICKS(timeout_ms));
+    return (bits & WEACT_EPAPER_READY_BIT) != 0;
+}
+
+bool weact_epaper_is_ready(weact_epaper_t *dev)
+{
+    return dev->ready == NULL || (xEventGroupGetBits(dev->ready) & WEACT_EPAPER_READY_BIT) != 0;
+}
+
+// =============================================================================
+// DRAWING FUNCTIONS
+// =============================================================================
+
+void weact_epaper_draw_pixel(weact_epaper_t *dev, int x, int y, uint8_t color)
+{
+    if (x < 0 || x >= WEACT_EPAPER_WIDTH || y < 0 || y >= WEACT_EPAPER_HEIGHT)
+    {
+        return;
+    }
+
+    if (dev->mode == WEACT_EPAPER_MODE_GRAY4)
+    {
+        weact_epaper_draw_pixel_gray(dev, x, y, color ? WEACT_EPAPER_GRAY_BLACK : WEACT_EPAPER_GRAY_WHITE);
+        return;
+    }
+
+    // Calculate byte position with aligned row width
+    // Each row is WEACT_EPAPER_WIDTH_BYTES (16) bytes, even though we only use 15.25
+    int byte_index = y * WEACT_EPAPER_WIDTH_BYTES + (x / 8);
+    int bit_index = x % 8;
+
+    if (dev->mode == WEACT_EPAPER_MODE_BWR)
+    {
+        // RED RAM: 1 = red (wins over BW RAM), 0 = show BW RAM
+        if (color == WEACT_EPAPER_COLOR_RED)
+        {
+            dev->framebuffer_red[byte_index] |= (1 << (7 - bit_index));
+            dev->framebuffer[byte_index] |= (1 << (7 - bit_index));
+            return;
+        }
+        dev->framebuffer_red[byte_index] &= ~(1 << (7 - bit_index));
+    }
+
+    // Red on a black/white panel falls through as black
+    if (color == WEACT_EPAPER_COLOR_WHITE)
+    {
+        // WHITE: Set bit to 1
+        dev->framebuffer[byte_index] |= (1 << (7 - bit_index));
+    }
+    else
+    {
+        // BLACK: Clear bit to 0
+        dev->framebuffer[byte_index] &= ~(1 << (7 - bit_index));
+    }
+}
+
+void weact_epaper_draw_pixel_gray(weact_epaper_t *dev, int x, int y, uint8_t level)
+{
+    if (x < 0 || x >= WEACT_EPAPER_WIDTH || y < 0 || y >= WEACT_EPAPER_HEIGHT || dev->gray_buffer == NULL)
+    {
+        return;
+    }
+
+    // 4 pixels per byte, leftmost pixel in bits 7-6
+    int byte_index = y * WEACT_EPAPER_GRAY_WIDTH_BYTES + (x / 4);
+    int shift = 6 - 2 * (x % 4);
+
+    dev->gray_buffer[byte_index] = (dev->gray_buffer[byte_index] & ~(0x03 << shift)) | ((level & 0x03) << shift);
+}
+
+/**
+ * Gather every other bit of a 2bpp byte into a nibble.
+ * Input bits 6, 4, 2, 0 become output bits 3, 2, 1, 0.
+ */
+static inline uint8_t gray4_compress(uint8_t b)
+{
+    b &= 0x55;
+    b = (b | (b >> 1)) & 0x33;
+    b = (b | (b >> 2)) & 0x0F;
+    return b;
+}
+
+void weact_epaper_gray4_split(const uint8_t *gray, size_t gray_len, uint8_t *plane_bw, uint8_t *plane_red)
+{
+    for (size_t i = 0; i + 1 < gray_len; i += 2)
+    {
+        uint8_t g0 = gray[i];
+        uint8_t g1 = gray[i + 1];
+
+        *plane_bw++ = (gray4_compress(g0 >> 1) << 4) | gray4_compress(g1 >> 1);
+        *plane_red++ = (gray4_compress(g0) << 4) | gray4_compress(g1);
+    }
+}
+
+void weact_epaper_draw_rectangle(weact_epaper_t *dev, int x0, int y0, int x1, int y1, bool filled)
+{
+    weact_epaper_draw_rectangle_color(dev, x0, y0, x1, y1, filled, WEACT_EPAPER_COLOR_BLACK);
+}
+
+void weact_epaper_draw_rectangle_color(weact_epaper_t *dev, int x0, int y0, int x1, int y1, bool filled,
+                                       uint8_t color)
+{
+    if (x0 > x1)
+    {
+        int temp = x0;
+        x0 = x1;
+        x1 = temp;
+    }
+    if (y0 > y1)
+    {
+        int temp = y0;
+        y0 = y1;
+        y1 = temp;
+    }
+
+    if (filled)
+    {
+        for (int y = y0; y <= y1; y++)
+        {
+            for (int x = x0; x <= x1; x++)
+            {
+                weact_epaper_draw_pixel(dev, x, y, color);
+            }
+        }
+    }
+    else
+    {
+        for (int x = x0; x <= x1; x++)
+        {
+            weact_epaper_draw_pixel(dev, x, y0, color);
+            weact_epaper_draw_pixel(dev, x, y1, color);
+        }
+        for (int y = y0; y <= y1; y++)
+        {
+            weact_epaper_draw_pixel(dev, x0, y, color);
+            weact_epaper_draw_pixel(dev, x1, y, color);
+        }
+    }
+}
+
+void weact_epaper_clear_screen(weact_epaper_t *dev)
+{
+    ESP_LOGI(TAG, "Clearing screen to white");
+
+    if (weact_epaper_is_busy(dev))
+    {
+        weact_epaper_wait_until_idle(dev);
+    }
+    weact_epaper_lock_awake(dev);
+    int64_t start_us = weact_epaper_now_us(dev);
+
+    // Fill framebuffer with 0xFF (all white)
+    memset(dev->framebuffer, 0xFF, WEACT_EPAPER_BUFFER_SIZE);
+    if (dev->gray_buffer != NULL)
+    {
+        memset(dev->gray_buffer, 0xFF, WEACT_EPAPER_GRAY_BUFFER_SIZE);
+    }
+
+    // Set RAM address to start position
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_SET_RAM_X_ADDRESS_COUNTER);
+    weact_epaper_send_data_byte(dev, 0x00);
+
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_SET_RAM_Y_ADDRESS_COUNTER);
+    weact_epaper_send_data_byte(dev, 0x00);
+    weact_epaper_send_data_byte(dev, 0x00);
+
+    // Write white data to both BW and RED RAM (if applicable)
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_WRITE_RAM_BW);
+    weact_epaper_send_data(dev, dev->framebuffer, WEACT_EPAPER_BUFFER_SIZE);
+
+    // Also clear RED RAM (even if display doesn't support red)
+    // This prevents any residual data
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_SET_RAM_X_ADDRESS_COUNTER);
+    weact_epaper_send_data_byte(dev, 0x00);
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_SET_RAM_Y_ADDRESS_COUNTER);
+    weact_epaper_send_data_byte(dev, 0x00);
+    weact_epaper_send_data_byte(dev, 0x00);
+
+    // On tri-color panels a set RED RAM bit means red, so clear it to 0x00
+    if (dev->mode == WEACT_EPAPER_MODE_BWR)
+    {
+        memset(dev->framebuffer_red, 0x00, WEACT_EPAPER_BUFFER_SIZE);
+    }
+
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_WRITE_RAM_RED);
+    weact_epaper_send_data(dev, dev->mode == WEACT_EPAPER_MODE_BWR ? dev->framebuffer_red : dev->framebuffer,
+                           WEACT_EPAPER_BUFFER_SIZE);
+
+    weact_epaper_stats_uploaded(dev, start_us);
+    start_us = weact_epaper_now_us(dev);
+
+    // Trigger display update: always the full OTP sequence (0xF7) so the
+    // clear also removes ghosting, whatever the refresh profile. A fresh
+    // cached temperature replaces the sensor conversion (0xD7).
+    uint8_t sequence = weact_epaper_temperature_fresh(dev) ? 0xD7 : 0xF7;
+
+    weact_epaper_power_timer_stop(dev);
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_DISPLAY_UPDATE_CONTROL_2);
+    weact_epaper_send_data_byte(dev, sequence);
+
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_MASTER_ACTIVATION);
+    weact_epaper_stats_activated(dev, start_us);
+
+    weact_epaper_note_sequence(dev, sequence);
+    dev->ram_valid = true;
+    dev->diff_base_valid = dev->mode == WEACT_EPAPER_MODE_BW;
+    dev->pages_loaded = 0;
+    weact_epaper_unlock(dev);
+
+    weact_epaper_wait_until_idle(dev);
+
+    ESP_LOGI(TAG, "Screen cleared successfully");
+}
+
+// =============================================================================
+// GRAYSCALE AND TRI-COLOR MODES
+// =============================================================================
+
+bool weact_epaper_set_mode(weact_epaper_t *dev, weact_epaper_mode_t mode)
+{
+    // The planes and Display Update Control 1 change, not under a refresh
+    if (weact_epaper_is_busy(dev))
+    {
+        weact_epaper_wait_until_idle(dev);
+    }
+
+    weact_epaper_lock(dev);
+    dev->diff_base_valid = false;
+
+    if (mode == WEACT_EPAPER_MODE_GRAY4)
+    {
+        if (dev->framebuffer_red == NULL)
+        {
+            dev->framebuffer_red = heap_caps_malloc(WEACT_EPAPER_BUFFER_SIZE, MALLOC_CAP_DMA);
+        }
+        if (dev->gray_buffer == NULL)
+        {
+            dev->gray_buffer = heap_caps_malloc(WEACT_EPAPER_GRAY_BUFFER_SIZE, MALLOC_CAP_8BIT);
+        }
+        if (dev->framebuffer_red == NULL || dev->gray_buffer == NULL)
+        {
+            weact_epaper_unlock(dev);
+            ESP_LOGE(TAG, "Failed to allocate grayscale buffers!");
+            return false;
+        }
+
+        // All pixels level 3 (white)
+        memset(dev->gray_buffer, 0xFF, WEACT_EPAPER_GRAY_BUFFER_SIZE);
+    }
+    else if (mode == WEACT_EPAPER_MODE_BWR)
+    {
+        if (dev->framebuffer_red == NULL)
+        {
+            dev->framebuffer_red = heap_caps_malloc(WEACT_EPAPER_BUFFER_SIZE, MALLOC_CAP_DMA);
+        }
+        if (dev->framebuffer_red == NULL)
+        {
+            weact_epaper_unlock(dev);
+            ESP_LOGE(TAG, "Failed to allocate red plane!");
+            return false;
+        }
+
+        // No red pixels
+        memset(dev->framebuffer_red, 0x00, WEACT_EPAPER_BUFFER_SIZE);
+    }
+
+    dev->mode = mode;
+
+    // GRAY4 inverts both banks, the other modes only BW RAM
+    weact_epaper_apply_ram_options(dev);
+    weact_epaper_unlock(dev);
+
+    ESP_LOGI(TAG, "Mode: %s", mode == WEACT_EPAPER_MODE_GRAY4 ? "4-level gray" :
+                              mode == WEACT_EPAPER_MODE_BWR ? "black/white/red" : "black/white");
+
+    return true;
+}
+
+/**
+ * @brief Load a 159-byte custom waveform (LUT + voltages) into the controller
+ */
+static void weact_epaper_load_lut(weact_epaper_t *dev, const uint8_t *lut)
+{
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_WRITE_LUT_REGISTER);
+    weact_epaper_send_data(dev, lut, WEACT_EPAPER_LUT_WAVEFORM_SIZE);
+
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_END_OPTION);
+    weact_epaper_send_data_byte(dev, lut[153]);
+
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_GATE_DRIVING_VOLTAGE);
+    weact_epaper_send_data_byte(dev, lut[154]);
+
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_SOURCE_DRIVING_VOLTAGE);
+    weact_epaper_send_data(dev, &lut[155], 3);
+
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_WRITE_VCOM_REGISTER);
+    weact_epaper_send_data_byte(dev, lut[158]);
+
+    dev->loaded_lut = lut;
+    dev->otp_lut_loaded = false;
+}
+
+static void weact_epaper_write_ram(weact_epaper_t *dev, uint8_t ram_cmd, const uint8_t *data)
+{
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_SET_RAM_X_ADDRESS_COUNTER);
+    weact_epaper_send_data_byte(dev, 0x00);
+
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_SET_RAM_Y_ADDRESS_COUNTER);
+    weact_epaper_send_data_byte(dev, 0x00); // Y LOW
+    weact_epaper_send_data_byte(dev, 0x00); // Y HIGH
+
+    weact_epaper_send_command(dev, ram_cmd);
+    weact_epaper_send_data(dev, data, WEACT_EPAPER_BUFFER_SIZE);
+    dev->pages_loaded &= (uint8_t)~weact_epaper_page_bit(ram_cmd);
+}
+
+void weact_epaper_write_window(weact_epaper_t *dev, uint8_t ram_cmd, uint8_t x_start, uint8_t x_end,
+                               int y_start, int y_end, const uint8_t *data, size_t len)
+{
+    const bool x_inc = dev->data_entry_mode & 0x01;
+    const bool y_inc = dev->data_entry_mode & 0x02;
+    const uint8_t x_window[2] = {x_start, x_end};
+    const uint8_t y_window[4] = {(uint8_t)y_start, (uint8_t)(y_start >> 8), (uint8_t)y_end, (uint8_t)(y_end >> 8)};
+    const uint8_t x_full[2] = {x_inc ? 0x00 : 0x0F, x_inc ? 0x0F : 0x00};
+    const uint8_t y_full[4] = {y_inc ? 0x00 : 0xF9, 0x00, y_inc ? 0xF9 : 0x00, 0x00};
+    weact_epaper_batch_t batch = {.count = 0};
+
+    // RAM must not change under a running (or scheduled) refresh
+    if (weact_epaper_is_busy(dev))
+    {
+        weact_epaper_wait_until_idle(dev);
+    }
+
+    weact_epaper_lock_awake(dev);
+    int64_t start_us = weact_epaper_now_us(dev);
+
+    // Counters start at the window start; the full window is restored after
+    weact_epaper_batch_command(dev, &batch, WEACT_EPAPER_CMD_SET_RAM_X_ADDRESS_START_END, x_window, 2);
+    weact_epaper_batch_command(dev, &batch, WEACT_EPAPER_CMD_SET_RAM_Y_ADDRESS_START_END, y_window, 4);
+    weact_epaper_batch_command(dev, &batch, WEACT_EPAPER_CMD_SET_RAM_X_ADDRESS_COUNTER, x_window, 1);
+    weact_epaper_batch_command(dev, &batch, WEACT_EPAPER_CMD_SET_RAM_Y_ADDRESS_COUNTER, y_window, 2);
+    weact_epaper_batch_command(dev, &batch, ram_cmd, data, len);
+    weact_epaper_batch_command(dev, &batch, WEACT_EPAPER_CMD_SET_RAM_X_ADDRESS_START_END, x_full, 2);
+    weact_epaper_batch_command(dev, &batch, WEACT_EPAPER_CMD_SET_RAM_Y_ADDRESS_START_END, y_full, 4);
+    weact_epaper_batch_run(dev, &batch);
+
+    dev->pages_loaded &= (uint8_t)~weact_epaper_page_bit(ram_cmd);
+    weact_epaper_stats_uploaded(dev, start_us);
+    weact_epaper_unlock(dev);
+}
+
+void weact_epaper_display_frame(weact_epaper_t *dev)
+{
+    weact_epaper_upload(dev);
+    weact_epaper_refresh(dev);
+
+    ESP_LOGI(TAG, "Display update complete!");
+}
+
+void weact_epaper_upload(weact_epaper_t *dev)
+{
+    // RAM must not change under a running (or scheduled) refresh
+    if (weact_epaper_is_busy(dev))
+    {
+        weact_epaper_wait_until_idle(dev);
+    }
+
+    ESP_LOGI(TAG, "Uploading framebuffer to display");
+
+    weact_epaper_lock_awake(dev);
+    int64_t start_us = weact_epaper_now_us(dev);
+
+    // A regular frame replaces the page set in BW RAM
+    if (dev->page >= 0)
+    {
+        dev->page = -1;
+        weact_epaper_apply_ram_options(dev);
+    }
+
+    if (dev->mode == WEACT_EPAPER_MODE_GRAY4)
+    {
+        // High bits to BW RAM, low bits to RED RAM
+        weact_epaper_gray4_split(dev->gray_buffer, WEACT_EPAPER_GRAY_BUFFER_SIZE,
+                                 dev->framebuffer, dev->framebuffer_red);
+        weact_epaper_write_planes(dev, dev->framebuffer, dev->framebuffer_red);
+    }
+    else if (dev->mode == WEACT_EPAPER_MODE_BWR)
+    {
+        // Black/white and red planes back to back
+        weact_epaper_write_planes(dev, dev->framebuffer, dev->framebuffer_red);
+    }
+    else
+    {
+        // Write to Black/White RAM
+        weact_epaper_write_ram(dev, WEACT_EPAPER_CMD_WRITE_RAM_BW, dev->framebuffer);
+    }
+
+    dev->ram_valid = true;
+    dev->diff_base_valid = false; // RED RAM still holds an older image
+    weact_epaper_stats_uploaded(dev, start_us);
+    weact_epaper_unlock(dev);
+}
+
+/**
+ * @brief Track what an update sequence leaves behind in the controller
+ *
+ * @param dev Device handle
+ * @param sequence DISPLAY_UPDATE_CONTROL_2 value just activated
+ */
+static void weact_epaper_note_sequence(weact_epaper_t *dev, uint8_t sequence)
+{
+    // Refresh type for the energy accounting: mode 2, custom LUT kept in
+    // the LUT register (no OTP load), or the OTP mode 1 waveform
+    if (sequence & 0x04)
+    {
+        if (sequence & 0x08)
+        {
+            dev->energy.partial_refreshes++;
+        }
+        else if (!(sequence & 0x10) && dev->loaded_lut != NULL)
+        {
+            dev->energy.lut_refreshes++;
+        }
+        else
+        {
+            dev->energy.full_refreshes++;
+        }
+    }
+    else if ((sequence & 0x02) && dev->analog_on)
+    {
+        dev->energy.power_offs++;
+    }
+
+    // Bit 5: internal sensor reading replaced the temperature register
+    if (sequence & 0x20)
+    {
+        dev->temperature_valid = false;
+    }
+
+    // Bit 4: OTP LUT loaded (for the temperature in the register), bit 3
+    // selects the display mode 2 (differential) waveform instead
+    if (sequence & 0x10)
+    {
+        dev->loaded_lut = NULL;
+        dev->otp_lut_loaded = !(sequence & 0x08);
+        dev->otp_lut_loaded_at_us = weact_epaper_now_us(dev);
+    }
+
+    // Bit 2: display update running
+    if (sequence & 0x04)
+    {
+        weact_epaper_set_power_state(dev, WEACT_EPAPER_POWER_ACTIVE);
+    }
+
+    // Bit 6: analog on; bit 1: analog off at the end
+    if (sequence & 0x02)
+    {
+        dev->analog_on = false;
+    }
+    else if (sequence & 0x40)
+    {
+        dev->analog_on = true;
+    }
+}
+
+/**
+ * @brief Load the LUT for the current mode and select the update sequence
+ *
+ * Everything except MASTER_ACTIVATION, so a scheduled activation only has
+ * one command byte left on its latency path.
+ *
+ * DISPLAY_UPDATE_CONTROL_2 bits: 7 clock on, 6 analog on, 5 load temperature,
+ * 4 load OTP LUT, 2 display (mode 1), 1 analog off, 0 clock off.
+ */
+static uint8_t weact_epaper_arm_update(weact_epaper_t *dev)
+{
+    const uint8_t *lut = NULL;
+    uint8_t sequence;
+
+    weact_epaper_power_timer_stop(dev);
+
+    // Deep sleep 2 lost the RAM contents
+    if (!dev->ram_valid)
+    {
+        weact_epaper_upload(dev);
+    }
+
+    if (dev->mode == WEACT_EPAPER_MODE_GRAY4)
+    {
+        lut = weact_epaper_lut_gray4;
+    }
+    else if (dev->page >= 0)
+    {
+        lut = weact_epaper_lut_page;
+    }
+
+    if (lut != NULL && dev->loaded_lut != lut)
+    {
+        weact_epaper_load_lut(dev, lut);
+    }
+
+    if (dev->profile == WEACT_EPAPER_PROFILE_STANDARD)
+    {
+        // 0xF7 = clock/analog on, temperature + OTP LUT, display, power down
+        // 0xC7 = same with the LUT register as is (custom LUT)
+        sequence = lut != NULL ? 0xC7 : 0xF7;
+    }
+    else
+    {
+        // Burst: display only, power up if needed, never power down here
+        sequence = 0x04;
+        if (!dev->analog_on)
+        {
+            sequence |= 0xC0;
+        }
+
+        bool stale = dev->lut_reload_ms > 0 &&
+                     weact_epaper_now_us(dev) - dev->otp_lut_loaded_at_us > (int64_t)dev->lut_reload_ms * 1000;
+        if (lut == NULL && (!dev->otp_lut_loaded || stale))
+        {
+            // Temperature + OTP LUT (needs the clock)
+            sequence |= 0xB0;
+        }
+    }
+
+    // A fresh cached temperature is already in the register: skip the
+    // internal sensor conversion and pick the OTP LUT with it
+    if ((sequence & 0x20) && weact_epaper_temperature_fresh(dev))
+    {
+        sequence &= (uint8_t)~0x20;
+    }
+
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_DISPLAY_UPDATE_CONTROL_2);
+    weact_epaper_send_data_byte(dev, sequence);
+
+    return sequence;
+}
+
+void weact_epaper_activate(weact_epaper_t *dev)
+{
+    // The update sequence must not go out during a running (or scheduled) refresh
+    if (weact_epaper_is_busy(dev))
+    {
+        weact_epaper_wait_until_idle(dev);
+    }
+
+    weact_epaper_lock_awake(dev);
+    int64_t start_us = weact_epaper_now_us(dev);
+
+    uint8_t sequence = weact_epaper_arm_update(dev);
+
+    // Master Activation (start the refresh)
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_MASTER_ACTIVATION);
+    weact_epaper_stats_activated(dev, start_us);
+    weact_epaper_note_sequence(dev, sequence);
+
+    weact_epaper_unlock(dev);
+}
+
+void weact_epaper_refresh(weact_epaper_t *dev)
+{
+    weact_epaper_activate(dev);
+
+    // Wait for refresh to complete
+    weact_epaper_wait_until_idle(dev);
+}
+
+bool weact_epaper_is_busy(weact_epaper_t *dev)
+{
+    // The timer callbacks update the same state under the lock
+    weact_epaper_lock(dev);
+
+    // BUSY stays high in deep sleep
+    if (weact_epaper_is_asleep(dev))
+    {
+        weact_epaper_unlock(dev);
+        return false;
+    }
+
+    bool busy = dev->activation_pending || weact_epaper_busy_level(dev) == 1;
+    if (!busy)
+    {
+        weact_epaper_update_done(dev);
+    }
+
+    weact_epaper_unlock(dev);
+    return busy;
+}
+
+// =============================================================================
+// DEADLINE-ALIGNED ACTIVATION
+// =============================================================================
+
+static void weact_epaper_activation_timer_cb(void *arg)
+{
+    weact_epaper_t *dev = (weact_epaper_t *)arg;
+
+    weact_epaper_lock(dev);
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_MASTER_ACTIVATION);
+    dev->activated_at_us = weact_epaper_now_us(dev);
+    weact_epaper_note_sequence(dev, dev->armed_sequence);
+    dev->activation_pending = false;
+    weact_epaper_unlock(dev);
+}
+
+bool weact_epaper_schedule_activation(weact_epaper_t *dev, int64_t at_us)
+{
+    // As weact_epaper_activate(): arm only once the previous refresh is done
+    if (weact_epaper_is_busy(dev))
+    {
+        weact_epaper_wait_until_idle(dev);
+    }
+
+    if (dev->activation_timer == NULL)
+    {
+        const esp_timer_create_args_t timer_args = {
+            .callback = weact_epaper_activation_timer_cb,
+            .arg = dev,
+            .name = "epaper_activate",
+        };
+
+        if (esp_timer_create(&timer_args, &dev->activation_timer) != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Failed to create activation timer");
+            return false;
+        }
+    }
+
+    weact_epaper_lock_awake(dev);
+    int64_t start_us = weact_epaper_now_us(dev);
+
+    // Everything but the activation byte goes out now
+    dev->armed_sequence = weact_epaper_arm_update(dev);
+
+    // at_us is esp_timer time, the time base the timer is armed in
+    int64_t delay_us = at_us - esp_timer_get_time();
+    // A deadline already reached simply means now
+    if (delay_us <= 0)
+    {
+        ESP_LOGD(TAG, "Activation deadline reached %lld us ago, activating now", (long long)-delay_us);
+        weact_epaper_send_command(dev, WEACT_EPAPER_CMD_MASTER_ACTIVATION);
+        weact_epaper_stats_activated(dev, start_us);
+        weact_epaper_note_sequence(dev, dev->armed_sequence);
+        weact_epaper_unlock(dev);
+        return true;
+    }
+
+    // Arming counts as activation; the wait for the deadline stays in the update time
+    weact_epaper_phase_stats_add(&dev->stats.activate, weact_epaper_now_us(dev) - start_us);
+    weact_epaper_stats_begin(dev, start_us);
+
+    dev->activation_at_us = at_us;
+    dev->activation_pending = true;
+    if (esp_timer_start_once(dev->activation_timer, (uint64_t)delay_us) != ESP_OK)
+    {
+        dev->activation_pending = false;
+        weact_epaper_unlock(dev);
+        ESP_LOGE(TAG, "Failed to start activation timer");
+        return false;
+    }
+
+    weact_epaper_unlock(dev);
+    return true;
+}
+
+// =============================================================================
+// DISPLAY UPDATE CONTROL 1 (RAM OPTIONS)
+// =============================================================================
+
+void weact_epaper_set_ram_options(weact_epaper_t *dev, weact_epaper_ram_option_t bw, weact_epaper_ram_option_t red)
+{
+    if (weact_epaper_is_busy(dev))
+    {
+        weact_epaper_wait_until_idle(dev);
+    }
+
+    weact_epaper_lock(dev);
+
+    // A[7:4] = RED RAM option, A[3:0] = BW RAM option
+    // B = 0x80: source output S8..S167 (WeAct wiring)
+    dev->update_control_1 = (uint8_t)((red << 4) | bw);
+
+    // While asleep the cached value goes out on wake
+    if (!weact_epaper_is_asleep(dev))
+    {
+        weact_epaper_send_command(dev, WEACT_EPAPER_CMD_DISPLAY_UPDATE_CONTROL_1);
+        weact_epaper_send_data_byte(dev, dev->update_control_1);
+        weact_epaper_send_data_byte(dev, 0x80);
+    }
+    weact_epaper_unlock(dev);
+}
+
+/**
+ * @brief Derive both RAM options from mode, page and inversion state
+ */
+static void weact_epaper_apply_ram_options(weact_epaper_t *dev)
+{
+    weact_epaper_ram_option_t shown = dev->inverted ? WEACT_EPAPER_RAM_INVERT : WEACT_EPAPER_RAM_NORMAL;
+    weact_epaper_ram_option_t bw = shown;
+    weact_epaper_ram_option_t red = WEACT_EPAPER_RAM_NORMAL;
+
+    if (dev->page == WEACT_EPAPER_PAGE_0)
+    {
+        red = WEACT_EPAPER_RAM_BYPASS_0;
+    }
+    else if (dev->page == WEACT_EPAPER_PAGE_1)
+    {
+        bw = WEACT_EPAPER_RAM_BYPASS_0;
+        red = shown;
+    }
+    else if (dev->mode == WEACT_EPAPER_MODE_GRAY4)
+    {
+        // Inverting both bit planes maps level n to 3 - n
+        red = shown;
+    }
+    // BWR: red stays red
+
+    weact_epaper_set_ram_options(dev, bw, red);
+}
+
+void weact_epaper_set_inverted(weact_epaper_t *dev, bool inverted)
+{
+    dev->inverted = inverted;
+    weact_epaper_apply_ram_options(dev);
+
+    ESP_LOGI(TAG, "Display %s", inverted ? "inverted" : "normal");
+}
+
+void weact_epaper_set_orientation(weact_epaper_t *dev, uint8_t data_entry_mode, uint8_t gate_scan)
+{
+    if (weact_epaper_is_busy(dev))
+    {
+        weact_epaper_wait_until_idle(dev);
+    }
+
+    weact_epaper_lock(dev);
+    dev->data_entry_mode = data_entry_mode;
+    dev->gate_scan = gate_scan;
+
+    // While asleep the cached values go out on wake
+    if (!weact_epaper_is_asleep(dev))
+    {
+        weact_epaper_send_orientation(dev);
+    }
+    weact_epaper_unlock(dev);
+}
+
+// =============================================================================
+// TWO-PAGE MODE
+// =============================================================================
+
+bool weact_epaper_page_load(weact_epaper_t *dev, weact_epaper_page_t page, const uint8_t *image)
+{
+    if (dev->mode != WEACT_EPAPER_MODE_BW)
+    {
+        ESP_LOGE(TAG, "Pages need black/white mode (RED RAM is in use)");
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Loading page %d", (int)page);
+
+    if (weact_epaper_is_busy(dev))
+    {
+        weact_epaper_wait_until_idle(dev);
+    }
+
+    weact_epaper_lock_awake(dev);
+    int64_t start_us = weact_epaper_now_us(dev);
+    weact_epaper_write_ram(dev, page == WEACT_EPAPER_PAGE_0 ? WEACT_EPAPER_CMD_WRITE_RAM_BW : WEACT_EPAPER_CMD_WRITE_RAM_RED,
+                           image);
+    dev->pages_loaded |= (uint8_t)(1 << page);
+    dev->diff_base_valid = false;
+    weact_epaper_stats_uploaded(dev, start_us);
+    weact_epaper_unlock(dev);
+
+    return true;
+}
+
+bool weact_epaper_page_show(weact_epaper_t *dev, weact_epaper_page_t page)
+{
+    if (dev->mode != WEACT_EPAPER_MODE_BW)
+    {
+        ESP_LOGE(TAG, "Pages need black/white mode (RED RAM is in use)");
+        return false;
+    }
+
+    if (weact_epaper_is_busy(dev))
+    {
+        weact_epaper_wait_until_idle(dev);
+    }
+
+    // Wakes first: leaving deep sleep 2 is what loses the pages
+    weact_epaper_lock_awake(dev);
+    if (!(dev->pages_loaded & (1 << page)))
+    {
+        weact_epaper_unlock(dev);
+        ESP_LOGE(TAG, "Page %d is not in RAM (replaced or lost in deep sleep 2), load it again", (int)page);
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Showing page %d", (int)page);
+
+    dev->page = (int8_t)page;
+    weact_epaper_apply_ram_options(dev);
+    weact_epaper_unlock(dev);
+    weact_epaper_refresh(dev);
+
+    return true;
+}
+
+// =============================================================================
+// DIFFERENTIAL REFRESH
+// =============================================================================
+
+/**
+ * @brief Write RAM rows row0..row1 only (Y window narrowed for the write)
+ */
+static void weact_epaper_write_rows(weact_epaper_t *dev, uint8_t ram_cmd, const uint8_t *data, int row0, int row1)
+{
+    const uint8_t window[4] = {(uint8_t)row0, (uint8_t)(row0 >> 8), (uint8_t)row1, (uint8_t)(row1 >> 8)};
+    const uint8_t full[4] = {0x00, 0x00, (WEACT_EPAPER_HEIGHT - 1) & 0xFF, (WEACT_EPAPER_HEIGHT - 1) >> 8};
+    const uint8_t x0 = 0x00;
+    weact_epaper_batch_t batch = {.count = 0};
+
+    weact_epaper_batch_command(dev, &batch, WEACT_EPAPER_CMD_SET_RAM_Y_ADDRESS_START_END, window, 4);
+    weact_epaper_batch_command(dev, &batch, WEACT_EPAPER_CMD_SET_RAM_X_ADDRESS_COUNTER, &x0, 1);
+    weact_epaper_batch_command(dev, &batch, WEACT_EPAPER_CMD_SET_RAM_Y_ADDRESS_COUNTER, window, 2);
+    weact_epaper_batch_command(dev, &batch, ram_cmd, data + (size_t)row0 * WEACT_EPAPER_WIDTH_BYTES,
+                               (size_t)(row1 - row0 + 1) * WEACT_EPAPER_WIDTH_BYTES);
+    weact_epaper_batch_command(dev, &batch, WEACT_EPAPER_CMD_SET_RAM_Y_ADDRESS_START_END, full, 4);
+    weact_epaper_batch_run(dev, &batch);
+    dev->pages_loaded &= (uint8_t)~weact_epaper_page_bit(ram_cmd);
+}
+
+bool weact_epaper_diff_rows(const uint8_t *image, const uint8_t *previous, int *row0, int *row1)
+{
+    *row0 = -1;
+    *row1 = -1;
+    for (int row = 0; row < WEACT_EPAPER_HEIGHT; row++)
+    {
+        size_t off = (size_t)row * WEACT_EPAPER_WIDTH_BYTES;
+        if (memcmp(image + off, previous + off, WEACT_EPAPER_WIDTH_BYTES) != 0)
+        {
+            if (*row0 < 0)
+                *row0 = row;
+            *row1 = row;
+        }
+    }
 
-    // Also clear RED RAM (even if display doesn't support red)
-    // This prevents any residual data
-    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_SET_RAM_X_ADDRESS_COUNTER);
-    weact_epaper_send_data_byte(dev, 0x00);
-    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_SET_RAM_Y_ADDRESS_COUNTER);
-    weact_epaper_send_data_byte(dev, 0x00);
-    weact_epaper_send_data_byte(dev, 0x00);
+    return *row0 >= 0;
+}
 
-    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_WRITE_RAM_RED);
-    weact_epaper_send_data(dev, dev->framebuffer, WEACT_EPAPER_BUFFER_SIZE);
+uint32_t weact_epaper_hash(const uint8_t *data, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+    {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
 
-    // Trigger display update
-    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_DISPLAY_UPDATE_CONTROL_2);
-    weact_epaper_send_data_byte(dev, 0xF7);
+bool weact_epaper_display_diff(weact_epaper_t *dev, const uint8_t *previous)
+{
+    if (dev->mode != WEACT_EPAPER_MODE_BW)
+    {
+        weact_epaper_display_frame(dev);
+        return true;
+    }
+
+    // First and last RAM row that changed
+    int row0;
+    int row1;
+    if (!weact_epaper_diff_rows(dev->framebuffer, previous, &row0, &row1))
+    {
+        ESP_LOGI(TAG, "Frame unchanged, no refresh");
+        return false;
+    }
+
+    if (weact_epaper_is_busy(dev))
+    {
+        weact_epaper_wait_until_idle(dev);
+    }
+
+    weact_epaper_lock_awake(dev);
+    int64_t start_us = weact_epaper_now_us(dev);
+
+    if (dev->page >= 0)
+    {
+        dev->page = -1;
+        weact_epaper_apply_ram_options(dev);
+    }
+
+    // Mode 2 drives only pixels that differ between BW RAM (new) and
+    // RED RAM (old). If the banks do not hold the old image, write it first.
+    if (dev->diff_base_valid)
+    {
+        weact_epaper_write_rows(dev, WEACT_EPAPER_CMD_WRITE_RAM_BW, dev->framebuffer, row0, row1);
+    }
+    else
+    {
+        weact_epaper_write_planes(dev, dev->framebuffer, previous);
+    }
+    dev->ram_valid = true;
+    weact_epaper_stats_uploaded(dev, start_us);
+    start_us = weact_epaper_now_us(dev);
+
+    // Clock/analog on, temperature + mode 2 LUT, display mode 2, power down
+    uint8_t sequence = weact_epaper_temperature_fresh(dev) ? 0xDF : 0xFF;
 
+    weact_epaper_power_timer_stop(dev);
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_DISPLAY_UPDATE_CONTROL_2);
+    weact_epaper_send_data_byte(dev, sequence);
     weact_epaper_send_command(dev, WEACT_EPAPER_CMD_MASTER_ACTIVATION);
+    weact_epaper_stats_activated(dev, start_us);
+    weact_epaper_note_sequence(dev, sequence);
+
+    weact_epaper_unlock(dev);
 
     weact_epaper_wait_until_idle(dev);
 
-    ESP_LOGI(TAG, "Screen cleared successfully");
+    // The new image becomes the old one for the next differential refresh.
+    // RED RAM holds the previous image either way, which differs only in
+    // rows row0..row1
+    weact_epaper_lock(dev);
+    weact_epaper_write_rows(dev, WEACT_EPAPER_CMD_WRITE_RAM_RED, dev->framebuffer, row0, row1);
+    dev->diff_base_valid = true;
+    weact_epaper_unlock(dev);
+
+    ESP_LOGI(TAG, "Differential refresh, rows %d-%d", row0, row1);
+    return true;
 }
 
-void weact_epaper_display_frame(weact_epaper_t *dev)
+void weact_epaper_restore(weact_epaper_t *dev, const uint8_t *image, bool panel_ram_valid)
 {
-    ESP_LOGI(TAG, "Uploading framebuffer to display");
+    memcpy(dev->framebuffer, image, WEACT_EPAPER_BUFFER_SIZE);
+    dev->diff_base_valid = panel_ram_valid && dev->mode == WEACT_EPAPER_MODE_BW;
+}
 
-    // Set RAM X address counter
-    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_SET_RAM_X_ADDRESS_COUNTER);
-    weact_epaper_send_data_byte(dev, 0x00);
+// =============================================================================
+// TEMPERATURE
+// =============================================================================
 
-    // Set RAM Y address counter
-    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_SET_RAM_Y_ADDRESS_COUNTER);
-    weact_epaper_send_data_byte(dev, 0x00); // Y LOW
-    weact_epaper_send_data_byte(dev, 0x00); // Y HIGH
+// Temperature register: 12-bit two's complement, 1/16 °C per LSB, sent and
+// read as A[11:4], A[3:0] << 4
 
-    // Write to Black/White RAM
-    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_WRITE_RAM_BW);
-    weact_epaper_send_data(dev, dev->framebuffer, WEACT_EPAPER_BUFFER_SIZE);
+static bool weact_epaper_temperature_fresh(weact_epaper_t *dev)
+{
+    if (!dev->temperature_valid)
+    {
+        return false;
+    }
 
-    // Display Update Control 2
-    // 0xF7 = Full refresh with display mode 1
-    // 0xC7 = Partial refresh (faster but may ghost)
-    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_DISPLAY_UPDATE_CONTROL_2);
-    weact_epaper_send_data_byte(dev, 0xF7); // Use 0xC7 for partial refresh
+    return dev->temperature_ttl_ms == 0 ||
+           weact_epaper_now_us(dev) - dev->temperature_at_us < (int64_t)dev->temperature_ttl_ms * 1000;
+}
 
-    // Master Activation (start the refresh)
+static void weact_epaper_cache_temperature(weact_epaper_t *dev, int16_t x16, uint32_t ttl_ms)
+{
+    // A different temperature may select a different OTP waveform
+    if (!dev->temperature_valid || dev->temperature_x16 != x16)
+    {
+        dev->otp_lut_loaded = false;
+    }
+
+    dev->temperature_x16 = x16;
+    dev->temperature_at_us = weact_epaper_now_us(dev);
+    dev->temperature_ttl_ms = ttl_ms;
+    dev->temperature_valid = true;
+}
+
+void weact_epaper_set_temperature(weact_epaper_t *dev, float celsius, uint32_t ttl_ms)
+{
+    if (celsius < -128.0f)
+        celsius = -128.0f;
+    if (celsius > 127.0f)
+        celsius = 127.0f;
+
+    int16_t x16 = (int16_t)(celsius * 16.0f + (celsius < 0 ? -0.5f : 0.5f));
+    uint8_t value[2] = {(uint8_t)((uint16_t)x16 >> 4), (uint8_t)(x16 << 4)};
+
+    if (weact_epaper_is_busy(dev))
+    {
+        weact_epaper_wait_until_idle(dev);
+    }
+
+    // While asleep the cached value goes out on wake
+    weact_epaper_lock(dev);
+    if (!weact_epaper_is_asleep(dev))
+    {
+        weact_epaper_send_command(dev, WEACT_EPAPER_CMD_TEMP_SENSOR_WRITE);
+        weact_epaper_send_data(dev, value, sizeof(value));
+    }
+    weact_epaper_cache_temperature(dev, x16, ttl_ms);
+    weact_epaper_unlock(dev);
+
+    ESP_LOGI(TAG, "External temperature %.1f C (valid %lu ms)", (double)(x16 / 16.0f), (unsigned long)ttl_ms);
+}
+
+bool weact_epaper_read_temperature(weact_epaper_t *dev, float *celsius, uint32_t ttl_ms)
+{
+    uint8_t value[2] = {0xFF, 0xFF};
+
+    if (weact_epaper_is_busy(dev))
+    {
+        weact_epaper_wait_until_idle(dev);
+    }
+
+    weact_epaper_lock_awake(dev);
+
+    // Clock on, load temperature from the internal sensor, clock off
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_DISPLAY_UPDATE_CONTROL_2);
+    weact_epaper_send_data_byte(dev, 0xA1);
     weact_epaper_send_command(dev, WEACT_EPAPER_CMD_MASTER_ACTIVATION);
 
-    // Wait for refresh to complete
     weact_epaper_wait_until_idle(dev);
 
-    ESP_LOGI(TAG, "Display update complete!");
+    weact_epaper_read_register(dev, WEACT_EPAPER_CMD_TEMP_SENSOR_READ, value, sizeof(value));
+
+    // Sign-extend the 12-bit value
+    int16_t x16 = (int16_t)(((uint16_t)value[0] << 8) | value[1]) >> 4;
+
+    // All ones means nothing answered on SDA
+    if (value[0] == 0xFF && value[1] == 0xFF)
+    {
+        weact_epaper_unlock(dev);
+        ESP_LOGE(TAG, "Temperature readback failed");
+        return false;
+    }
+
+    weact_epaper_cache_temperature(dev, x16, ttl_ms);
+    weact_epaper_unlock(dev);
+
+    if (celsius != NULL)
+    {
+        *celsius = x16 / 16.0f;
+    }
+
+    ESP_LOGI(TAG, "Panel temperature %.1f C", (double)(x16 / 16.0f));
+    return true;
 }
 
-void weact_epaper_sleep(weact_epaper_t *dev)
+bool weact_epaper_get_temperature(weact_epaper_t *dev, float *celsius)
+{
+    if (!weact_epaper_temperature_fresh(dev))
+    {
+        return false;
+    }
+
+    *celsius = dev->temperature_x16 / 16.0f;
+    return true;
+}
+
+// =============================================================================
+// REFRESH PROFILES
+// =============================================================================
+
+/**
+ * @brief Switch the analog circuits and the oscillator off
+ *
+ * Short update with only the power-down steps (0x03); the LUT register and
+ * RAM are kept.
+ */
+static void weact_epaper_power_off(weact_epaper_t *dev)
+{
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_DISPLAY_UPDATE_CONTROL_2);
+    weact_epaper_send_data_byte(dev, 0x03);
+    weact_epaper_send_command(dev, WEACT_EPAPER_CMD_MASTER_ACTIVATION);
+    weact_epaper_note_sequence(dev, 0x03);
+
+    if (dev->power_state == WEACT_EPAPER_POWER_ANALOG_ON)
+    {
+        weact_epaper_set_power_state(dev, WEACT_EPAPER_POWER_IDLE);
+    }
+}
+
+static void weact_epaper_power_timer_cb(void *arg)
+{
+    weact_epaper_t *dev = (weact_epaper_t *)arg;
+
+    // Never block the esp_timer task; if the caller is mid-sequence, retry later
+    if (xSemaphoreTakeRecursive(dev->lock, 0) != pdTRUE)
+    {
+        weact_epaper_power_timer_start(dev);
+        return;
+    }
+
+    if (dev->analog_on && !dev->activation_pending && weact_epaper_busy_level(dev) == 0)
+    {
+        ESP_LOGI(TAG, "Idle, analog off");
+        weact_epaper_power_off(dev);
+    }
+
+    weact_epaper_unlock(dev);
+}
+
+static void weact_epaper_power_timer_start(weact_epaper_t *dev)
+{
+    if (dev->power_timer == NULL || dev->idle_power_off_ms == 0)
+    {
+        return;
+    }
+
+    esp_timer_stop(dev->power_timer);
+    esp_timer_start_once(dev->power_timer, (uint64_t)dev->idle_power_off_ms * 1000);
+}
+
+static void weact_epaper_power_timer_stop(weact_epaper_t *dev)
+{
+    if (dev->power_timer != NULL)
+    {
+        esp_timer_stop(dev->power_timer);
+    }
+}
+
+bool weact_epaper_set_refresh_profile(weact_epaper_t *dev, weact_epaper_refresh_profile_t profile,
+                                      uint32_t idle_power_off_ms, uint32_t lut_reload_ms)
+{
+    if (profile == WEACT_EPAPER_PROFILE_BURST && dev->power_timer == NULL)
+    {
+        const esp_timer_create_args_t timer_args = {
+            .callback = weact_epaper_power_timer_cb,
+            .arg = dev,
+            .name = "epaper_idle_off",
+        };
+
+        if (esp_timer_create(&timer_args, &dev->power_timer) != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Failed to create idle power-off timer");
+            return false;
+        }
+    }
+
+    if (weact_epaper_is_busy(dev))
+    {
+        weact_epaper_wait_until_idle(dev);
+    }
+
+    weact_epaper_lock(dev);
+
+    dev->profile = profile;
+    dev->idle_power_off_ms = idle_power_off_ms;
+    dev->lut_reload_ms = lut_reload_ms;
+
+    // Standard refreshes power down by themselves; do it now when leaving a burst
+    if (profile == WEACT_EPAPER_PROFILE_STANDARD && dev->analog_on)
+    {
+        weact_epaper_power_timer_stop(dev);
+        weact_epaper_power_off(dev);
+    }
+
+    weact_epaper_unlock(dev);
+
+    ESP_LOGI(TAG, "Refresh profile: %s (idle off %lu ms, LUT reload %lu ms)",
+             profile == WEACT_EPAPER_PROFILE_BURST ? "burst" : "standard",
+             (unsigned long)idle_power_off_ms, (unsigned long)lut_reload_ms);
+
+    return true;
+}
+
+// =============================================================================
+// POWER STATES
+// =============================================================================
+
+/**
+ * @brief Send DEEP_SLEEP_MODE (lock held, controller idle)
+ */
+static void weact_epaper_enter_sleep_locked(weact_epaper_t *dev, weact_epaper_power_state_t state)
 {
-    ESP_LOGI(TAG, "Entering deep sleep mode");
+    weact_epaper_power_timer_stop(dev);
+    if (dev->sleep_timer != NULL)
+    {
+        esp_timer_stop(dev->sleep_timer);
+    }
 
     // Deep sleep mode
     // 0x01 = Deep sleep mode 1 (RAM preserved)
     // 0x03 = Deep sleep mode 2 (RAM not preserved, lower power)
     weact_epaper_send_command(dev, WEACT_EPAPER_CMD_DEEP_SLEEP_MODE);
-    weact_epaper_send_data_byte(dev, 0x01);
+    weact_epaper_send_data_byte(dev, state == WEACT_EPAPER_POWER_DEEP_SLEEP_2 ? 0x03 : 0x01);
+
+    // Waking needs a hardware reset, which clears the LUT register
+    dev->analog_on = false;
+    dev->otp_lut_loaded = false;
+    dev->loaded_lut = NULL;
+    weact_epaper_set_power_state(dev, state);
+}
+
+/**
+ * @brief Leave deep sleep (lock held)
+ *
+ * Short reset pulse, then only the configuration registers from the cached
+ * state; no SW reset and no RAM upload. The LUT is reloaded by the next
+ * refresh. After deep sleep 2 the RAM is rewritten by the next refresh too.
+ */
+static void weact_epaper_wake_locked(weact_epaper_t *dev)
+{
+    if (!weact_epaper_is_asleep(dev))
+    {
+        return;
+    }
+
+    int64_t start = weact_epaper_now_us(dev);
+    bool ram_lost = dev->power_state == WEACT_EPAPER_POWER_DEEP_SLEEP_2;
+
+    weact_epaper_set_rst(dev, 0);
+    weact_epaper_delay_us(dev, 200);
+    weact_epaper_set_rst(dev, 1);
+    weact_epaper_delay_us(dev, 200);
+
+    weact_epaper_set_power_state(dev, WEACT_EPAPER_POWER_IDLE);
+    for (int i = 0; i < 50 && weact_epaper_busy_level(dev) == 1; i++)
+    {
+        weact_epaper_delay_ms(dev, 1);
+    }
+
+    weact_epaper_send_config(dev);
+
+    if (ram_lost)
+    {
+        dev->ram_valid = false;
+        dev->diff_base_valid = false;
+        dev->page = -1;
+        dev->pages_loaded = 0;
+    }
 
-    vTaskDelay(pdMS_TO_TICKS(100));
+    ESP_LOGI(TAG, "Woke from deep sleep %d in %lld us", ram_lost ? 2 : 1,
+             (long long)(weact_epaper_now_us(dev) - start));
+}
+
+static void weact_epaper_sleep_timer_cb(void *arg)
+{
+    weact_epaper_t *dev = (weact_epaper_t *)arg;
+
+    // Never block the esp_timer task; if the caller is mid-sequence, retry later
+    if (xSemaphoreTakeRecursive(dev->lock, 0) != pdTRUE)
+    {
+        weact_epaper_sleep_timer_start(dev);
+        return;
+    }
+
+    if (weact_epaper_is_asleep(dev))
+    {
+        // Nothing to do
+    }
+    else if (dev->activation_pending || weact_epaper_busy_level(dev) == 1)
+    {
+        weact_epaper_sleep_timer_start(dev);
+    }
+    else
+    {
+        ESP_LOGI(TAG, "Idle, auto sleep");
+        weact_epaper_enter_sleep_locked(dev, dev->auto_sleep_state);
+    }
+
+    weact_epaper_unlock(dev);
+}
+
+static void weact_epaper_sleep_timer_start(weact_epaper_t *dev)
+{
+    if (dev->sleep_timer == NULL || dev->auto_sleep_ms == 0)
+    {
+        return;
+    }
+
+    esp_timer_stop(dev->sleep_timer);
+    esp_timer_start_once(dev->sleep_timer, (uint64_t)dev->auto_sleep_ms * 1000);
+}
+
+void weact_epaper_enter_sleep(weact_epaper_t *dev, weact_epaper_power_state_t state)
+{
+    if (state != WEACT_EPAPER_POWER_DEEP_SLEEP_2)
+    {
+        state = WEACT_EPAPER_POWER_DEEP_SLEEP_1;
+    }
+
+    ESP_LOGI(TAG, "Entering deep sleep mode %d", state == WEACT_EPAPER_POWER_DEEP_SLEEP_2 ? 2 : 1);
+
+    if (weact_epaper_is_busy(dev))
+    {
+        weact_epaper_wait_until_idle(dev);
+    }
+
+    weact_epaper_lock(dev);
+    if (dev->power_state != state)
+    {
+        // Deep sleep 1 -> 2 needs a wake in between
+        weact_epaper_wake_locked(dev);
+        weact_epaper_enter_sleep_locked(dev, state);
+    }
+    weact_epaper_unlock(dev);
+}
+
+void weact_epaper_sleep(weact_epaper_t *dev)
+{
+    weact_epaper_enter_sleep(dev, WEACT_EPAPER_POWER_DEEP_SLEEP_1);
+
+    weact_epaper_delay_ms(dev, 100);
+}
+
+void weact_epaper_wake(weact_epaper_t *dev)
+{
+    weact_epaper_lock_awake(dev);
+    weact_epaper_unlock(dev);
+}
+
+bool weact_epaper_set_auto_sleep(weact_epaper_t *dev, uint32_t idle_ms, weact_epaper_power_state_t state)
+{
+    if (dev->sleep_timer == NULL && idle_ms > 0)
+    {
+        const esp_timer_create_args_t timer_args = {
+            .callback = weact_epaper_sleep_timer_cb,
+            .arg = dev,
+            .name = "epaper_auto_sleep",
+        };
+
+        if (esp_timer_create(&timer_args, &dev->sleep_timer) != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Failed to create auto-sleep timer");
+            return false;
+        }
+    }
+
+    weact_epaper_lock(dev);
+    dev->auto_sleep_ms = idle_ms;
+    dev->auto_sleep_state = state == WEACT_EPAPER_POWER_DEEP_SLEEP_2 ? WEACT_EPAPER_POWER_DEEP_SLEEP_2
+                                                                     : WEACT_EPAPER_POWER_DEEP_SLEEP_1;
+    if (idle_ms == 0)
+    {
+        if (dev->sleep_timer != NULL)
+        {
+            esp_timer_stop(dev->sleep_timer);
+        }
+    }
+    else if (!weact_epaper_is_asleep(dev))
+    {
+        weact_epaper_sleep_timer_start(dev);
+    }
+    weact_epaper_unlock(dev);
+
+    ESP_LOGI(TAG, "Auto sleep: %lu ms -> deep sleep %d", (unsigned long)idle_ms,
+             dev->auto_sleep_state == WEACT_EPAPER_POWER_DEEP_SLEEP_2 ? 2 : 1);
+
+    return true;
+}
+
+weact_epaper_power_state_t weact_epaper_get_power_state(weact_epaper_t *dev)
+{
+    return dev->power_state;
 }
@@ -0,0 +1,196 @@
+/**
+ * @file weact_epaper_multi.c
+ * @brief Overlapped, staggered refresh of several SSD1680 panels
+ */
+
+#include "weact_epaper_multi.h"
+#include "weact_epaper_private.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+
+static const char *TAG = "weact_epaper_multi";
+
+// Low BUSY right after activation does not mean done yet
+#define WEACT_EPAPER_MULTI_BUSY_RISE_US 1000
+
+// BUSY edges of all panels wake the task waiting in weact_epaper_multi_refresh()
+static void IRAM_ATTR weact_epaper_multi_busy_isr(void *arg)
+{
+    BaseType_t woken = pdFALSE;
+
+    vTaskNotifyGiveFromISR((TaskHandle_t)arg, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief Convert a time stamp of a panel's transport clock to esp_timer time
+ */
+static int64_t weact_epaper_multi_esp_time(weact_epaper_t *dev, int64_t transport_us)
+{
+    weact_epaper_transport_t *t = dev->transport;
+    return transport_us + (esp_timer_get_time() - t->now_us(t));
+}
+
+bool weact_epaper_multi_refresh(weact_epaper_t *const *panels, size_t count, uint32_t stagger_us,
+                                weact_epaper_multi_result_t *results,
+                                weact_epaper_multi_done_cb_t done_cb, void *arg)
+{
+    if (count == 0)
+    {
+        return true;
+    }
+
+    weact_epaper_multi_result_t *res = results;
+    if (res == NULL)
+    {
+        res = heap_caps_calloc(count, sizeof(*res), MALLOC_CAP_8BIT);
+        if (res == NULL)
+        {
+            ESP_LOGE(TAG, "Failed to allocate results");
+            return false;
+        }
+    }
+    memset(res, 0, count * sizeof(*res));
+
+    // Results and deadlines are esp_timer time, the base
+    // weact_epaper_schedule_activation() arms its timer in
+    int64_t start = esp_timer_get_time();
+    int64_t next_at = 0;
+
+    // Completion is reported on BUSY edges when every panel's transport has
+    // an interrupt for it, by polling otherwise
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    size_t irq_count = 0;
+    if (task != NULL)
+    {
+        while (irq_count < count)
+        {
+            weact_epaper_transport_t *t = panels[irq_count]->transport;
+            if (t->set_busy_callback == NULL ||
+                t->set_busy_callback(t, weact_epaper_multi_busy_isr, task) != ESP_OK)
+            {
+                break;
+            }
+            irq_count++;
+        }
+    }
+    bool irq = irq_count == count;
+    if (!irq)
+    {
+        ESP_LOGD(TAG, "No BUSY interrupt on every panel, polling");
+    }
+
+    // Pipeline: upload panel i while panels 0..i-1 are already refreshing
+    for (size_t i = 0; i < count; i++)
+    {
+        weact_epaper_upload(panels[i]);
+        res[i].uploaded_at_us = esp_timer_get_time();
+
+        // A deadline already reached (always so for the first panel) needs no timer
+        int64_t at = next_at;
+        if (at <= res[i].uploaded_at_us)
+        {
+            at = res[i].uploaded_at_us;
+            weact_epaper_activate(panels[i]);
+        }
+        else if (!weact_epaper_schedule_activation(panels[i], at))
+        {
+            at = esp_timer_get_time();
+            weact_epaper_activate(panels[i]);
+        }
+
+        // The next boost converter starts no earlier than stagger_us later
+        next_at = at + stagger_us;
+    }
+
+    // Report each panel as soon as it is done
+    size_t pending = count;
+    bool ok = true;
+
+    while (pending > 0)
+    {
+        // Latest time to look again without an edge (rise window or timeout)
+        int64_t wake_at = INT64_MAX;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (res[i].done_at_us != 0)
+            {
+                continue;
+            }
+
+            int64_t now = esp_timer_get_time();
+            bool busy = weact_epaper_is_busy(panels[i]);
+            int64_t activated_at = weact_epaper_multi_esp_time(panels[i], panels[i]->activated_at_us);
+
+            if (busy && now - res[i].uploaded_at_us < WEACT_EPAPER_BUSY_TIMEOUT_US)
+            {
+                int64_t timeout_at = res[i].uploaded_at_us + WEACT_EPAPER_BUSY_TIMEOUT_US;
+                wake_at = timeout_at < wake_at ? timeout_at : wake_at;
+                continue;
+            }
+
+            // BUSY rises shortly after MASTER_ACTIVATION, not at once
+            if (!busy && now - activated_at < WEACT_EPAPER_MULTI_BUSY_RISE_US)
+            {
+                int64_t rise_at = activated_at + WEACT_EPAPER_MULTI_BUSY_RISE_US;
+                wake_at = rise_at < wake_at ? rise_at : wake_at;
+                continue;
+            }
+
+            res[i].activated_at_us = activated_at;
+            res[i].done_at_us = now;
+            res[i].timed_out = busy;
+            ok &= !busy;
+            pending--;
+
+            if (busy)
+            {
+                ESP_LOGW(TAG, "Panel %u: busy timeout", (unsigned)i);
+            }
+            if (done_cb != NULL)
+            {
+                done_cb(panels[i], i, &res[i], arg);
+            }
+        }
+
+        if (pending == 0)
+        {
+            break;
+        }
+
+        if (irq)
+        {
+            // Sleeps until a panel's BUSY falls; edges in between are counted
+            int64_t wait_us = wake_at - esp_timer_get_time();
+            TickType_t ticks = wait_us > 0 ? pdMS_TO_TICKS((wait_us + 999) / 1000) : 0;
+            ulTaskNotifyTake(pdTRUE, ticks > 0 ? ticks : 1);
+        }
+        else
+        {
+            weact_epaper_transport_t *t = panels[0]->transport;
+            t->delay_us(t, 1000);
+        }
+    }
+
+    for (size_t i = 0; i < irq_count; i++)
+    {
+        weact_epaper_transport_t *t = panels[i]->transport;
+        t->set_busy_callback(t, NULL, NULL);
+    }
+
+    ESP_LOGI(TAG, "%u panels refreshed in %lld ms", (unsigned)count,
+             (long long)((esp_timer_get_time() - start) / 1000));
+
+    if (results == NULL)
+    {
+        heap_caps_free(res);
+    }
+
+    return ok;
+}
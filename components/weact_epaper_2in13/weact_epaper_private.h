@@ -0,0 +1,60 @@
+#ifndef WEACT_EPAPER_PRIVATE_H
+#define WEACT_EPAPER_PRIVATE_H
+
+/**
+ * @brief Definitions shared by the driver sources, not part of the API
+ */
+
+#include "weact_epaper_2in13.h"
+
+// Longest wait for BUSY to fall. A full refresh takes about 2 s at room
+// temperature and several seconds when cold
+#define WEACT_EPAPER_BUSY_TIMEOUT_US (10000 * 1000)
+
+/**
+ * @brief Device state, transport and framebuffer (no panel traffic)
+ *
+ * First half of weact_epaper_init(). On failure everything set up so far
+ * is released again.
+ */
+bool weact_epaper_setup(weact_epaper_t *dev, const weact_epaper_config_t *config);
+
+/**
+ * @brief SW reset and the configuration registers from the cached state
+ *
+ * Second half of weact_epaper_init() after the hardware reset. Leaves the
+ * device IDLE, so it also follows a reset out of deep sleep.
+ */
+void weact_epaper_init_registers(weact_epaper_t *dev);
+
+/**
+ * @brief Set data entry mode and gate scan, kept across deep sleep
+ *
+ * The full-frame writes (upload, pages, differential refresh) assume the
+ * default 0x03 / 0x00; only weact_epaper_write_window() follows others.
+ *
+ * @param dev Device handle
+ * @param data_entry_mode DATA_ENTRY_MODE value (AM, ID[1:0])
+ * @param gate_scan Third DRIVER_OUTPUT_CONTROL byte (GD, SM, TB)
+ */
+void weact_epaper_set_orientation(weact_epaper_t *dev, uint8_t data_entry_mode, uint8_t gate_scan);
+
+/**
+ * @brief Write a RAM window, then restore the full window
+ *
+ * Waits for a running refresh first. Window bounds are in address counter
+ * order: with X decrement x_start is the higher byte address.
+ *
+ * @param dev Device handle
+ * @param ram_cmd WEACT_EPAPER_CMD_WRITE_RAM_BW or WEACT_EPAPER_CMD_WRITE_RAM_RED
+ * @param x_start First byte column (0..15)
+ * @param x_end Last byte column (0..15)
+ * @param y_start First row (0..249)
+ * @param y_end Last row (0..249)
+ * @param data Bytes in the order the address counter visits them
+ * @param len Number of bytes
+ */
+void weact_epaper_write_window(weact_epaper_t *dev, uint8_t ram_cmd, uint8_t x_start, uint8_t x_end,
+                               int y_start, int y_end, const uint8_t *data, size_t len);
+
+#endif // WEACT_EPAPER_PRIVATE_H
@@ -0,0 +1,798 @@
+/**
+ * @file weact_epaper_trace.c
+ * @brief Bus trace: recording transport, dump, load and replay
+ */
+
+#include "weact_epaper_trace.h"
+#include "weact_epaper_private.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "WEACT_EPAPER_TRACE";
+
+#define TRACE_RECORD_SIZE sizeof(weact_epaper_trace_record_t)
+#define TRACE_PAYLOAD_MAX UINT16_MAX
+
+struct weact_epaper_trace_t {
+    weact_epaper_transport_t base;  // Recording transport (first member)
+    weact_epaper_transport_t *inner; // NULL for a loaded trace
+    bool owns_inner;
+    size_t data_limit;
+    volatile bool enabled;
+    SemaphoreHandle_t lock;
+
+    // Ring of records; positions count bytes ever written
+    uint8_t *ring;
+    size_t ring_size;
+    uint64_t head;          // Next write position
+    uint64_t tail;          // Oldest record
+    size_t count;
+    uint32_t dropped;
+
+    int64_t start_us;
+    int dc;                 // Last DC level, -1 = none yet
+    int busy;               // Last BUSY level seen, -1 = none yet
+    volatile uint32_t busy_fell_at; // BUSY interrupt trace time + 1, not yet recorded (0 = none)
+    weact_epaper_busy_cb_t busy_cb;
+    void *busy_arg;
+};
+
+// =============================================================================
+// Ring buffer
+// =============================================================================
+
+static void ring_copy_in(weact_epaper_trace_t *tr, uint64_t pos, const void *src, size_t len)
+{
+    size_t off = (size_t)(pos % tr->ring_size);
+    size_t first = len < tr->ring_size - off ? len : tr->ring_size - off;
+
+    memcpy(tr->ring + off, src, first);
+    memcpy(tr->ring, (const uint8_t *)src + first, len - first);
+}
+
+static void ring_copy_out(const weact_epaper_trace_t *tr, uint64_t pos, void *dst, size_t len)
+{
+    size_t off = (size_t)(pos % tr->ring_size);
+    size_t first = len < tr->ring_size - off ? len : tr->ring_size - off;
+
+    memcpy(dst, tr->ring + off, first);
+    memcpy((uint8_t *)dst + first, tr->ring, len - first);
+}
+
+static void ring_drop_oldest(weact_epaper_trace_t *tr)
+{
+    weact_epaper_trace_record_t rec;
+
+    ring_copy_out(tr, tr->tail, &rec, TRACE_RECORD_SIZE);
+    tr->tail += TRACE_RECORD_SIZE + rec.stored;
+    tr->count--;
+    tr->dropped++;
+}
+
+// Caller holds the lock
+static void ring_put(weact_epaper_trace_t *tr, const weact_epaper_trace_record_t *rec, const uint8_t *payload)
+{
+    size_t size = TRACE_RECORD_SIZE + rec->stored;
+
+    if (size > tr->ring_size)
+    {
+        tr->dropped++;
+        return;
+    }
+    while (tr->head + size - tr->tail > tr->ring_size)
+    {
+        ring_drop_oldest(tr);
+    }
+
+    ring_copy_in(tr, tr->head, rec, TRACE_RECORD_SIZE);
+    if (rec->stored > 0)
+    {
+        ring_copy_in(tr, tr->head + TRACE_RECORD_SIZE, payload, rec->stored);
+    }
+    tr->head += size;
+    tr->count++;
+}
+
+// =============================================================================
+// Recording
+// =============================================================================
+
+static int64_t trace_now(weact_epaper_trace_t *tr)
+{
+    return tr->inner->now_us(tr->inner);
+}
+
+static void trace_put_rel(weact_epaper_trace_t *tr, uint32_t time_us, weact_epaper_trace_type_t type,
+                          uint8_t value, const uint8_t *payload, size_t len)
+{
+    weact_epaper_trace_record_t rec = {
+        .time_us = time_us,
+        .type = (uint8_t)type,
+        .value = value,
+    };
+
+    // Payloads longer than a record holds are split
+    do
+    {
+        size_t n = len > TRACE_PAYLOAD_MAX ? TRACE_PAYLOAD_MAX : len;
+        size_t keep = tr->data_limit > 0 && n > tr->data_limit ? tr->data_limit : n;
+
+        rec.len = (uint16_t)n;
+        rec.stored = (uint16_t)keep;
+        ring_put(tr, &rec, payload);
+        if (payload != NULL)
+        {
+            payload += n;
+        }
+        len -= n;
+    } while (len > 0);
+}
+
+static void trace_put(weact_epaper_trace_t *tr, int64_t at_us, weact_epaper_trace_type_t type, uint8_t value,
+                      const uint8_t *payload, size_t len)
+{
+    trace_put_rel(tr, (uint32_t)(at_us - tr->start_us), type, value, payload, len);
+}
+
+// BUSY interrupt edge first, so records stay in time order
+static void trace_flush_isr_edge(weact_epaper_trace_t *tr)
+{
+    uint32_t at = tr->busy_fell_at;
+
+    if (at != 0)
+    {
+        tr->busy_fell_at = 0;
+        if (tr->busy != 0)
+        {
+            trace_put_rel(tr, at - 1, WEACT_EPAPER_TRACE_BUSY, 0, NULL, 0);
+            tr->busy = 0;
+        }
+    }
+}
+
+static bool trace_begin(weact_epaper_trace_t *tr)
+{
+    if (!tr->enabled)
+    {
+        return false;
+    }
+    xSemaphoreTake(tr->lock, portMAX_DELAY);
+    trace_flush_isr_edge(tr);
+    return true;
+}
+
+static void trace_end(weact_epaper_trace_t *tr)
+{
+    xSemaphoreGive(tr->lock);
+}
+
+static void trace_dc(weact_epaper_trace_t *tr, int64_t at_us, int level)
+{
+    if (tr->dc != level)
+    {
+        trace_put(tr, at_us, WEACT_EPAPER_TRACE_DC, (uint8_t)level, NULL, 0);
+        tr->dc = level;
+    }
+}
+
+static void trace_transfer(weact_epaper_trace_t *tr, uint8_t dc, const uint8_t *data, size_t len)
+{
+    int64_t now = trace_now(tr);
+
+    trace_dc(tr, now, dc);
+    if (dc == 0)
+    {
+        for (size_t i = 0; i < len; i++)
+        {
+            trace_put(tr, now, WEACT_EPAPER_TRACE_COMMAND, data[i], NULL, 0);
+        }
+    }
+    else
+    {
+        trace_put(tr, now, WEACT_EPAPER_TRACE_DATA, 0, data, len);
+    }
+}
+
+static void trace_write_command(weact_epaper_transport_t *t, uint8_t cmd)
+{
+    weact_epaper_trace_t *tr = (weact_epaper_trace_t *)t;
+
+    if (trace_begin(tr))
+    {
+        trace_transfer(tr, 0, &cmd, 1);
+        trace_end(tr);
+    }
+    tr->inner->write_command(tr->inner, cmd);
+}
+
+static void trace_write_data(weact_epaper_transport_t *t, const uint8_t *data, size_t len)
+{
+    weact_epaper_trace_t *tr = (weact_epaper_trace_t *)t;
+
+    if (trace_begin(tr))
+    {
+        trace_transfer(tr, 1, data, len);
+        trace_end(tr);
+    }
+    tr->inner->write_data(tr->inner, data, len);
+}
+
+static void trace_write_batch(weact_epaper_transport_t *t, const weact_epaper_transfer_t *transfers, size_t count)
+{
+    weact_epaper_trace_t *tr = (weact_epaper_trace_t *)t;
+
+    // Recorded at queue time: the batch goes out back to back
+    if (trace_begin(tr))
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            trace_transfer(tr, transfers[i].dc, transfers[i].data, transfers[i].len);
+        }
+        trace_end(tr);
+    }
+    tr->inner->write_batch(tr->inner, transfers, count);
+}
+
+static void trace_read_register(weact_epaper_transport_t *t, uint8_t cmd, uint8_t *data, size_t len)
+{
+    weact_epaper_trace_t *tr = (weact_epaper_trace_t *)t;
+
+    tr->inner->read_register(tr->inner, cmd, data, len);
+
+    if (trace_begin(tr))
+    {
+        int64_t now = trace_now(tr);
+        trace_dc(tr, now, 0);
+        trace_put(tr, now, WEACT_EPAPER_TRACE_READ, cmd, data, len);
+        trace_end(tr);
+    }
+}
+
+static int trace_read_busy(weact_epaper_transport_t *t)
+{
+    weact_epaper_trace_t *tr = (weact_epaper_trace_t *)t;
+    int level = tr->inner->read_busy(tr->inner);
+
+    if (trace_begin(tr))
+    {
+        if (tr->busy != level)
+        {
+            trace_put(tr, trace_now(tr), WEACT_EPAPER_TRACE_BUSY, (uint8_t)level, NULL, 0);
+            tr->busy = level;
+        }
+        trace_end(tr);
+    }
+    return level;
+}
+
+static void trace_set_rst(weact_epaper_transport_t *t, int level)
+{
+    weact_epaper_trace_t *tr = (weact_epaper_trace_t *)t;
+
+    if (trace_begin(tr))
+    {
+        trace_put(tr, trace_now(tr), WEACT_EPAPER_TRACE_RST, (uint8_t)level, NULL, 0);
+        trace_end(tr);
+    }
+    tr->inner->set_rst(tr->inner, level);
+}
+
+static void trace_delay_us(weact_epaper_transport_t *t, uint32_t us)
+{
+    weact_epaper_trace_t *tr = (weact_epaper_trace_t *)t;
+    tr->inner->delay_us(tr->inner, us);
+}
+
+static int64_t trace_now_us(weact_epaper_transport_t *t)
+{
+    return trace_now((weact_epaper_trace_t *)t);
+}
+
+static void IRAM_ATTR trace_busy_isr(void *arg)
+{
+    weact_epaper_trace_t *tr = arg;
+
+    // No lock in interrupt context: the edge is recorded by the next call
+    uint32_t at = (uint32_t)(tr->inner->now_us(tr->inner) - tr->start_us) + 1;
+    tr->busy_fell_at = at != 0 ? at : 1;
+    if (tr->busy_cb != NULL)
+    {
+        tr->busy_cb(tr->busy_arg);
+    }
+}
+
+static esp_err_t trace_set_busy_callback(weact_epaper_transport_t *t, weact_epaper_busy_cb_t cb, void *arg)
+{
+    weact_epaper_trace_t *tr = (weact_epaper_trace_t *)t;
+
+    tr->busy_cb = cb;
+    tr->busy_arg = arg;
+    return tr->inner->set_busy_callback(tr->inner, cb != NULL ? trace_busy_isr : NULL, cb != NULL ? tr : NULL);
+}
+
+static void trace_del(weact_epaper_transport_t *t)
+{
+    weact_epaper_trace_delete((weact_epaper_trace_t *)t);
+}
+
+static weact_epaper_trace_t *trace_alloc(size_t ring_size)
+{
+    weact_epaper_trace_t *tr = heap_caps_calloc(1, sizeof(*tr), MALLOC_CAP_8BIT);
+    if (tr == NULL)
+    {
+        return NULL;
+    }
+
+    tr->ring = heap_caps_malloc(ring_size, MALLOC_CAP_8BIT);
+    tr->lock = xSemaphoreCreateMutex();
+    if (tr->ring == NULL || tr->lock == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to allocate %u byte trace", (unsigned)ring_size);
+        weact_epaper_trace_delete(tr);
+        return NULL;
+    }
+
+    tr->ring_size = ring_size;
+    tr->dc = -1;
+    tr->busy = -1;
+    return tr;
+}
+
+weact_epaper_trace_t *weact_epaper_trace_new(weact_epaper_transport_t *inner, size_t ring_size, size_t data_limit,
+                                             bool owns_inner)
+{
+    if (inner == NULL || ring_size < TRACE_RECORD_SIZE)
+    {
+        return NULL;
+    }
+
+    weact_epaper_trace_t *tr = trace_alloc(ring_size);
+    if (tr == NULL)
+    {
+        return NULL;
+    }
+
+    tr->inner = inner;
+    tr->owns_inner = owns_inner;
+    tr->data_limit = data_limit;
+    tr->start_us = inner->now_us(inner);
+    tr->enabled = true;
+
+    // Optional members stay optional, so the driver takes the same paths
+    tr->base.write_command = trace_write_command;
+    tr->base.write_data = trace_write_data;
+    tr->base.write_batch = inner->write_batch != NULL ? trace_write_batch : NULL;
+    tr->base.read_register = inner->read_register != NULL ? trace_read_register : NULL;
+    tr->base.read_busy = trace_read_busy;
+    tr->base.set_rst = trace_set_rst;
+    tr->base.delay_us = trace_delay_us;
+    tr->base.now_us = trace_now_us;
+    tr->base.set_busy_callback = inner->set_busy_callback != NULL ? trace_set_busy_callback : NULL;
+    tr->base.del = trace_del;
+    tr->base.max_write = inner->max_write;
+
+    ESP_LOGI(TAG, "Tracing into %u bytes", (unsigned)ring_size);
+    return tr;
+}
+
+weact_epaper_transport_t *weact_epaper_trace_transport(weact_epaper_trace_t *trace)
+{
+    return &trace->base;
+}
+
+void weact_epaper_trace_delete(weact_epaper_trace_t *trace)
+{
+    if (trace == NULL)
+    {
+        return;
+    }
+
+    if (trace->owns_inner && trace->inner != NULL)
+    {
+        trace->inner->del(trace->inner);
+    }
+    if (trace->lock != NULL)
+    {
+        vSemaphoreDelete(trace->lock);
+    }
+    heap_caps_free(trace->ring);
+    heap_caps_free(trace);
+}
+
+void weact_epaper_trace_set_enabled(weact_epaper_trace_t *trace, bool enabled)
+{
+    trace->enabled = enabled;
+}
+
+void weact_epaper_trace_clear(weact_epaper_trace_t *trace)
+{
+    xSemaphoreTake(trace->lock, portMAX_DELAY);
+    trace->head = 0;
+    trace->tail = 0;
+    trace->count = 0;
+    trace->dropped = 0;
+    trace->dc = -1;
+    trace->busy = -1;
+    trace->busy_fell_at = 0;
+    if (trace->inner != NULL)
+    {
+        trace->start_us = trace_now(trace);
+    }
+    xSemaphoreGive(trace->lock);
+}
+
+void weact_epaper_trace_mark(weact_epaper_trace_t *trace, uint8_t value)
+{
+    if (trace->inner != NULL && trace_begin(trace))
+    {
+        trace_put(trace, trace_now(trace), WEACT_EPAPER_TRACE_MARK, value, NULL, 0);
+        trace_end(trace);
+    }
+}
+
+size_t weact_epaper_trace_count(weact_epaper_trace_t *trace, uint32_t *dropped)
+{
+    xSemaphoreTake(trace->lock, portMAX_DELAY);
+    size_t count = trace->count;
+    if (dropped != NULL)
+    {
+        *dropped = trace->dropped;
+    }
+    xSemaphoreGive(trace->lock);
+    return count;
+}
+
+bool weact_epaper_trace_next(weact_epaper_trace_t *trace, uint64_t *cursor, weact_epaper_trace_record_t *record,
+                             uint8_t *payload, size_t payload_size)
+{
+    bool ok = false;
+
+    xSemaphoreTake(trace->lock, portMAX_DELAY);
+    if (*cursor < trace->tail)
+    {
+        *cursor = trace->tail;
+    }
+    if (*cursor < trace->head)
+    {
+        ring_copy_out(trace, *cursor, record, TRACE_RECORD_SIZE);
+        if (payload != NULL)
+        {
+            size_t n = record->stored < payload_size ? record->stored : payload_size;
+            ring_copy_out(trace, *cursor + TRACE_RECORD_SIZE, payload, n);
+        }
+        *cursor += TRACE_RECORD_SIZE + record->stored;
+        ok = true;
+    }
+    xSemaphoreGive(trace->lock);
+
+    return ok;
+}
+
+// =============================================================================
+// Dump and load
+// =============================================================================
+
+static const char *const trace_type_names[] = {"cmd", "data", "read", "dc", "busy", "rst", "mark"};
+
+static void dump_csv(weact_epaper_trace_t *trace, weact_epaper_trace_write_fn_t write, void *ctx)
+{
+    static const char hex[] = "0123456789abcdef";
+    uint8_t payload[64];
+    char line[48 + 2 * sizeof(payload)];
+    weact_epaper_trace_record_t rec;
+    uint64_t cursor = 0;
+
+    write(ctx, "time_us,type,value,len,data\n", 28);
+
+    while (weact_epaper_trace_next(trace, &cursor, &rec, NULL, 0))
+    {
+        uint64_t at = cursor - TRACE_RECORD_SIZE - rec.stored;
+        const char *type = rec.type < sizeof(trace_type_names) / sizeof(trace_type_names[0])
+                               ? trace_type_names[rec.type]
+                               : "?";
+        int n = snprintf(line, sizeof(line), "%lu,%s,0x%02x,%u,", (unsigned long)rec.time_us, type, rec.value,
+                         (unsigned)rec.len);
+        write(ctx, line, (size_t)n);
+
+        // Payload in line-sized pieces, straight from the ring
+        for (size_t off = 0; off < rec.stored; off += sizeof(payload))
+        {
+            size_t k = rec.stored - off < sizeof(payload) ? rec.stored - off : sizeof(payload);
+
+            xSemaphoreTake(trace->lock, portMAX_DELAY);
+            bool still_there = at >= trace->tail;
+            if (still_there)
+            {
+                ring_copy_out(trace, at + TRACE_RECORD_SIZE + off, payload, k);
+            }
+            xSemaphoreGive(trace->lock);
+            if (!still_there)
+            {
+                break;
+            }
+
+            for (size_t i = 0; i < k; i++)
+            {
+                line[2 * i] = hex[payload[i] >> 4];
+                line[2 * i + 1] = hex[payload[i] & 0xF];
+            }
+            write(ctx, line, 2 * k);
+        }
+        if (rec.stored < rec.len)
+        {
+            write(ctx, "...", 3);
+        }
+        write(ctx, "\n", 1);
+    }
+}
+
+static void dump_binary(weact_epaper_trace_t *trace, weact_epaper_trace_write_fn_t write, void *ctx)
+{
+    weact_epaper_trace_header_t header = {
+        .magic = {'W', 'E', 'P', 'T'},
+        .version = 1,
+        .record_size = TRACE_RECORD_SIZE,
+    };
+    uint8_t chunk[256];
+
+    // Snapshot of the ring; recording waits meanwhile
+    xSemaphoreTake(trace->lock, portMAX_DELAY);
+    header.records = (uint32_t)trace->count;
+    header.dropped = trace->dropped;
+    write(ctx, &header, sizeof(header));
+    for (uint64_t pos = trace->tail; pos < trace->head;)
+    {
+        size_t n = trace->head - pos < sizeof(chunk) ? (size_t)(trace->head - pos) : sizeof(chunk);
+        ring_copy_out(trace, pos, chunk, n);
+        write(ctx, chunk, n);
+        pos += n;
+    }
+    xSemaphoreGive(trace->lock);
+}
+
+void weact_epaper_trace_dump(weact_epaper_trace_t *trace, weact_epaper_trace_format_t format,
+                             weact_epaper_trace_write_fn_t write, void *ctx)
+{
+    if (format == WEACT_EPAPER_TRACE_BINARY)
+    {
+        dump_binary(trace, write, ctx);
+    }
+    else
+    {
+        dump_csv(trace, write, ctx);
+    }
+}
+
+static void console_write(void *ctx, const void *data, size_t len)
+{
+    (void)ctx;
+    fwrite(data, 1, len, stdout);
+}
+
+// Base64 in 57-byte groups (76 characters per line)
+typedef struct {
+    uint8_t in[57];
+    size_t n;
+} base64_ctx_t;
+
+static void base64_line(base64_ctx_t *b)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char out[80];
+    size_t o = 0;
+
+    for (size_t i = 0; i < b->n; i += 3)
+    {
+        uint32_t v = (uint32_t)b->in[i] << 16;
+        if (i + 1 < b->n)
+            v |= (uint32_t)b->in[i + 1] << 8;
+        if (i + 2 < b->n)
+            v |= b->in[i + 2];
+
+        out[o++] = alphabet[(v >> 18) & 0x3F];
+        out[o++] = alphabet[(v >> 12) & 0x3F];
+        out[o++] = i + 1 < b->n ? alphabet[(v >> 6) & 0x3F] : '=';
+        out[o++] = i + 2 < b->n ? alphabet[v & 0x3F] : '=';
+    }
+    out[o++] = '\n';
+    fwrite(out, 1, o, stdout);
+    b->n = 0;
+}
+
+static void base64_write(void *ctx, const void *data, size_t len)
+{
+    base64_ctx_t *b = ctx;
+    const uint8_t *p = data;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        b->in[b->n++] = p[i];
+        if (b->n == sizeof(b->in))
+        {
+            base64_line(b);
+        }
+    }
+}
+
+void weact_epaper_trace_dump_console(weact_epaper_trace_t *trace, weact_epaper_trace_format_t format)
+{
+    if (format == WEACT_EPAPER_TRACE_BINARY)
+    {
+        base64_ctx_t b = {.n = 0};
+        printf("-----BEGIN WEACT EPAPER TRACE-----\n");
+        dump_binary(trace, base64_write, &b);
+        if (b.n > 0)
+        {
+            base64_line(&b);
+        }
+        printf("-----END WEACT EPAPER TRACE-----\n");
+    }
+    else
+    {
+        dump_csv(trace, console_write, NULL);
+    }
+    fflush(stdout);
+}
+
+weact_epaper_trace_t *weact_epaper_trace_load(const uint8_t *data, size_t len)
+{
+    weact_epaper_trace_header_t header;
+
+    if (len < sizeof(header))
+    {
+        return NULL;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, "WEPT", 4) != 0 || header.version != 1 || header.record_size != TRACE_RECORD_SIZE)
+    {
+        ESP_LOGE(TAG, "Not a trace (version %u)", (unsigned)header.version);
+        return NULL;
+    }
+
+    // Walk the records once to check the lengths
+    const uint8_t *body = data + sizeof(header);
+    size_t body_len = len - sizeof(header);
+    size_t pos = 0;
+    for (uint32_t i = 0; i < header.records; i++)
+    {
+        weact_epaper_trace_record_t rec;
+        if (body_len - pos < TRACE_RECORD_SIZE)
+        {
+            ESP_LOGE(TAG, "Trace cut at record %lu", (unsigned long)i);
+            return NULL;
+        }
+        memcpy(&rec, body + pos, TRACE_RECORD_SIZE);
+        pos += TRACE_RECORD_SIZE;
+        if (body_len - pos < rec.stored)
+        {
+            ESP_LOGE(TAG, "Trace cut at record %lu", (unsigned long)i);
+            return NULL;
+        }
+        pos += rec.stored;
+    }
+
+    weact_epaper_trace_t *tr = trace_alloc(pos > 0 ? pos : TRACE_RECORD_SIZE);
+    if (tr == NULL)
+    {
+        return NULL;
+    }
+    memcpy(tr->ring, body, pos);
+    tr->head = pos;
+    tr->count = header.records;
+    tr->dropped = header.dropped;
+    return tr;
+}
+
+// =============================================================================
+// Replay
+// =============================================================================
+
+size_t weact_epaper_trace_replay(weact_epaper_trace_t *trace, weact_epaper_transport_t *target,
+                                 const weact_epaper_trace_replay_config_t *config)
+{
+    weact_epaper_trace_replay_config_t cfg = {0};
+    weact_epaper_trace_record_t rec;
+    uint64_t cursor = 0;
+    uint16_t largest = 0;
+    size_t replayed = 0;
+    size_t skipped = 0;
+
+    if (config != NULL)
+    {
+        cfg = *config;
+    }
+    if (cfg.busy_timeout_ms == 0)
+    {
+        cfg.busy_timeout_ms = WEACT_EPAPER_BUSY_TIMEOUT_US / 1000;
+    }
+
+    while (weact_epaper_trace_next(trace, &cursor, &rec, NULL, 0))
+    {
+        largest = rec.stored > largest ? rec.stored : largest;
+    }
+
+    uint8_t *payload = heap_caps_malloc(largest > 0 ? largest : 1, MALLOC_CAP_8BIT);
+    if (payload == NULL)
+    {
+        ESP_LOGE(TAG, "No memory for a %u byte payload", (unsigned)largest);
+        return 0;
+    }
+
+    bool first = true;
+    uint32_t prev_us = 0;
+    int64_t prev_at = target->now_us(target);
+
+    cursor = 0;
+    while (weact_epaper_trace_next(trace, &cursor, &rec, payload, largest))
+    {
+        bool busy_wait = cfg.wait_busy && rec.type == WEACT_EPAPER_TRACE_BUSY && rec.value == 0;
+
+        // Recorded gap to the previous record, minus what this side already spent;
+        // a BUSY wait takes as long as the target needs instead
+        if (cfg.keep_timing && !first && !busy_wait)
+        {
+            int64_t gap = (int64_t)(uint32_t)(rec.time_us - prev_us);
+            int64_t spent = target->now_us(target) - prev_at;
+            if (gap > spent)
+            {
+                target->delay_us(target, (uint32_t)(gap - spent));
+            }
+        }
+        first = false;
+        prev_us = rec.time_us;
+        prev_at = target->now_us(target);
+
+        switch (rec.type)
+        {
+        case WEACT_EPAPER_TRACE_COMMAND:
+            target->write_command(target, rec.value);
+            break;
+        case WEACT_EPAPER_TRACE_DATA:
+            if (rec.stored < rec.len)
+            {
+                skipped++;
+                continue;
+            }
+            target->write_data(target, payload, rec.len);
+            break;
+        case WEACT_EPAPER_TRACE_READ:
+            if (target->read_register != NULL)
+            {
+                uint8_t value[4];
+                target->read_register(target, rec.value, value, rec.len < sizeof(value) ? rec.len : sizeof(value));
+            }
+            break;
+        case WEACT_EPAPER_TRACE_RST:
+            target->set_rst(target, rec.value);
+            break;
+        case WEACT_EPAPER_TRACE_BUSY:
+            if (busy_wait)
+            {
+                int64_t until = target->now_us(target) + (int64_t)cfg.busy_timeout_ms * 1000;
+                while (target->read_busy(target) == 1 && target->now_us(target) < until)
+                {
+                    target->delay_us(target, 1000);
+                }
+                prev_at = target->now_us(target);
+            }
+            break;
+        default:
+            // DC follows from the transfers, markers are for the reader
+            break;
+        }
+        replayed++;
+    }
+
+    heap_caps_free(payload);
+
+    if (skipped > 0)
+    {
+        ESP_LOGW(TAG, "%u cut data records skipped, replay is not byte exact", (unsigned)skipped);
+    }
+    return replayed;
+}
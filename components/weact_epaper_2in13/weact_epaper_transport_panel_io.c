@@ -0,0 +1,236 @@
+/**
+ * @file weact_epaper_transport_panel_io.c
+ * @brief ESP-IDF transport: esp_lcd panel IO + GPIO + esp_timer
+ */
+
+#include "esp_lcd_panel_ssd1680.h"
+#include "weact_epaper_2in13.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <assert.h>
+#include <string.h>
+
+static const char *TAG = "WEACT_EPAPER_PANEL_IO";
+
+typedef struct {
+    weact_epaper_transport_t base;
+    esp_lcd_panel_io_handle_t io; // Owned by the application
+    gpio_num_t pin_rst;           // -1 = none
+    bool rst_active_high;
+    gpio_num_t pin_busy;
+    bool isr_installed;
+} weact_epaper_panel_io_t;
+
+// tx_param() first collects every queued color transfer; without a command
+// or parameters that is all it does, so queued data may be reused after it
+static void panel_io_drain(weact_epaper_panel_io_t *p)
+{
+    ESP_ERROR_CHECK(esp_lcd_panel_io_tx_param(p->io, -1, NULL, 0));
+}
+
+static void panel_io_write_command(weact_epaper_transport_t *t, uint8_t cmd)
+{
+    weact_epaper_panel_io_t *p = (weact_epaper_panel_io_t *)t;
+
+    ESP_ERROR_CHECK(esp_lcd_panel_io_tx_param(p->io, cmd, NULL, 0));
+}
+
+static void panel_io_write_data(weact_epaper_transport_t *t, const uint8_t *data, size_t len)
+{
+    weact_epaper_panel_io_t *p = (weact_epaper_panel_io_t *)t;
+
+    // No command phase: continues the RAM write of the previous command
+    ESP_ERROR_CHECK(esp_lcd_panel_io_tx_color(p->io, -1, data, len));
+    panel_io_drain(p);
+}
+
+/**
+ * Each command goes out together with the data transfer after it: short
+ * parameters through tx_param(), RAM payloads queued through tx_color().
+ * Further data chunks are queued without a command phase, and the queue is
+ * collected once at the end.
+ */
+static void panel_io_write_batch(weact_epaper_transport_t *t, const weact_epaper_transfer_t *transfers, size_t count)
+{
+    weact_epaper_panel_io_t *p = (weact_epaper_panel_io_t *)t;
+    size_t i = 0;
+
+    while (i < count)
+    {
+        const weact_epaper_transfer_t *tr = &transfers[i++];
+
+        if (tr->dc == 1)
+        {
+            ESP_ERROR_CHECK(esp_lcd_panel_io_tx_color(p->io, -1, tr->data, tr->len));
+            continue;
+        }
+
+        const weact_epaper_transfer_t *param = i < count && transfers[i].dc == 1 ? &transfers[i++] : NULL;
+        if (param == NULL)
+        {
+            ESP_ERROR_CHECK(esp_lcd_panel_io_tx_param(p->io, tr->data[0], NULL, 0));
+        }
+        else if (param->len <= sizeof(param->inline_data))
+        {
+            ESP_ERROR_CHECK(esp_lcd_panel_io_tx_param(p->io, tr->data[0], param->data, param->len));
+        }
+        else
+        {
+            ESP_ERROR_CHECK(esp_lcd_panel_io_tx_color(p->io, tr->data[0], param->data, param->len));
+        }
+    }
+
+    panel_io_drain(p);
+}
+
+/**
+ * Needs a panel IO that can read (3-wire SDA on the WeAct board:
+ * flags.sio_mode); otherwise the data is left untouched.
+ */
+static void panel_io_read_register(weact_epaper_transport_t *t, uint8_t cmd, uint8_t *data, size_t len)
+{
+    weact_epaper_panel_io_t *p = (weact_epaper_panel_io_t *)t;
+    uint8_t value[4];
+
+    assert(len <= sizeof(value));
+
+    if (esp_lcd_panel_io_rx_param(p->io, cmd, value, len) == ESP_OK)
+    {
+        memcpy(data, value, len);
+    }
+}
+
+static int panel_io_read_busy(weact_epaper_transport_t *t)
+{
+    return gpio_get_level(((weact_epaper_panel_io_t *)t)->pin_busy);
+}
+
+static void panel_io_set_rst(weact_epaper_transport_t *t, int level)
+{
+    weact_epaper_panel_io_t *p = (weact_epaper_panel_io_t *)t;
+
+    // level 0 = reset asserted, whatever the pin polarity
+    if (p->pin_rst >= 0)
+    {
+        gpio_set_level(p->pin_rst, p->rst_active_high ? !level : level);
+    }
+}
+
+// Sub-millisecond waits spin, longer ones sleep at least one tick
+static void panel_io_delay_us(weact_epaper_transport_t *t, uint32_t us)
+{
+    if (us < 1000)
+    {
+        esp_rom_delay_us(us);
+        return;
+    }
+
+    TickType_t ticks = pdMS_TO_TICKS(us / 1000);
+    vTaskDelay(ticks > 0 ? ticks : 1);
+}
+
+static int64_t panel_io_now_us(weact_epaper_transport_t *t)
+{
+    return esp_timer_get_time();
+}
+
+static esp_err_t panel_io_set_busy_callback(weact_epaper_transport_t *t, weact_epaper_busy_cb_t cb, void *arg)
+{
+    weact_epaper_panel_io_t *p = (weact_epaper_panel_io_t *)t;
+
+    if (cb == NULL)
+    {
+        if (p->isr_installed)
+        {
+            gpio_isr_handler_remove(p->pin_busy);
+            gpio_set_intr_type(p->pin_busy, GPIO_INTR_DISABLE);
+            p->isr_installed = false;
+        }
+        return ESP_OK;
+    }
+
+    // Shared service, may already be installed by the application
+    esp_err_t err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE)
+    {
+        return err;
+    }
+
+    err = gpio_set_intr_type(p->pin_busy, GPIO_INTR_NEGEDGE);
+    if (err == ESP_OK)
+    {
+        err = gpio_isr_handler_add(p->pin_busy, cb, arg);
+    }
+    p->isr_installed = err == ESP_OK;
+    return err;
+}
+
+static void panel_io_del(weact_epaper_transport_t *t)
+{
+    weact_epaper_panel_io_t *p = (weact_epaper_panel_io_t *)t;
+
+    panel_io_set_busy_callback(t, NULL, NULL);
+
+    if (p->pin_rst >= 0)
+    {
+        gpio_reset_pin(p->pin_rst);
+    }
+    gpio_reset_pin(p->pin_busy);
+
+    heap_caps_free(p);
+}
+
+weact_epaper_transport_t *weact_epaper_transport_new_panel_io(esp_lcd_panel_io_handle_t io, gpio_num_t pin_rst,
+                                                              bool rst_active_high, gpio_num_t pin_busy)
+{
+    weact_epaper_panel_io_t *p = heap_caps_calloc(1, sizeof(weact_epaper_panel_io_t), MALLOC_CAP_8BIT);
+    if (p == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to allocate panel IO transport!");
+        return NULL;
+    }
+
+    p->io = io;
+    p->pin_rst = pin_rst;
+    p->rst_active_high = rst_active_high;
+    p->pin_busy = pin_busy;
+
+    // -------------------------------------------------------------------------
+    // GPIO Configuration
+    // -------------------------------------------------------------------------
+    gpio_config_t io_conf = {
+        .pin_bit_mask = (1ULL << pin_busy),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    ESP_ERROR_CHECK(gpio_config(&io_conf));
+
+    if (pin_rst >= 0)
+    {
+        io_conf.pin_bit_mask = (1ULL << pin_rst);
+        io_conf.mode = GPIO_MODE_OUTPUT;
+        io_conf.pull_up_en = GPIO_PULLUP_DISABLE;
+        ESP_ERROR_CHECK(gpio_config(&io_conf));
+        panel_io_set_rst(&p->base, 1);
+    }
+
+    p->base.write_command = panel_io_write_command;
+    p->base.write_data = panel_io_write_data;
+    p->base.write_batch = panel_io_write_batch;
+    p->base.read_register = panel_io_read_register;
+    p->base.read_busy = panel_io_read_busy;
+    p->base.set_rst = panel_io_set_rst;
+    p->base.delay_us = panel_io_delay_us;
+    p->base.now_us = panel_io_now_us;
+    p->base.set_busy_callback = panel_io_set_busy_callback;
+    p->base.del = panel_io_del;
+    p->base.max_write = 0; // tx_color() splits at the bus max_transfer_sz itself
+
+    return &p->base;
+}
@@ -0,0 +1,308 @@
+/**
+ * @file weact_epaper_transport_spi.c
+ * @brief ESP-IDF transport: SPI master + GPIO + esp_timer
+ */
+
+#include "weact_epaper_2in13.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "soc/soc_caps.h"
+#include <assert.h>
+#include <string.h>
+
+static const char *TAG = "WEACT_EPAPER_SPI";
+
+typedef struct {
+    weact_epaper_transport_t base;
+    spi_device_handle_t spi;
+    spi_host_device_t spi_host; // Host the device is attached to
+    bool owns_bus;              // Holds a reference on a driver-initialized bus
+    gpio_num_t pin_dc;
+    gpio_num_t pin_rst;
+    gpio_num_t pin_busy;
+    bool isr_installed;
+} weact_epaper_spi_t;
+
+// Instances using each SPI host bus the driver initialized
+static uint8_t weact_epaper_bus_refs[SOC_SPI_PERIPH_NUM];
+
+// DC level travels with each transaction in the user field (pin << 1 | level)
+// and is applied in the pre-transfer callback, so queued transactions can
+// switch between command and data without the CPU in the loop.
+#define WEACT_EPAPER_DC_USER(pin, level) ((void *)(intptr_t)(((int)(pin) << 1) | (level)))
+
+static void IRAM_ATTR weact_epaper_spi_pre_cb(spi_transaction_t *trans)
+{
+    intptr_t user = (intptr_t)trans->user;
+    gpio_set_level((gpio_num_t)(user >> 1), user & 1);
+}
+
+static void spi_write_command(weact_epaper_transport_t *t, uint8_t cmd)
+{
+    weact_epaper_spi_t *s = (weact_epaper_spi_t *)t;
+    spi_transaction_t trans = {
+        .length = 8,
+        .tx_buffer = &cmd,
+        .rx_buffer = NULL,
+        .user = WEACT_EPAPER_DC_USER(s->pin_dc, 0), // Command mode
+    };
+
+    ESP_ERROR_CHECK(spi_device_polling_transmit(s->spi, &trans));
+}
+
+static void spi_write_data(weact_epaper_transport_t *t, const uint8_t *data, size_t len)
+{
+    weact_epaper_spi_t *s = (weact_epaper_spi_t *)t;
+    spi_transaction_t trans = {
+        .length = len * 8,
+        .tx_buffer = data,
+        .rx_buffer = NULL,
+        .user = WEACT_EPAPER_DC_USER(s->pin_dc, 1), // Data mode
+    };
+
+    ESP_ERROR_CHECK(spi_device_polling_transmit(s->spi, &trans));
+}
+
+/**
+ * Everything is queued up front and collected at the end, so the SPI
+ * peripheral moves from one transaction to the next without waiting for
+ * the CPU.
+ */
+static void spi_write_batch(weact_epaper_transport_t *t, const weact_epaper_transfer_t *transfers, size_t count)
+{
+    weact_epaper_spi_t *s = (weact_epaper_spi_t *)t;
+    spi_transaction_t trans[WEACT_EPAPER_TRANSPORT_BATCH_MAX];
+    spi_transaction_t *done;
+
+    assert(count <= WEACT_EPAPER_TRANSPORT_BATCH_MAX);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        spi_transaction_t *tr = &trans[i];
+        memset(tr, 0, sizeof(*tr));
+        tr->length = transfers[i].len * 8;
+        tr->user = WEACT_EPAPER_DC_USER(s->pin_dc, transfers[i].dc);
+
+        if (transfers[i].len <= sizeof(tr->tx_data))
+        {
+            tr->flags = SPI_TRANS_USE_TXDATA;
+            memcpy(tr->tx_data, transfers[i].data, transfers[i].len);
+        }
+        else
+        {
+            tr->tx_buffer = transfers[i].data;
+        }
+
+        ESP_ERROR_CHECK(spi_device_queue_trans(s->spi, tr, portMAX_DELAY));
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        ESP_ERROR_CHECK(spi_device_get_trans_result(s->spi, &done, portMAX_DELAY));
+    }
+}
+
+/**
+ * Reads over the bidirectional SDA line. CS stays low between the command
+ * byte and the read, as the controller requires; the bus is held for the
+ * whole exchange.
+ */
+static void spi_read_register(weact_epaper_transport_t *t, uint8_t cmd, uint8_t *data, size_t len)
+{
+    weact_epaper_spi_t *s = (weact_epaper_spi_t *)t;
+
+    assert(len <= 4);
+
+    spi_transaction_t cmd_trans = {
+        .flags = SPI_TRANS_USE_TXDATA | SPI_TRANS_CS_KEEP_ACTIVE,
+        .length = 8,
+        .tx_data = {cmd},
+        .user = WEACT_EPAPER_DC_USER(s->pin_dc, 0),
+    };
+    spi_transaction_t read_trans = {
+        .flags = SPI_TRANS_USE_RXDATA,
+        .rxlength = len * 8,
+        .user = WEACT_EPAPER_DC_USER(s->pin_dc, 1),
+    };
+
+    ESP_ERROR_CHECK(spi_device_acquire_bus(s->spi, portMAX_DELAY));
+    ESP_ERROR_CHECK(spi_device_polling_transmit(s->spi, &cmd_trans));
+    ESP_ERROR_CHECK(spi_device_polling_transmit(s->spi, &read_trans));
+    spi_device_release_bus(s->spi);
+
+    memcpy(data, read_trans.rx_data, len);
+}
+
+static int spi_read_busy(weact_epaper_transport_t *t)
+{
+    return gpio_get_level(((weact_epaper_spi_t *)t)->pin_busy);
+}
+
+static void spi_set_rst(weact_epaper_transport_t *t, int level)
+{
+    gpio_set_level(((weact_epaper_spi_t *)t)->pin_rst, level);
+}
+
+// Sub-millisecond waits spin, longer ones sleep at least one tick
+static void spi_delay_us(weact_epaper_transport_t *t, uint32_t us)
+{
+    if (us < 1000)
+    {
+        esp_rom_delay_us(us);
+        return;
+    }
+
+    TickType_t ticks = pdMS_TO_TICKS(us / 1000);
+    vTaskDelay(ticks > 0 ? ticks : 1);
+}
+
+static int64_t spi_now_us(weact_epaper_transport_t *t)
+{
+    return esp_timer_get_time();
+}
+
+static esp_err_t spi_set_busy_callback(weact_epaper_transport_t *t, weact_epaper_busy_cb_t cb, void *arg)
+{
+    weact_epaper_spi_t *s = (weact_epaper_spi_t *)t;
+
+    if (cb == NULL)
+    {
+        if (s->isr_installed)
+        {
+            gpio_isr_handler_remove(s->pin_busy);
+            gpio_set_intr_type(s->pin_busy, GPIO_INTR_DISABLE);
+            s->isr_installed = false;
+        }
+        return ESP_OK;
+    }
+
+    // Shared service, may already be installed by the application
+    esp_err_t err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE)
+    {
+        return err;
+    }
+
+    err = gpio_set_intr_type(s->pin_busy, GPIO_INTR_NEGEDGE);
+    if (err == ESP_OK)
+    {
+        err = gpio_isr_handler_add(s->pin_busy, cb, arg);
+    }
+    s->isr_installed = err == ESP_OK;
+    return err;
+}
+
+static void spi_del(weact_epaper_transport_t *t)
+{
+    weact_epaper_spi_t *s = (weact_epaper_spi_t *)t;
+
+    spi_set_busy_callback(t, NULL, NULL);
+    spi_bus_remove_device(s->spi);
+
+    if (s->owns_bus && --weact_epaper_bus_refs[s->spi_host] == 0)
+    {
+        spi_bus_free(s->spi_host);
+    }
+
+    heap_caps_free(s);
+}
+
+weact_epaper_transport_t *weact_epaper_transport_new_spi(const weact_epaper_config_t *config)
+{
+    weact_epaper_spi_t *s = heap_caps_calloc(1, sizeof(weact_epaper_spi_t), MALLOC_CAP_8BIT);
+    if (s == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to allocate SPI transport!");
+        return NULL;
+    }
+
+    s->pin_dc = config->pin_dc;
+    s->pin_rst = config->pin_rst;
+    s->pin_busy = config->pin_busy;
+
+    // -------------------------------------------------------------------------
+    // GPIO Configuration
+    // -------------------------------------------------------------------------
+    ESP_LOGI(TAG, "Configuring GPIO pins");
+
+    gpio_config_t io_conf = {
+        .pin_bit_mask = (1ULL << config->pin_dc) | (1ULL << config->pin_rst),
+        .mode = GPIO_MODE_OUTPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    ESP_ERROR_CHECK(gpio_config(&io_conf));
+
+    io_conf.pin_bit_mask = (1ULL << config->pin_busy);
+    io_conf.mode = GPIO_MODE_INPUT;
+    io_conf.pull_up_en = GPIO_PULLUP_ENABLE;
+    ESP_ERROR_CHECK(gpio_config(&io_conf));
+
+    // -------------------------------------------------------------------------
+    // SPI Bus Configuration
+    // -------------------------------------------------------------------------
+    ESP_LOGI(TAG, "Configuring SPI bus");
+
+    // SPI1 is the flash bus, so 0 in the config means "not set"
+    s->spi_host = config->spi_host == SPI1_HOST ? SPI2_HOST : config->spi_host;
+    size_t chunk_size = config->spi_chunk_size > 0 ? config->spi_chunk_size : WEACT_EPAPER_BUFFER_SIZE;
+
+    spi_bus_config_t buscfg = {
+        .mosi_io_num = config->pin_mosi,
+        .miso_io_num = -1,
+        .sclk_io_num = config->pin_sck,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = (int)chunk_size, // Larger frames go out in several chunks
+    };
+
+    // The first instance on a host brings the bus up, later ones share it.
+    // A bus initialized by the application is left alone.
+    if (!config->spi_bus_initialized)
+    {
+        if (weact_epaper_bus_refs[s->spi_host] == 0)
+        {
+            ESP_ERROR_CHECK(spi_bus_initialize(s->spi_host, &buscfg, SPI_DMA_CH_AUTO));
+        }
+        weact_epaper_bus_refs[s->spi_host]++;
+        s->owns_bus = true;
+    }
+
+    spi_device_interface_config_t devcfg = {
+        .clock_speed_hz = config->spi_clock_speed_hz,
+        .mode = 0,
+        .spics_io_num = config->pin_cs,
+        .queue_size = WEACT_EPAPER_TRANSPORT_BATCH_MAX,
+        .flags = SPI_DEVICE_HALFDUPLEX | SPI_DEVICE_3WIRE, // SDA is bidirectional (register reads)
+        .pre_cb = weact_epaper_spi_pre_cb,
+    };
+
+    ESP_ERROR_CHECK(spi_bus_add_device(s->spi_host, &devcfg, &s->spi));
+
+    // The bus limit was fixed by whoever initialized it (the application or
+    // the first instance on this host), which may be below this chunk size
+    size_t bus_max = 0;
+    ESP_ERROR_CHECK(spi_bus_get_max_transaction_len(s->spi_host, &bus_max));
+    if (bus_max < chunk_size)
+    {
+        ESP_LOGW(TAG, "SPI chunk size %u exceeds the bus limit, using %u bytes", (unsigned)chunk_size, (unsigned)bus_max);
+    }
+
+    s->base.write_command = spi_write_command;
+    s->base.write_data = spi_write_data;
+    s->base.write_batch = spi_write_batch;
+    s->base.read_register = spi_read_register;
+    s->base.read_busy = spi_read_busy;
+    s->base.set_rst = spi_set_rst;
+    s->base.delay_us = spi_delay_us;
+    s->base.now_us = spi_now_us;
+    s->base.set_busy_callback = spi_set_busy_callback;
+    s->base.del = spi_del;
+    s->base.max_write = bus_max;
+
+    return &s->base;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file bench_dither.c
+ * @brief Host benchmark for the flush path dither kernels
+ *
+ * Runs every conversion mode over a landscape frame (250x122) of synthetic
+ * content and reports throughput in pixels per second, plus the share of
+ * black pixels as a sanity check (a 50% gray ramp should land near 50%).
+ * Every frame's output is summed into a printed checksum, so the compiler
+ * cannot drop the kernel work of frames whose output is otherwise unused.
+ *
+ * Usage: bench_dither [frames]
+ */
+
+#include "lvgl_weact_epaper_dither.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define FRAME_W 250
+#define FRAME_H 122
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Left half: horizontal gray ramp (gradients, photos).
+ * Right half: thick anti-aliased stripes (2bpp font edges: 0, 85, 170, 255).
+ */
+static void make_frame(uint8_t *luma)
+{
+    static const uint8_t aa_levels[] = {255, 170, 85, 0, 0, 0, 85, 170};
+
+    for (int y = 0; y < FRAME_H; y++)
+    {
+        for (int x = 0; x < FRAME_W; x++)
+        {
+            uint8_t v;
+            if (x < FRAME_W / 2)
+            {
+                v = (uint8_t)(x * 255 / (FRAME_W / 2 - 1));
+            }
+            else
+            {
+                v = aa_levels[(x + y / 4) & 7];
+            }
+            luma[y * FRAME_W + x] = v;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int frames = argc > 1 ? atoi(argv[1]) : 2000;
+    if (frames <= 0)
+    {
+        frames = 1;
+    }
+
+    static uint8_t luma[FRAME_W * FRAME_H];
+    static uint8_t black[FRAME_W];
+    static lvgl_weact_epaper_dither_ctx_t ctx;
+
+    make_frame(luma);
+
+    printf("%-16s %12s %10s %8s %12s\n", "mode", "Mpx/s", "us/frame", "black%", "checksum");
+
+    for (int m = 0; m < LVGL_WEACT_EPAPER_DITHER_COUNT; m++)
+    {
+        lvgl_weact_epaper_dither_init(&ctx, (lvgl_weact_epaper_dither_t)m);
+
+        unsigned long black_px = 0;
+        unsigned long checksum = 0;
+        double t0 = now_s();
+
+        for (int f = 0; f < frames; f++)
+        {
+            lvgl_weact_epaper_dither_begin(&ctx);
+            for (int y = 0; y < FRAME_H; y++)
+            {
+                lvgl_weact_epaper_dither_row(&ctx, &luma[y * FRAME_W], FRAME_W, 0, y, black);
+                for (int x = 0; x < FRAME_W; x++)
+                {
+                    checksum += black[x];
+                }
+                if (f == 0)
+                {
+                    for (int x = 0; x < FRAME_W / 2; x++)
+                    {
+                        black_px += black[x];
+                    }
+                }
+            }
+        }
+
+        double dt = now_s() - t0;
+        double px = (double)frames * FRAME_W * FRAME_H;
+
+        printf("%-16s %12.1f %10.1f %7.1f%% %12lu\n",
+               lvgl_weact_epaper_dither_name((lvgl_weact_epaper_dither_t)m),
+               px / dt / 1e6,
+               dt / frames * 1e6,
+               100.0 * black_px / ((FRAME_W / 2) * FRAME_H),
+               checksum);
+    }
+
+    return 0;
+}
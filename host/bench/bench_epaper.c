@@ -0,0 +1,319 @@
+/**
+ * @file bench_epaper.c
+ * @brief Host benchmark for the framebuffer hot paths
+ *
+ * Times pixel and rectangle drawing, the checkerboard fill of the device
+ * smoke test, framebuffer hashing and row diffing and, when built with
+ * LVGL (-DLVGL_DIR=...), the LVGL flush callback for each color format in
+ * portrait and landscape (rotation) orientation. The flush runs the whole
+ * callback: conversion into the panel framebuffer, then an update on a host
+ * transport without a sink (no SPI time, BUSY always low).
+ *
+ * Each benchmark repeats until it has run for at least the given time and
+ * reports ns per pixel and MB/s (bytes read or written by the kernel) as
+ * JSON on stdout.
+ *
+ * Usage: bench_epaper [min_ms]   (default 250)
+ */
+
+#include "weact_epaper_2in13.h"
+#include "weact_epaper_host.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef BENCH_HAVE_LVGL
+#define BENCH_HAVE_LVGL 0
+#endif
+
+#if BENCH_HAVE_LVGL
+#include "lvgl_weact_epaper.h"
+#include "src/display/lv_display_private.h" // flush_cb, to call the flush directly
+#endif
+
+#define FRAME_PIXELS (WEACT_EPAPER_WIDTH * WEACT_EPAPER_HEIGHT)
+
+typedef void (*bench_fn_t)(void *ctx);
+
+static double s_min_s = 0.25;
+static int s_results;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Time fn and print one JSON result
+ *
+ * @param pixels Pixels handled per call
+ * @param bytes Bytes read or written per call (for MB/s)
+ */
+static void bench_run(const char *name, bench_fn_t fn, void *ctx, double pixels, double bytes)
+{
+    long iterations = 0;
+    long batch = 1;
+    double t0 = now_s();
+    double dt;
+
+    // Double the batch until the minimum time is reached
+    for (;;)
+    {
+        for (long i = 0; i < batch; i++)
+        {
+            fn(ctx);
+        }
+        iterations += batch;
+        dt = now_s() - t0;
+        if (dt >= s_min_s)
+        {
+            break;
+        }
+        batch *= 2;
+    }
+
+    printf("%s\n    {\"name\": \"%s\", \"iterations\": %ld, \"us_per_call\": %.3f, \"ns_per_pixel\": %.3f, "
+           "\"mb_per_s\": %.1f}",
+           s_results++ > 0 ? "," : "", name, iterations, dt / iterations * 1e6, dt / iterations / pixels * 1e9,
+           bytes * iterations / dt / 1e6);
+}
+
+// =============================================================================
+// DRAWING
+// =============================================================================
+
+static void bench_draw_pixel(void *ctx)
+{
+    weact_epaper_t *dev = ctx;
+
+    for (int y = 0; y < WEACT_EPAPER_HEIGHT; y++)
+    {
+        for (int x = 0; x < WEACT_EPAPER_WIDTH; x++)
+        {
+            weact_epaper_draw_pixel(dev, x, y, (uint8_t)((x ^ y) & 1));
+        }
+    }
+}
+
+static void bench_draw_rectangle(void *ctx)
+{
+    weact_epaper_t *dev = ctx;
+
+    weact_epaper_draw_rectangle(dev, 0, 0, WEACT_EPAPER_WIDTH - 1, WEACT_EPAPER_HEIGHT - 1, true);
+}
+
+static void bench_draw_rectangle_outline(void *ctx)
+{
+    weact_epaper_t *dev = ctx;
+
+    weact_epaper_draw_rectangle(dev, 0, 0, WEACT_EPAPER_WIDTH - 1, WEACT_EPAPER_HEIGHT - 1, false);
+}
+
+// Same loop as draw_checkerboard() in the old main/test_ssd1680.c
+static void checkerboard(weact_epaper_t *dev, int square_size)
+{
+    for (int y = 0; y < WEACT_EPAPER_HEIGHT; y++)
+    {
+        for (int x = 0; x < WEACT_EPAPER_WIDTH; x++)
+        {
+            int grid_x = x / square_size;
+            int grid_y = y / square_size;
+            bool is_black = ((grid_x + grid_y) % 2) == 0;
+
+            weact_epaper_draw_pixel(dev, x, y, is_black ? WEACT_EPAPER_COLOR_BLACK : WEACT_EPAPER_COLOR_WHITE);
+        }
+    }
+}
+
+static void bench_checkerboard_16(void *ctx)
+{
+    checkerboard(ctx, 16);
+}
+
+static void bench_checkerboard_4(void *ctx)
+{
+    checkerboard(ctx, 4);
+}
+
+// =============================================================================
+// HASHING AND DIFFING
+// =============================================================================
+
+static volatile uint32_t s_sink;
+
+static void bench_hash(void *ctx)
+{
+    weact_epaper_t *dev = ctx;
+
+    s_sink = weact_epaper_hash(dev->framebuffer, WEACT_EPAPER_BUFFER_SIZE);
+}
+
+static uint8_t s_previous[WEACT_EPAPER_BUFFER_SIZE];
+
+// Identical frames: every row is compared
+static void bench_diff_rows(void *ctx)
+{
+    weact_epaper_t *dev = ctx;
+    int row0;
+    int row1;
+
+    s_sink = weact_epaper_diff_rows(dev->framebuffer, s_previous, &row0, &row1);
+}
+
+// =============================================================================
+// LVGL FLUSH (COLOR CONVERSION AND ROTATION)
+// =============================================================================
+
+#if BENCH_HAVE_LVGL
+
+typedef struct {
+    lv_display_t *disp;
+    uint8_t *px_map;
+    lv_area_t area;
+} flush_bench_t;
+
+static void bench_flush(void *ctx)
+{
+    flush_bench_t *b = ctx;
+
+    b->disp->flush_cb(b->disp, &b->area, b->px_map);
+}
+
+// Gray ramp on the left, anti-aliased stripes on the right (see bench_dither.c)
+static uint8_t pattern_luma(int32_t x, int32_t y, int32_t w)
+{
+    static const uint8_t aa_levels[] = {255, 170, 85, 0, 0, 0, 85, 170};
+
+    return x < w / 2 ? (uint8_t)(x * 255 / (w / 2 - 1)) : aa_levels[(x + y / 4) & 7];
+}
+
+static void fill_pixels(uint8_t *px, lv_color_format_t cf, int32_t w, int32_t h)
+{
+    uint32_t stride = lv_draw_buf_width_to_stride(w, cf);
+
+    for (int32_t y = 0; y < h; y++)
+    {
+        uint8_t *row = px + (size_t)y * stride;
+        for (int32_t x = 0; x < w; x++)
+        {
+            uint8_t v = pattern_luma(x, y, w);
+            switch (cf)
+            {
+            case LV_COLOR_FORMAT_RGB565:
+                ((uint16_t *)row)[x] = (uint16_t)((v >> 3) << 11 | (v >> 2) << 5 | (v >> 3));
+                break;
+            case LV_COLOR_FORMAT_RGB888:
+                row[x * 3] = row[x * 3 + 1] = row[x * 3 + 2] = v;
+                break;
+            case LV_COLOR_FORMAT_XRGB8888:
+                row[x * 4] = row[x * 4 + 1] = row[x * 4 + 2] = v;
+                row[x * 4 + 3] = 0xFF;
+                break;
+            default:
+                row[x] = v;
+                break;
+            }
+        }
+    }
+}
+
+static void bench_lvgl(void)
+{
+    static const struct {
+        lv_color_format_t cf;
+        const char *name;
+    } formats[] = {
+        {LV_COLOR_FORMAT_RGB565, "rgb565"},
+        {LV_COLOR_FORMAT_RGB888, "rgb888"},
+        {LV_COLOR_FORMAT_XRGB8888, "xrgb8888"},
+        {LV_COLOR_FORMAT_L8, "l8"},
+    };
+
+    lv_init();
+
+    for (int landscape = 0; landscape < 2; landscape++)
+    {
+        lvgl_weact_epaper_config_t config = lvgl_weact_epaper_get_default_config();
+        config.transport = weact_epaper_transport_new_host(NULL);
+        config.landscape = landscape;
+
+        flush_bench_t b = {.disp = lvgl_weact_epaper_create(&config)};
+        if (b.disp == NULL)
+        {
+            fprintf(stderr, "lvgl_weact_epaper_create failed\n");
+            exit(1);
+        }
+
+        int32_t w = lv_display_get_horizontal_resolution(b.disp);
+        int32_t h = lv_display_get_vertical_resolution(b.disp);
+        lv_area_set(&b.area, 0, 0, w - 1, h - 1);
+
+        for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++)
+        {
+            uint32_t stride = lv_draw_buf_width_to_stride(w, formats[f].cf);
+            b.px_map = malloc((size_t)stride * h);
+            if (b.px_map == NULL)
+            {
+                exit(1);
+            }
+            fill_pixels(b.px_map, formats[f].cf, w, h);
+            lv_display_set_color_format(b.disp, formats[f].cf);
+
+            char name[64];
+            snprintf(name, sizeof(name), "flush_%s_%s", formats[f].name, landscape ? "landscape" : "portrait");
+            bench_run(name, bench_flush, &b, FRAME_PIXELS, (double)stride * h);
+            free(b.px_map);
+        }
+
+        lvgl_weact_epaper_delete(b.disp);
+        config.transport->del(config.transport);
+    }
+}
+
+#endif // BENCH_HAVE_LVGL
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        s_min_s = atof(argv[1]) / 1000.0;
+    }
+
+    weact_epaper_config_t config = {
+        .transport = weact_epaper_transport_new_host(NULL),
+    };
+    static weact_epaper_t dev;
+
+    if (config.transport == NULL || !weact_epaper_init(&dev, &config))
+    {
+        fprintf(stderr, "weact_epaper_init failed\n");
+        return 1;
+    }
+
+    printf("{\n  \"frame\": {\"width\": %d, \"height\": %d, \"bytes\": %d},\n  \"lvgl\": %s,\n  \"results\": [",
+           WEACT_EPAPER_WIDTH, WEACT_EPAPER_HEIGHT, WEACT_EPAPER_BUFFER_SIZE, BENCH_HAVE_LVGL ? "true" : "false");
+
+    bench_run("draw_pixel", bench_draw_pixel, &dev, FRAME_PIXELS, WEACT_EPAPER_BUFFER_SIZE);
+    bench_run("draw_rectangle_filled", bench_draw_rectangle, &dev, FRAME_PIXELS, WEACT_EPAPER_BUFFER_SIZE);
+    bench_run("draw_rectangle_outline", bench_draw_rectangle_outline, &dev,
+              2 * (WEACT_EPAPER_WIDTH + WEACT_EPAPER_HEIGHT) - 4, 2 * WEACT_EPAPER_HEIGHT + 2 * WEACT_EPAPER_WIDTH_BYTES);
+    bench_run("checkerboard_16", bench_checkerboard_16, &dev, FRAME_PIXELS, WEACT_EPAPER_BUFFER_SIZE);
+    bench_run("checkerboard_4", bench_checkerboard_4, &dev, FRAME_PIXELS, WEACT_EPAPER_BUFFER_SIZE);
+    bench_run("hash_fnv1a", bench_hash, &dev, FRAME_PIXELS, WEACT_EPAPER_BUFFER_SIZE);
+
+    memcpy(s_previous, dev.framebuffer, WEACT_EPAPER_BUFFER_SIZE);
+    bench_run("diff_rows", bench_diff_rows, &dev, FRAME_PIXELS, 2 * WEACT_EPAPER_BUFFER_SIZE);
+
+#if BENCH_HAVE_LVGL
+    bench_lvgl();
+#endif
+
+    printf("\n  ]\n}\n");
+
+    weact_epaper_deinit(&dev);
+    config.transport->del(config.transport);
+    return 0;
+}
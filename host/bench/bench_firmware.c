@@ -0,0 +1,67 @@
+/**
+ * @file bench_firmware.c
+ * @brief Host build of the benchmark firmware (bench/)
+ *
+ * Runs the same harness as the device, against the SSD1680 model on a host
+ * transport with the virtual clock: SPI time follows the configured clock
+ * plus a fixed per-transaction overhead, BUSY follows the model's waveform
+ * timing. The figures check the harness and the driver's bus traffic, not
+ * a real panel.
+ *
+ * Usage: bench_firmware > bench.csv
+ */
+
+#include "epaper_bench.h"
+#include "ssd1680_sim.h"
+#include "weact_epaper_host.h"
+#include <stdio.h>
+
+#ifndef BENCH_HAVE_LVGL
+#define BENCH_HAVE_LVGL 0
+#endif
+
+// Per-transaction cost of the ESP-IDF polling SPI driver, roughly
+#define TRANSACTION_NS 15000
+
+static const uint32_t s_spi_clocks_hz[] = {4000000, 8000000, 10000000, 20000000};
+
+static weact_epaper_transport_t *new_transport(void *ctx, uint32_t spi_hz)
+{
+    weact_epaper_host_sink_t sink = ssd1680_sim_sink(ctx);
+    weact_epaper_transport_t *transport = weact_epaper_transport_new_host(&sink);
+
+    if (transport != NULL)
+    {
+        weact_epaper_transport_host_set_spi(transport, spi_hz, TRANSACTION_NS);
+    }
+    return transport;
+}
+
+int main(void)
+{
+    weact_epaper_host_set_virtual_clock(true);
+
+    ssd1680_sim_t *sim = ssd1680_sim_new(NULL);
+    if (sim == NULL)
+    {
+        return 1;
+    }
+
+    const epaper_bench_config_t config = {
+        .spi_clocks_hz = s_spi_clocks_hz,
+        .spi_clock_count = sizeof(s_spi_clocks_hz) / sizeof(s_spi_clocks_hz[0]),
+        .iterations = 20,
+        .refreshes = 3,
+        .new_transport = new_transport,
+        .ctx = sim,
+    };
+
+    epaper_bench_print_header();
+    bool ok = epaper_bench_run(&config);
+#if BENCH_HAVE_LVGL
+    ok = ok && epaper_bench_lvgl(&config);
+#endif
+
+    ssd1680_sim_delete(sim);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,279 @@
+/**
+ * @file esp_timer_host.c
+ * @brief Host clock and esp_timer, dispatched from sleeping threads
+ */
+
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "weact_epaper_host.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+
+esp_log_level_t weact_epaper_host_log_level = ESP_LOG_WARN;
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    int64_t due_us;     // 0 = not armed
+    uint64_t period_us; // 0 = one-shot
+    struct esp_timer *next;
+};
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct esp_timer *s_timers;
+static _Thread_local bool s_dispatching;
+
+// Virtual clock: time only moves when a thread sleeps or advances it
+static atomic_bool s_virtual;
+static _Atomic int64_t s_virtual_us = 1;
+
+static int64_t next_due_us(void);
+
+int64_t weact_epaper_host_now_us(void)
+{
+    static int64_t epoch;
+    struct timespec ts;
+
+    if (atomic_load(&s_virtual))
+    {
+        return atomic_load(&s_virtual_us);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    int64_t now = (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+
+    // Start near zero like esp_timer after boot
+    if (epoch == 0)
+    {
+        epoch = now - 1;
+    }
+    return now - epoch;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return weact_epaper_host_now_us();
+}
+
+// Earliest armed deadline, INT64_MAX if none
+static int64_t next_due_us(void)
+{
+    int64_t due = INT64_MAX;
+
+    pthread_mutex_lock(&s_lock);
+    for (struct esp_timer *t = s_timers; t != NULL; t = t->next)
+    {
+        if (t->due_us != 0 && t->due_us < due)
+        {
+            due = t->due_us;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+
+    return due;
+}
+
+void weact_epaper_host_poll(void)
+{
+    // A callback that sleeps must not re-enter the dispatcher
+    if (s_dispatching)
+    {
+        return;
+    }
+    s_dispatching = true;
+
+    for (;;)
+    {
+        int64_t now = weact_epaper_host_now_us();
+        struct esp_timer *due = NULL;
+
+        pthread_mutex_lock(&s_lock);
+        for (struct esp_timer *t = s_timers; t != NULL; t = t->next)
+        {
+            if (t->due_us != 0 && t->due_us <= now && (due == NULL || t->due_us < due->due_us))
+            {
+                due = t;
+            }
+        }
+
+        esp_timer_cb_t cb = NULL;
+        void *arg = NULL;
+        if (due != NULL)
+        {
+            cb = due->callback;
+            arg = due->arg;
+            due->due_us = due->period_us > 0 ? due->due_us + (int64_t)due->period_us : 0;
+        }
+        pthread_mutex_unlock(&s_lock);
+
+        if (cb == NULL)
+        {
+            break;
+        }
+        cb(arg);
+    }
+
+    s_dispatching = false;
+}
+
+void weact_epaper_host_set_virtual_clock(bool enable)
+{
+    if (enable && !atomic_load(&s_virtual))
+    {
+        // Continue from the current host time so armed timers stay in order
+        atomic_store(&s_virtual_us, weact_epaper_host_now_us());
+    }
+    atomic_store(&s_virtual, enable);
+}
+
+bool weact_epaper_host_is_virtual_clock(void)
+{
+    return atomic_load(&s_virtual);
+}
+
+// Move the virtual clock forward (never back), one timer deadline at a time
+static void virtual_advance_to(int64_t until)
+{
+    for (;;)
+    {
+        weact_epaper_host_poll();
+
+        int64_t now = atomic_load(&s_virtual_us);
+        if (now >= until)
+        {
+            break;
+        }
+
+        int64_t step = s_dispatching ? until : next_due_us();
+        if (step > until)
+        {
+            step = until;
+        }
+        if (step > now)
+        {
+            // Another thread may have advanced further meanwhile
+            atomic_compare_exchange_strong(&s_virtual_us, &now, step);
+        }
+    }
+}
+
+void weact_epaper_host_sleep_us(uint64_t us)
+{
+    if (atomic_load(&s_virtual))
+    {
+        virtual_advance_to(atomic_load(&s_virtual_us) + (int64_t)us);
+        return;
+    }
+
+    int64_t until = weact_epaper_host_now_us() + (int64_t)us;
+
+    for (;;)
+    {
+        weact_epaper_host_poll();
+
+        int64_t now = weact_epaper_host_now_us();
+        if (now >= until)
+        {
+            break;
+        }
+
+        int64_t wake = s_dispatching ? until : next_due_us();
+        if (wake > until)
+        {
+            wake = until;
+        }
+        if (wake > now)
+        {
+            int64_t d = wake - now;
+            struct timespec ts = {.tv_sec = d / 1000000, .tv_nsec = (d % 1000000) * 1000};
+            nanosleep(&ts, NULL);
+        }
+    }
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out_handle)
+{
+    struct esp_timer *t = calloc(1, sizeof(*t));
+    if (t == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    t->callback = args->callback;
+    t->arg = args->arg;
+
+    pthread_mutex_lock(&s_lock);
+    t->next = s_timers;
+    s_timers = t;
+    pthread_mutex_unlock(&s_lock);
+
+    *out_handle = t;
+    return ESP_OK;
+}
+
+static esp_err_t timer_start(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period_us)
+{
+    esp_err_t err = ESP_OK;
+
+    pthread_mutex_lock(&s_lock);
+    if (timer->due_us != 0)
+    {
+        err = ESP_ERR_INVALID_STATE;
+    }
+    else
+    {
+        timer->due_us = weact_epaper_host_now_us() + (int64_t)timeout_us;
+        timer->period_us = period_us;
+        if (timer->due_us == 0)
+        {
+            timer->due_us = 1;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+
+    return err;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    return timer_start(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us)
+{
+    return timer_start(timer, period_us, period_us);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    esp_err_t err = ESP_OK;
+
+    pthread_mutex_lock(&s_lock);
+    if (timer->due_us == 0)
+    {
+        err = ESP_ERR_INVALID_STATE;
+    }
+    timer->due_us = 0;
+    pthread_mutex_unlock(&s_lock);
+
+    return err;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    pthread_mutex_lock(&s_lock);
+    for (struct esp_timer **p = &s_timers; *p != NULL; p = &(*p)->next)
+    {
+        if (*p == timer)
+        {
+            *p = timer->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+
+    free(timer);
+    return ESP_OK;
+}
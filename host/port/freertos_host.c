@@ -0,0 +1,314 @@
+/**
+ * @file freertos_host.c
+ * @brief FreeRTOS tasks, mutexes and event groups on pthreads
+ *
+ * Priorities and stack sizes are ignored. Delays go through
+ * weact_epaper_host_sleep_us() so esp_timer callbacks keep running.
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "weact_epaper_host.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct weact_epaper_host_task {
+    pthread_t thread;
+    TaskFunction_t fn;
+    void *arg;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify;
+};
+
+struct weact_epaper_host_mutex {
+    pthread_mutex_t mutex;
+};
+
+struct weact_epaper_host_event_group {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    EventBits_t bits;
+};
+
+static _Thread_local struct weact_epaper_host_task *s_current;
+
+// Absolute CLOCK_REALTIME deadline for pthread_cond_timedwait()
+static struct timespec deadline_after(TickType_t ticks)
+{
+    struct timespec ts;
+    uint64_t ms = (uint64_t)ticks * portTICK_PERIOD_MS;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += (time_t)(ms / 1000);
+    ts.tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+// Wait on cond; false on timeout. ticks = 0 does not wait.
+static bool cond_wait_ticks(pthread_cond_t *cond, pthread_mutex_t *lock, TickType_t ticks)
+{
+    if (ticks == 0)
+    {
+        return false;
+    }
+    if (ticks == portMAX_DELAY)
+    {
+        pthread_cond_wait(cond, lock);
+        return true;
+    }
+
+    struct timespec ts = deadline_after(ticks);
+    return pthread_cond_timedwait(cond, lock, &ts) != ETIMEDOUT;
+}
+
+// =============================================================================
+// Tasks
+// =============================================================================
+
+static void *task_entry(void *arg)
+{
+    struct weact_epaper_host_task *task = arg;
+    s_current = task;
+    task->fn(task->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *out_handle)
+{
+    (void)name;
+    (void)stack_depth;
+    (void)priority;
+
+    struct weact_epaper_host_task *task = calloc(1, sizeof(*task));
+    if (task == NULL)
+    {
+        return pdFAIL;
+    }
+
+    task->fn = fn;
+    task->arg = arg;
+    pthread_mutex_init(&task->lock, NULL);
+    pthread_cond_init(&task->cond, NULL);
+
+    if (out_handle != NULL)
+    {
+        *out_handle = task;
+    }
+
+    if (pthread_create(&task->thread, NULL, task_entry, task) != 0)
+    {
+        free(task);
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    // Only self-deletion is used; the handle is leaked like a TCB without idle task cleanup
+    if (task == NULL || task == s_current)
+    {
+        pthread_exit(NULL);
+    }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    weact_epaper_host_sleep_us((uint64_t)ticks * portTICK_PERIOD_MS * 1000);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(weact_epaper_host_now_us() / (portTICK_PERIOD_MS * 1000));
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return s_current;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    struct weact_epaper_host_task *task = s_current;
+    uint32_t value;
+
+    if (task == NULL)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&task->lock);
+    while (task->notify == 0 && cond_wait_ticks(&task->cond, &task->lock, ticks))
+    {
+    }
+    value = task->notify;
+    if (value > 0)
+    {
+        task->notify = clear_on_exit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&task->lock);
+
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&task->lock);
+    task->notify++;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken)
+{
+    xTaskNotifyGive(task);
+    if (woken != NULL)
+    {
+        *woken = pdFALSE;
+    }
+}
+
+// =============================================================================
+// Mutexes (all recursive; FreeRTOS plain mutexes are a subset)
+// =============================================================================
+
+static SemaphoreHandle_t mutex_create(void)
+{
+    struct weact_epaper_host_mutex *m = calloc(1, sizeof(*m));
+    pthread_mutexattr_t attr;
+
+    if (m == NULL)
+    {
+        return NULL;
+    }
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&m->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return m;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return mutex_create();
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void)
+{
+    return mutex_create();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    if (ticks == portMAX_DELAY)
+    {
+        return pthread_mutex_lock(&sem->mutex) == 0 ? pdTRUE : pdFALSE;
+    }
+    if (ticks == 0)
+    {
+        return pthread_mutex_trylock(&sem->mutex) == 0 ? pdTRUE : pdFALSE;
+    }
+
+    struct timespec ts = deadline_after(ticks);
+    return pthread_mutex_timedlock(&sem->mutex, &ts) == 0 ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    return pthread_mutex_unlock(&sem->mutex) == 0 ? pdTRUE : pdFALSE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    pthread_mutex_destroy(&sem->mutex);
+    free(sem);
+}
+
+// =============================================================================
+// Event groups
+// =============================================================================
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    struct weact_epaper_host_event_group *g = calloc(1, sizeof(*g));
+    if (g == NULL)
+    {
+        return NULL;
+    }
+
+    pthread_mutex_init(&g->lock, NULL);
+    pthread_cond_init(&g->cond, NULL);
+    return g;
+}
+
+void vEventGroupDelete(EventGroupHandle_t group)
+{
+    pthread_cond_destroy(&group->cond);
+    pthread_mutex_destroy(&group->lock);
+    free(group);
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    pthread_mutex_lock(&group->lock);
+    group->bits |= bits;
+    EventBits_t now = group->bits;
+    pthread_cond_broadcast(&group->cond);
+    pthread_mutex_unlock(&group->lock);
+    return now;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    pthread_mutex_lock(&group->lock);
+    EventBits_t before = group->bits;
+    group->bits &= ~bits;
+    pthread_mutex_unlock(&group->lock);
+    return before;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group)
+{
+    pthread_mutex_lock(&group->lock);
+    EventBits_t now = group->bits;
+    pthread_mutex_unlock(&group->lock);
+    return now;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t ticks)
+{
+    pthread_mutex_lock(&group->lock);
+    for (;;)
+    {
+        EventBits_t set = group->bits & bits;
+        bool met = wait_for_all ? set == bits : set != 0;
+        if (met || !cond_wait_ticks(&group->cond, &group->lock, ticks))
+        {
+            break;
+        }
+    }
+
+    EventBits_t now = group->bits;
+    if (clear_on_exit)
+    {
+        group->bits &= ~bits;
+    }
+    pthread_mutex_unlock(&group->lock);
+
+    return now;
+}
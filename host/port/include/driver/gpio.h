@@ -0,0 +1,8 @@
+#pragma once
+// Host port: pin numbers only, the host transport has no GPIO
+
+typedef enum {
+    GPIO_NUM_NC = -1,
+    GPIO_NUM_0 = 0,
+    GPIO_NUM_MAX = 64,
+} gpio_num_t;
@@ -0,0 +1,10 @@
+#pragma once
+// Host port: host ids only, the host transport has no SPI
+#include <stddef.h>
+#include "esp_err.h"
+
+typedef enum {
+    SPI1_HOST = 0,
+    SPI2_HOST = 1,
+    SPI3_HOST = 2,
+} spi_host_device_t;
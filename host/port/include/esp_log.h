@@ -0,0 +1,32 @@
+#pragma once
+// Host port: ESP_LOGx to stderr, filtered by esp_log_level_set("*", ...)
+#include <stdio.h>
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE,
+} esp_log_level_t;
+
+extern esp_log_level_t weact_epaper_host_log_level;
+
+static inline void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    (void)tag;
+    weact_epaper_host_log_level = level;
+}
+
+#define WEACT_EPAPER_HOST_LOG(level, letter, tag, fmt, ...) do {               \
+        if (weact_epaper_host_log_level >= (level)) {                        \
+            fprintf(stderr, letter " (%s): " fmt "\n", tag, ##__VA_ARGS__);  \
+        }                                                                    \
+    } while (0)
+
+#define ESP_LOGE(tag, fmt, ...) WEACT_EPAPER_HOST_LOG(ESP_LOG_ERROR, "E", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) WEACT_EPAPER_HOST_LOG(ESP_LOG_WARN, "W", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) WEACT_EPAPER_HOST_LOG(ESP_LOG_INFO, "I", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) WEACT_EPAPER_HOST_LOG(ESP_LOG_DEBUG, "D", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) WEACT_EPAPER_HOST_LOG(ESP_LOG_VERBOSE, "V", tag, fmt, ##__VA_ARGS__)
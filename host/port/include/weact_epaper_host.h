@@ -0,0 +1,84 @@
+#ifndef WEACT_EPAPER_HOST_H
+#define WEACT_EPAPER_HOST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "weact_epaper_transport.h"
+
+/**
+ * @brief Host (Linux/macOS) port of the components
+ *
+ * The FreeRTOS, esp_timer and esp_log headers in host/port/include map to
+ * pthreads and the host clock. esp_timer callbacks do not get a thread of
+ * their own: they run from whichever thread sleeps (vTaskDelay(), transport
+ * delays) or calls weact_epaper_host_poll(), so a single-threaded test sees
+ * them at deterministic points.
+ */
+
+/**
+ * @brief Host clock in microseconds (esp_timer_get_time())
+ */
+int64_t weact_epaper_host_now_us(void);
+
+/**
+ * @brief Sleep, running esp_timer callbacks that fall due meanwhile
+ *
+ * With the virtual clock this returns at once: the clock jumps to the end
+ * of the sleep, stopping at each timer deadline on the way.
+ */
+void weact_epaper_host_sleep_us(uint64_t us);
+
+/**
+ * @brief Run esp_timer callbacks that are due now
+ */
+void weact_epaper_host_poll(void);
+
+/**
+ * @brief Switch between the host clock and a virtual clock
+ *
+ * The virtual clock starts at the current host time and only moves when a
+ * thread sleeps (vTaskDelay(), transport delays, modelled SPI time), so a
+ * single-threaded run gives the same timestamps every time and a two
+ * second refresh takes no wall time. Sleeps in several threads each move
+ * the shared clock. FreeRTOS waits with a timeout still use wall time.
+ */
+void weact_epaper_host_set_virtual_clock(bool enable);
+bool weact_epaper_host_is_virtual_clock(void);
+
+/**
+ * @brief What sits on the other end of the host transport
+ *
+ * Every member is optional. Without a sink the transport discards bytes and
+ * reports BUSY low.
+ */
+typedef struct {
+    void (*on_command)(void *ctx, uint8_t cmd);
+    void (*on_data)(void *ctx, const uint8_t *data, size_t len);
+    void (*on_read)(void *ctx, uint8_t cmd, uint8_t *data, size_t len);
+    void (*on_rst)(void *ctx, int level);
+    int (*busy)(void *ctx);
+    void *ctx;
+} weact_epaper_host_sink_t;
+
+/**
+ * @brief Host transport (delays and clock from the host port)
+ *
+ * @param sink Byte and BUSY handlers, copied (NULL = none)
+ * @return Transport for weact_epaper_config_t::transport, NULL on failure
+ */
+weact_epaper_transport_t *weact_epaper_transport_new_host(const weact_epaper_host_sink_t *sink);
+
+/**
+ * @brief Charge SPI time on a host transport
+ *
+ * Every transfer then sleeps transaction_ns plus 8 bits per byte at
+ * clock_hz (sub-microsecond remainders carry over), so upload time grows
+ * with the clock and the bytes sent as it does on the device.
+ *
+ * @param clock_hz SPI clock, 0 = transfers take no time (default)
+ * @param transaction_ns Fixed cost per command or data transfer (CS, DC, driver)
+ */
+void weact_epaper_transport_host_set_spi(weact_epaper_transport_t *t, uint32_t clock_hz, uint32_t transaction_ns);
+
+#endif // WEACT_EPAPER_HOST_H
@@ -0,0 +1,139 @@
+/**
+ * @file weact_epaper_transport_host.c
+ * @brief Host transport: bytes go to a sink, time comes from the host port
+ */
+
+#include "weact_epaper_2in13.h"
+#include "weact_epaper_host.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "WEACT_EPAPER_HOST";
+
+typedef struct {
+    weact_epaper_transport_t base;
+    weact_epaper_host_sink_t sink;
+    uint32_t spi_clock_hz;      // 0 = no SPI time
+    uint32_t transaction_ns;
+    uint64_t pending_ns;        // SPI time not yet slept (below 1 us)
+} weact_epaper_host_transport_t;
+
+static void host_spi_time(weact_epaper_host_transport_t *h, size_t len)
+{
+    if (h->spi_clock_hz == 0)
+    {
+        return;
+    }
+
+    h->pending_ns += h->transaction_ns + (uint64_t)len * 8 * 1000000000ull / h->spi_clock_hz;
+    if (h->pending_ns >= 1000)
+    {
+        weact_epaper_host_sleep_us(h->pending_ns / 1000);
+        h->pending_ns %= 1000;
+    }
+}
+
+static void host_write_command(weact_epaper_transport_t *t, uint8_t cmd)
+{
+    weact_epaper_host_transport_t *h = (weact_epaper_host_transport_t *)t;
+    if (h->sink.on_command != NULL)
+    {
+        h->sink.on_command(h->sink.ctx, cmd);
+    }
+    host_spi_time(h, 1);
+}
+
+static void host_write_data(weact_epaper_transport_t *t, const uint8_t *data, size_t len)
+{
+    weact_epaper_host_transport_t *h = (weact_epaper_host_transport_t *)t;
+    if (h->sink.on_data != NULL)
+    {
+        h->sink.on_data(h->sink.ctx, data, len);
+    }
+    host_spi_time(h, len);
+}
+
+static void host_read_register(weact_epaper_transport_t *t, uint8_t cmd, uint8_t *data, size_t len)
+{
+    weact_epaper_host_transport_t *h = (weact_epaper_host_transport_t *)t;
+    if (h->sink.on_read != NULL)
+    {
+        h->sink.on_read(h->sink.ctx, cmd, data, len);
+    }
+    host_spi_time(h, 1 + len);
+}
+
+static int host_read_busy(weact_epaper_transport_t *t)
+{
+    weact_epaper_host_sink_t *sink = &((weact_epaper_host_transport_t *)t)->sink;
+    return sink->busy != NULL ? sink->busy(sink->ctx) : 0;
+}
+
+static void host_set_rst(weact_epaper_transport_t *t, int level)
+{
+    weact_epaper_host_sink_t *sink = &((weact_epaper_host_transport_t *)t)->sink;
+    if (sink->on_rst != NULL)
+    {
+        sink->on_rst(sink->ctx, level);
+    }
+}
+
+static void host_delay_us(weact_epaper_transport_t *t, uint32_t us)
+{
+    (void)t;
+    weact_epaper_host_sleep_us(us);
+}
+
+static int64_t host_now_us(weact_epaper_transport_t *t)
+{
+    (void)t;
+    return weact_epaper_host_now_us();
+}
+
+static void host_del(weact_epaper_transport_t *t)
+{
+    free(t);
+}
+
+weact_epaper_transport_t *weact_epaper_transport_new_host(const weact_epaper_host_sink_t *sink)
+{
+    weact_epaper_host_transport_t *h = calloc(1, sizeof(*h));
+    if (h == NULL)
+    {
+        return NULL;
+    }
+
+    if (sink != NULL)
+    {
+        h->sink = *sink;
+    }
+
+    // No write_batch (one call per transfer) and no BUSY interrupt (init polls)
+    h->base.write_command = host_write_command;
+    h->base.write_data = host_write_data;
+    h->base.read_register = host_read_register;
+    h->base.read_busy = host_read_busy;
+    h->base.set_rst = host_set_rst;
+    h->base.delay_us = host_delay_us;
+    h->base.now_us = host_now_us;
+    h->base.del = host_del;
+
+    return &h->base;
+}
+
+void weact_epaper_transport_host_set_spi(weact_epaper_transport_t *t, uint32_t clock_hz, uint32_t transaction_ns)
+{
+    weact_epaper_host_transport_t *h = (weact_epaper_host_transport_t *)t;
+
+    h->spi_clock_hz = clock_hz;
+    h->transaction_ns = transaction_ns;
+    h->pending_ns = 0;
+}
+
+weact_epaper_transport_t *weact_epaper_transport_new_spi(const weact_epaper_config_t *config)
+{
+    (void)config;
+    ESP_LOGE(TAG, "No SPI on the host, set weact_epaper_config_t::transport");
+    return NULL;
+}
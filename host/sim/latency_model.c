@@ -0,0 +1,328 @@
+/**
+ * @file latency_model.c
+ * @brief End-to-end update latency on the virtual clock
+ *
+ * Plays a script of display updates against the driver and the SSD1680
+ * model with modelled SPI time, on the virtual clock: a minute of
+ * refreshes takes milliseconds, and the same script always gives the same
+ * numbers. Each update is what lvgl_weact_epaper does for one LVGL flush:
+ * redraw an area of the framebuffer (here: invert it), then refresh. An
+ * update that arrives while the panel is busy waits (LVGL blocks in the
+ * flush callback), so queueing shows up in the latency.
+ *
+ * Script, one update per line ('#' starts a comment):
+ *
+ *   <at_ms> <kind> [x y w h]
+ *
+ *   full     weact_epaper_display_frame(), standard profile (0xF7)
+ *   burst    weact_epaper_display_frame(), burst profile (no temperature/LUT reload)
+ *   partial  weact_epaper_display_diff() against the image on the panel (mode 2)
+ *   page     page flip with the custom page LUT (longer waveform than partial)
+ *
+ * Usage: latency_model [-t temp_c] [-s spi_hz] [-o transaction_ns] [-c] [script]
+ *   -c  coalesce: updates queued behind a busy panel go out as one refresh
+ */
+
+#include "ssd1680_sim.h"
+#include "weact_epaper_2in13.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_UPDATES 1024
+
+typedef enum {
+    KIND_FULL = 0,
+    KIND_BURST,
+    KIND_PARTIAL,
+    KIND_PAGE,
+} update_kind_t;
+
+static const char *const kind_names[] = {"full", "burst", "partial", "page"};
+
+typedef struct {
+    int64_t at_us;
+    update_kind_t kind;
+    int x, y, w, h;
+    int64_t start_us;
+    int64_t done_us;
+    uint32_t busy_us;   // Model BUSY time of the refresh that carried it
+    uint64_t bytes;     // SPI bytes of that refresh
+    int batch;          // Refresh number
+} update_t;
+
+static const char default_script[] =
+    "# Boot screen, then button presses and a clock tick\n"
+    "0      full     0  0  122 250\n"
+    "2500   partial  10 40 100 20\n"
+    "2600   partial  10 70 100 20\n"
+    "2700   partial  10 100 100 20\n"
+    "6000   page     10 130 100 20\n"
+    "8000   burst    10 160 100 20\n"
+    "8200   burst    10 190 100 20\n"
+    "60000  full     0  0  122 30\n";
+
+static int parse_script(FILE *f, const char *text, update_t *updates)
+{
+    char line[256];
+    int n = 0;
+    const char *p = text;
+
+    for (;;)
+    {
+        if (f != NULL)
+        {
+            if (fgets(line, sizeof(line), f) == NULL)
+            {
+                break;
+            }
+        }
+        else
+        {
+            if (*p == '\0')
+            {
+                break;
+            }
+            size_t len = strcspn(p, "\n");
+            snprintf(line, sizeof(line), "%.*s", (int)len, p);
+            p += len + (p[len] == '\n');
+        }
+
+        char *hash = strchr(line, '#');
+        if (hash != NULL)
+        {
+            *hash = '\0';
+        }
+
+        double at_ms;
+        char kind[16];
+        update_t u = {.x = 0, .y = 0, .w = WEACT_EPAPER_WIDTH, .h = WEACT_EPAPER_HEIGHT};
+        int fields = sscanf(line, "%lf %15s %d %d %d %d", &at_ms, kind, &u.x, &u.y, &u.w, &u.h);
+        if (fields < 2)
+        {
+            continue;
+        }
+
+        u.kind = (update_kind_t)-1;
+        for (size_t k = 0; k < sizeof(kind_names) / sizeof(kind_names[0]); k++)
+        {
+            if (strcmp(kind, kind_names[k]) == 0)
+            {
+                u.kind = (update_kind_t)k;
+            }
+        }
+        if ((int)u.kind < 0 || n == MAX_UPDATES)
+        {
+            fprintf(stderr, "bad script line: %s\n", line);
+            return -1;
+        }
+
+        u.at_us = (int64_t)(at_ms * 1000);
+        if (n > 0 && u.at_us < updates[n - 1].at_us)
+        {
+            fprintf(stderr, "script is not in time order: %s\n", line);
+            return -1;
+        }
+        updates[n++] = u;
+    }
+
+    return n;
+}
+
+// Every update changes every pixel of its area
+static void invert_area(weact_epaper_t *dev, int x0, int y0, int w, int h)
+{
+    for (int y = y0; y < y0 + h && y < WEACT_EPAPER_HEIGHT; y++)
+    {
+        for (int x = x0; x < x0 + w && x < WEACT_EPAPER_WIDTH; x++)
+        {
+            int white = (dev->framebuffer[y * WEACT_EPAPER_WIDTH_BYTES + x / 8] >> (7 - x % 8)) & 1;
+            weact_epaper_draw_pixel(dev, x, y, white ? WEACT_EPAPER_COLOR_BLACK : WEACT_EPAPER_COLOR_WHITE);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    double temp_c = 25.0;
+    uint32_t spi_hz = 4000000;
+    uint32_t transaction_ns = 15000;
+    bool coalesce = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:s:o:c")) != -1)
+    {
+        switch (opt)
+        {
+        case 't':
+            temp_c = atof(optarg);
+            break;
+        case 's':
+            spi_hz = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'o':
+            transaction_ns = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'c':
+            coalesce = true;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-t temp_c] [-s spi_hz] [-o transaction_ns] [-c] [script]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    static update_t updates[MAX_UPDATES];
+    FILE *f = NULL;
+    if (optind < argc)
+    {
+        f = fopen(argv[optind], "r");
+        if (f == NULL)
+        {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+    int count = parse_script(f, default_script, updates);
+    if (f != NULL)
+    {
+        fclose(f);
+    }
+    if (count <= 0)
+    {
+        return 1;
+    }
+
+    weact_epaper_host_set_virtual_clock(true);
+
+    ssd1680_sim_config_t sim_config = ssd1680_sim_default_config();
+    sim_config.temperature_x16 = (int16_t)(temp_c * 16);
+    ssd1680_sim_t *sim = ssd1680_sim_new(&sim_config);
+    weact_epaper_host_sink_t sink = ssd1680_sim_sink(sim);
+    weact_epaper_config_t config = {
+        .transport = weact_epaper_transport_new_host(&sink),
+    };
+    weact_epaper_t dev;
+
+    if (sim == NULL || config.transport == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    weact_epaper_transport_host_set_spi(config.transport, spi_hz, transaction_ns);
+
+    if (!weact_epaper_init(&dev, &config))
+    {
+        fprintf(stderr, "weact_epaper_init failed\n");
+        return 1;
+    }
+    weact_epaper_clear_screen(&dev);
+
+    // Image on the panel, for differential updates
+    static uint8_t shown[WEACT_EPAPER_BUFFER_SIZE];
+    memcpy(shown, dev.framebuffer, sizeof(shown));
+
+    weact_epaper_reset_stats(&dev);
+    const int64_t t0 = weact_epaper_host_now_us();
+    weact_epaper_page_t hidden_page = WEACT_EPAPER_PAGE_1;
+    weact_epaper_refresh_profile_t profile = WEACT_EPAPER_PROFILE_STANDARD;
+    int refreshes = 0;
+
+    for (int i = 0; i < count;)
+    {
+        int64_t now = weact_epaper_host_now_us() - t0;
+        if (now < updates[i].at_us)
+        {
+            weact_epaper_host_sleep_us((uint64_t)(updates[i].at_us - now));
+            now = updates[i].at_us;
+        }
+
+        // Updates that have arrived by now go out together when coalescing
+        int last = i;
+        while (coalesce && last + 1 < count && updates[last + 1].at_us <= now)
+        {
+            last++;
+        }
+
+        update_kind_t kind = updates[last].kind;
+        for (int j = i; j <= last; j++)
+        {
+            update_t *u = &updates[j];
+            invert_area(&dev, u->x, u->y, u->w, u->h);
+            if (u->kind == KIND_FULL)
+            {
+                kind = KIND_FULL; // A full refresh in the batch wins
+            }
+            u->start_us = now;
+        }
+
+        weact_epaper_refresh_profile_t want = kind == KIND_BURST ? WEACT_EPAPER_PROFILE_BURST
+                                                                 : (kind == KIND_FULL ? WEACT_EPAPER_PROFILE_STANDARD : profile);
+        if (want != profile)
+        {
+            weact_epaper_set_refresh_profile(&dev, want, 5000, 600000);
+            profile = want;
+        }
+
+        ssd1680_sim_reset_stats(sim);
+        switch (kind)
+        {
+        case KIND_PARTIAL:
+            weact_epaper_display_diff(&dev, shown);
+            break;
+        case KIND_PAGE:
+            weact_epaper_page_load(&dev, hidden_page, dev.framebuffer);
+            weact_epaper_page_show(&dev, hidden_page);
+            hidden_page = hidden_page == WEACT_EPAPER_PAGE_0 ? WEACT_EPAPER_PAGE_1 : WEACT_EPAPER_PAGE_0;
+            break;
+        default:
+            weact_epaper_display_frame(&dev);
+            break;
+        }
+        memcpy(shown, dev.framebuffer, sizeof(shown));
+
+        const ssd1680_sim_stats_t *s = ssd1680_sim_stats(sim);
+        int64_t done = weact_epaper_host_now_us() - t0;
+        for (int j = i; j <= last; j++)
+        {
+            updates[j].done_us = done;
+            updates[j].busy_us = (uint32_t)s->busy_us;
+            updates[j].bytes = s->data_bytes;
+            updates[j].batch = refreshes;
+        }
+        refreshes++;
+        i = last + 1;
+    }
+
+    printf("temperature %.1f C, SPI %.1f MHz, %u ns per transfer%s\n\n", temp_c, spi_hz / 1e6,
+           (unsigned)transaction_ns, coalesce ? ", coalescing" : "");
+    printf("  #  refresh  kind       at_ms   start_ms    done_ms  latency_ms  busy_ms  spi_bytes\n");
+
+    double sum_ms = 0;
+    double max_ms = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const update_t *u = &updates[i];
+        double latency_ms = (u->done_us - u->at_us) / 1000.0;
+        sum_ms += latency_ms;
+        max_ms = latency_ms > max_ms ? latency_ms : max_ms;
+        printf("%3d  %7d  %-8s %8.1f %10.1f %10.1f %11.1f %8.1f %10llu\n", i, u->batch, kind_names[u->kind],
+               u->at_us / 1000.0, u->start_us / 1000.0, u->done_us / 1000.0, latency_ms, u->busy_us / 1000.0,
+               (unsigned long long)u->bytes);
+    }
+
+    printf("\nupdates %d, refreshes %d, latency mean %.1f ms, max %.1f ms, script done at %.1f ms\n", count,
+           refreshes, sum_ms / count, max_ms, updates[count - 1].done_us / 1000.0);
+
+    // Charge with the default currents, from the first scripted update on
+    weact_epaper_energy_t energy;
+    weact_epaper_get_energy(&dev, &energy);
+    printf("refreshes full %u, partial %u, lut %u; analog on %.1f s; charge %.2f uAh (%.2f uAh per update, %.1f uAh/h)\n",
+           energy.full_refreshes, energy.partial_refreshes, energy.lut_refreshes, energy.analog_on_us / 1e6,
+           energy.charge_uah, energy.update_uah_mean, energy.uah_per_hour);
+
+    weact_epaper_deinit(&dev);
+    ssd1680_sim_delete(sim);
+    return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file sim_demo.c
+ * @brief Driver against the SSD1680 model on the host
+ *
+ * Runs weact_epaper_init(), a full frame, a differential update and
+ * weact_epaper_clear_screen() on the model, writes every refreshed image
+ * and prints what the controller saw, then the driver's update timing.
+ *
+ * Usage: sim_demo [frame_prefix]   (default "sim_frame", "-" = no files)
+ */
+
+#include "ssd1680_sim.h"
+#include "weact_epaper_2in13.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void print_stats(const char *step, const ssd1680_sim_stats_t *s, int64_t elapsed_us)
+{
+    printf("%-10s %6u tx %5u cmd %7llu bytes  refresh %u (full %u, partial %u, lut %u)  busy %7.1f ms  wall %7.1f ms\n",
+           step, s->transactions, s->commands, (unsigned long long)s->data_bytes,
+           s->refreshes, s->full_refreshes, s->partial_refreshes, s->lut_refreshes,
+           s->busy_us / 1000.0, elapsed_us / 1000.0);
+}
+
+static void print_phase(const char *name, const weact_epaper_phase_stats_t *p)
+{
+    printf("%-10s %3u x  last %7.1f  min %7.1f  mean %7.1f  max %7.1f ms  buckets", name, p->count,
+           p->last_us / 1000.0, p->min_us / 1000.0, p->mean_us / 1000.0, p->max_us / 1000.0);
+    for (int i = 0; i < WEACT_EPAPER_STATS_BUCKETS; i++)
+    {
+        printf(" %u", p->buckets[i]);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *prefix = argc > 1 ? argv[1] : "sim_frame";
+    ssd1680_sim_config_t sim_config = ssd1680_sim_default_config();
+
+    sim_config.frame_prefix = strcmp(prefix, "-") == 0 ? NULL : prefix;
+    sim_config.write_png = sim_config.frame_prefix != NULL;
+
+    ssd1680_sim_t *sim = ssd1680_sim_new(&sim_config);
+    weact_epaper_host_sink_t sink = ssd1680_sim_sink(sim);
+    weact_epaper_config_t config = {
+        .transport = weact_epaper_transport_new_host(&sink),
+    };
+    weact_epaper_t dev;
+    int64_t t0;
+
+    if (sim == NULL || config.transport == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    t0 = weact_epaper_host_now_us();
+    if (!weact_epaper_init(&dev, &config))
+    {
+        fprintf(stderr, "weact_epaper_init failed\n");
+        return 1;
+    }
+    print_stats("init", ssd1680_sim_stats(sim), weact_epaper_host_now_us() - t0);
+
+    // Full refresh
+    ssd1680_sim_reset_stats(sim);
+    t0 = weact_epaper_host_now_us();
+    weact_epaper_draw_rectangle(&dev, 4, 4, WEACT_EPAPER_WIDTH - 5, WEACT_EPAPER_HEIGHT - 5, false);
+    weact_epaper_draw_rectangle(&dev, 20, 20, 60, 60, true);
+    weact_epaper_display_frame(&dev);
+    print_stats("frame", ssd1680_sim_stats(sim), weact_epaper_host_now_us() - t0);
+
+    // Differential update against the frame just shown
+    uint8_t *previous = malloc(WEACT_EPAPER_BUFFER_SIZE);
+    if (previous != NULL)
+    {
+        memcpy(previous, dev.framebuffer, WEACT_EPAPER_BUFFER_SIZE);
+        ssd1680_sim_reset_stats(sim);
+        t0 = weact_epaper_host_now_us();
+        weact_epaper_draw_rectangle(&dev, 70, 100, 110, 140, true);
+        weact_epaper_display_diff(&dev, previous);
+        print_stats("diff", ssd1680_sim_stats(sim), weact_epaper_host_now_us() - t0);
+        free(previous);
+    }
+
+    // Clear
+    ssd1680_sim_reset_stats(sim);
+    t0 = weact_epaper_host_now_us();
+    weact_epaper_clear_screen(&dev);
+    print_stats("clear", ssd1680_sim_stats(sim), weact_epaper_host_now_us() - t0);
+
+    // The model must agree with the framebuffer: all white after the clear
+    int black = 0;
+    for (int y = 0; y < WEACT_EPAPER_HEIGHT; y++)
+    {
+        for (int x = 0; x < WEACT_EPAPER_WIDTH; x++)
+        {
+            black += ssd1680_sim_ram_bit(sim, 0, x, y) == 0;
+        }
+    }
+    printf("black pixels in BW RAM after clear: %d\n", black);
+
+    weact_epaper_stats_t stats;
+    weact_epaper_get_stats(&dev, &stats);
+    printf("\ndriver: %llu SPI bytes in %u transactions\n", (unsigned long long)stats.spi_bytes,
+           stats.spi_transactions);
+    print_phase("upload", &stats.upload);
+    print_phase("activate", &stats.activate);
+    print_phase("busy", &stats.busy);
+    print_phase("update", &stats.update);
+
+    weact_epaper_deinit(&dev);
+    ssd1680_sim_delete(sim);
+    return black == 0 ? 0 : 1;
+}
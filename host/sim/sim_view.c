@@ -0,0 +1,216 @@
+/**
+ * @file sim_view.c
+ * @brief Live terminal view of the model's shared image
+ *
+ * Maps the file a model writes with config.shm_path (ui_render -m,
+ * trace_replay -m) read-only and redraws the terminal after every refresh:
+ * two panel rows per text row with 24-bit color half blocks, and a status
+ * line with the generation, refresh mode and dirty rectangle. The image is
+ * read straight from the mapping under the header's sequence lock; a frame
+ * that raced a refresh is dropped and read again.
+ *
+ * Usage: sim_view [-l] [-1] file
+ *
+ *   -l  Landscape, as lvgl_weact_epaper shows it (250 x 122)
+ *   -1  Print the current image once and exit
+ */
+
+#include "ssd1680_sim.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define POLL_US 20000
+
+static const char *const s_modes[] = {"none", "full", "partial", "lut"};
+
+typedef struct {
+    const ssd1680_sim_shm_header_t *h;
+    const uint8_t *image;
+    bool landscape;
+    char *out;
+    size_t len;
+    int fg; // Last colors sent (packed RGB, -1 = none)
+    int bg;
+} view_t;
+
+// Display pixel, white outside the image (odd height)
+static const uint8_t *pixel(const view_t *v, int x, int y)
+{
+    static const uint8_t white[3] = {0xFF, 0xFF, 0xFF};
+    int w = v->landscape ? v->h->height : v->h->width;
+    int h = v->landscape ? v->h->width : v->h->height;
+
+    if (x >= w || y >= h)
+    {
+        return white;
+    }
+    if (v->landscape)
+    {
+        // Inverse of the landscape mapping in lvgl_flush_cb()
+        int panel_x = y;
+        int panel_y = v->h->height - 1 - x;
+        return v->image + (size_t)panel_y * v->h->stride + (size_t)panel_x * 3;
+    }
+    return v->image + (size_t)y * v->h->stride + (size_t)x * 3;
+}
+
+static void put_color(view_t *v, int layer, const uint8_t *px)
+{
+    int rgb = px[0] << 16 | px[1] << 8 | px[2];
+    int *last = layer == 38 ? &v->fg : &v->bg;
+
+    if (*last != rgb)
+    {
+        v->len += (size_t)sprintf(v->out + v->len, "\x1b[%d;2;%d;%d;%dm", layer, px[0], px[1], px[2]);
+        *last = rgb;
+    }
+}
+
+// Terminal text for the current image, read from the mapping
+static void render(view_t *v)
+{
+    const ssd1680_sim_shm_header_t *h = v->h;
+    int w = v->landscape ? h->height : h->width;
+    int rows = ((v->landscape ? h->width : h->height) + 1) / 2;
+    unsigned mode = h->mode < sizeof(s_modes) / sizeof(s_modes[0]) ? h->mode : 0;
+
+    v->len = (size_t)sprintf(v->out, "\x1b[H\x1b[0mgeneration %u  %-7s  dirty ", h->generation, s_modes[mode]);
+    if (h->dirty_x1 <= h->dirty_x2)
+    {
+        v->len += (size_t)sprintf(v->out + v->len, "%d,%d..%d,%d", h->dirty_x1, h->dirty_y1, h->dirty_x2,
+                                  h->dirty_y2);
+    }
+    else
+    {
+        v->len += (size_t)sprintf(v->out + v->len, "none");
+    }
+    v->len += (size_t)sprintf(v->out + v->len, "  t %.3f s\x1b[K\n", h->time_us / 1e6);
+
+    for (int r = 0; r < rows; r++)
+    {
+        v->fg = -1;
+        v->bg = -1;
+        for (int x = 0; x < w; x++)
+        {
+            put_color(v, 38, pixel(v, x, 2 * r));
+            put_color(v, 48, pixel(v, x, 2 * r + 1));
+            memcpy(v->out + v->len, "\xe2\x96\x80", 3); // U+2580 upper half block
+            v->len += 3;
+        }
+        v->len += (size_t)sprintf(v->out + v->len, "\x1b[0m\n");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool landscape = false;
+    bool once = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "l1")) != -1)
+    {
+        switch (opt)
+        {
+        case 'l':
+            landscape = true;
+            break;
+        case '1':
+            once = true;
+            break;
+        default:
+            goto usage;
+        }
+    }
+    if (optind + 1 != argc)
+    {
+        goto usage;
+    }
+
+    const char *path = argv[optind];
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        perror(path);
+        return 1;
+    }
+    if ((size_t)st.st_size < sizeof(ssd1680_sim_shm_header_t))
+    {
+        fprintf(stderr, "%s: too small\n", path);
+        return 1;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        perror(path);
+        return 1;
+    }
+
+    ssd1680_sim_shm_header_t *h = map;
+    if (h->magic != SSD1680_SIM_SHM_MAGIC || h->version != SSD1680_SIM_SHM_VERSION ||
+        (size_t)h->header_size + (size_t)h->height * h->stride > (size_t)st.st_size)
+    {
+        fprintf(stderr, "%s: not a shared panel image\n", path);
+        return 1;
+    }
+
+    // Worst case: both colors change at every cell
+    size_t cells = (size_t)h->width * ((h->height + 1) / 2 + 1);
+    view_t v = {
+        .h = h,
+        .image = (const uint8_t *)map + h->header_size,
+        .landscape = landscape,
+        .out = malloc(cells * 48 + (size_t)(h->width + h->height) * 8 + 256),
+    };
+    if (v.out == NULL)
+    {
+        return 1;
+    }
+
+    if (!once)
+    {
+        printf("\x1b[2J");
+    }
+
+    uint32_t shown = 1; // Odd: never a published value
+    for (;;)
+    {
+        uint32_t seq = atomic_load_explicit(&h->seq, memory_order_acquire);
+        if ((seq & 1) || seq == shown)
+        {
+            usleep(POLL_US);
+            continue;
+        }
+
+        render(&v);
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&h->seq, memory_order_relaxed) != seq)
+        {
+            continue; // A refresh was written meanwhile
+        }
+
+        fwrite(v.out, 1, v.len, stdout);
+        fflush(stdout);
+        shown = seq;
+        if (once)
+        {
+            break;
+        }
+    }
+
+    free(v.out);
+    munmap(map, (size_t)st.st_size);
+    return 0;
+
+usage:
+    fprintf(stderr, "usage: %s [-l] [-1] file\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,1092 @@
+/**
+ * @file ssd1680_sim.c
+ * @brief SSD1680 controller model
+ */
+
+#include "ssd1680_sim.h"
+#include "weact_epaper_2in13.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Data Entry Mode bits
+#define ENTRY_X_INC   (1 << 0)
+#define ENTRY_Y_INC   (1 << 1)
+#define ENTRY_Y_FIRST (1 << 2)
+
+// Display Update Control 2 bits
+#define SEQ_CLOCK_ON   (1 << 7)
+#define SEQ_ANALOG_ON  (1 << 6)
+#define SEQ_LOAD_TEMP  (1 << 5)
+#define SEQ_LOAD_LUT   (1 << 4)
+#define SEQ_MODE_2     (1 << 3)
+#define SEQ_DISPLAY    (1 << 2)
+#define SEQ_ANALOG_OFF (1 << 1)
+#define SEQ_CLOCK_OFF  (1 << 0)
+
+#define LUT_SIZE 153
+#define PARAM_MAX 160
+
+#define IMAGE_STRIDE (SSD1680_SIM_PANEL_WIDTH * 3)
+#define IMAGE_SIZE   (SSD1680_SIM_PANEL_HEIGHT * IMAGE_STRIDE)
+
+_Static_assert(sizeof(ssd1680_sim_shm_header_t) <= SSD1680_SIM_SHM_HEADER_SIZE, "shared image header too large");
+
+struct ssd1680_sim {
+    ssd1680_sim_config_t config;
+    pthread_mutex_t lock;
+
+    uint8_t ram[2][SSD1680_SIM_RAM_HEIGHT][SSD1680_SIM_RAM_WIDTH_BYTES];
+    uint8_t (*image)[SSD1680_SIM_PANEL_WIDTH][3]; // own_image, or the shared mapping
+    uint8_t own_image[SSD1680_SIM_PANEL_HEIGHT][SSD1680_SIM_PANEL_WIDTH][3];
+
+    // Shared image file (config.shm_path)
+    ssd1680_sim_shm_header_t *shm;
+    size_t shm_size;
+
+    // Pixels changed by the refresh being rendered
+    int dirty_x1, dirty_y1, dirty_x2, dirty_y2;
+
+    // Command being received
+    int cmd;            // -1 = none
+    uint8_t param[PARAM_MAX];
+    size_t param_len;
+    int ram_bank;       // 0 = BW, 1 = RED, -1 = not writing RAM
+
+    // Registers
+    uint16_t mux;       // Gate lines (Driver Output Control + 1)
+    bool gate_tb;       // Scan G(mux-1) -> G0
+    uint8_t entry;
+    uint8_t x_start, x_end;
+    uint16_t y_start, y_end;
+    uint8_t x_cnt;
+    uint16_t y_cnt;
+    uint8_t ctrl1[2];
+    uint8_t ctrl2;
+    uint8_t border;
+    uint8_t temp_control;
+    int16_t temperature_x16; // Temperature register
+    uint8_t lut[LUT_SIZE];
+    bool custom_lut;    // LUT register holds a 0x32 upload, not the OTP waveform
+
+    // Power
+    bool clock_on;
+    bool analog_on;
+    int deep_sleep;     // 0, 1 or 2
+    bool in_reset;
+    int64_t busy_until_us;
+
+    unsigned frame_index;   // Image file numbering (not reset with the stats)
+
+    ssd1680_sim_stats_t stats;
+};
+
+ssd1680_sim_config_t ssd1680_sim_default_config(void)
+{
+    ssd1680_sim_config_t config = {
+        .timing = {
+            .hw_reset_us = 1000,
+            .sw_reset_us = 10000,
+            .auto_write_us = 10000,
+            .power_on_us = 65000,
+            .power_off_us = 25000,
+            .temp_load_us = 5000,
+            .lut_load_us = 5000,
+            .full_us = 1900000,
+            .partial_us = 300000,
+            .lut_frame_us = 10000,
+            .cold_percent_per_c = 4, // About twice as long at 0 °C
+        },
+        .temperature_x16 = 25 * 16,
+        .tricolor = false,
+        .frame_prefix = NULL,
+        .write_png = false,
+        .shm_path = NULL,
+        .now_us = NULL,
+        .clock_ctx = NULL,
+    };
+    return config;
+}
+
+static int64_t sim_now(ssd1680_sim_t *sim)
+{
+    if (sim->config.now_us != NULL)
+    {
+        return sim->config.now_us(sim->config.clock_ctx);
+    }
+    return weact_epaper_host_now_us();
+}
+
+static void sim_busy_for(ssd1680_sim_t *sim, uint32_t us)
+{
+    int64_t now = sim_now(sim);
+    int64_t start = sim->busy_until_us > now ? sim->busy_until_us : now;
+
+    sim->busy_until_us = start + us;
+    sim->stats.busy_us += us;
+    sim->stats.last_busy_us = us;
+}
+
+// Registers after power-on / hardware reset (RAM is kept)
+static void sim_reset_registers(ssd1680_sim_t *sim)
+{
+    sim->cmd = -1;
+    sim->param_len = 0;
+    sim->ram_bank = -1;
+    sim->mux = SSD1680_SIM_RAM_HEIGHT;
+    sim->gate_tb = false;
+    sim->entry = ENTRY_X_INC | ENTRY_Y_INC;
+    sim->x_start = 0;
+    sim->x_end = SSD1680_SIM_RAM_WIDTH_BYTES - 1;
+    sim->y_start = 0;
+    sim->y_end = SSD1680_SIM_RAM_HEIGHT - 1;
+    sim->x_cnt = 0;
+    sim->y_cnt = 0;
+    sim->ctrl1[0] = 0x00;
+    sim->ctrl1[1] = 0x00;
+    sim->ctrl2 = 0xFF;
+    sim->border = 0xC0;
+    sim->temp_control = 0x48;
+    sim->custom_lut = false;
+    sim->clock_on = false;
+    sim->analog_on = false;
+}
+
+// =============================================================================
+// RAM access
+// =============================================================================
+
+static void sim_advance_counter(ssd1680_sim_t *sim)
+{
+    bool x_inc = sim->entry & ENTRY_X_INC;
+    bool y_inc = sim->entry & ENTRY_Y_INC;
+    bool x_wrapped = false;
+    bool y_wrapped = false;
+
+    // Counters wrap from the window end back to its start
+    if (sim->entry & ENTRY_Y_FIRST)
+    {
+        if (sim->y_cnt == sim->y_end)
+        {
+            sim->y_cnt = sim->y_start;
+            y_wrapped = true;
+        }
+        else
+        {
+            sim->y_cnt = (uint16_t)(y_inc ? sim->y_cnt + 1 : sim->y_cnt - 1);
+        }
+
+        if (y_wrapped)
+        {
+            sim->x_cnt = sim->x_cnt == sim->x_end ? sim->x_start
+                                                  : (uint8_t)(x_inc ? sim->x_cnt + 1 : sim->x_cnt - 1);
+        }
+        return;
+    }
+
+    if (sim->x_cnt == sim->x_end)
+    {
+        sim->x_cnt = sim->x_start;
+        x_wrapped = true;
+    }
+    else
+    {
+        sim->x_cnt = (uint8_t)(x_inc ? sim->x_cnt + 1 : sim->x_cnt - 1);
+    }
+
+    if (x_wrapped)
+    {
+        sim->y_cnt = sim->y_cnt == sim->y_end ? sim->y_start
+                                              : (uint16_t)(y_inc ? sim->y_cnt + 1 : sim->y_cnt - 1);
+    }
+}
+
+static void sim_ram_write(ssd1680_sim_t *sim, uint8_t value)
+{
+    if (sim->x_cnt < SSD1680_SIM_RAM_WIDTH_BYTES && sim->y_cnt < SSD1680_SIM_RAM_HEIGHT)
+    {
+        sim->ram[sim->ram_bank][sim->y_cnt][sim->x_cnt] = value;
+    }
+    sim->stats.ram_bytes[sim->ram_bank]++;
+    sim_advance_counter(sim);
+}
+
+int ssd1680_sim_ram_bit(ssd1680_sim_t *sim, int bank, int x, int y)
+{
+    return (sim->ram[bank][y][x / 8] >> (7 - (x % 8))) & 1;
+}
+
+// RAM bit as the display sees it, after the Update Control 1 option
+static int sim_read_bit(ssd1680_sim_t *sim, int bank, int x, int y)
+{
+    uint8_t option = bank == 0 ? (sim->ctrl1[0] & 0x0F) : (sim->ctrl1[0] >> 4);
+    int bit = ssd1680_sim_ram_bit(sim, bank, x, y);
+
+    if (option & 0x4)
+    {
+        return 0; // Bypass as 0
+    }
+    if (option & 0x8)
+    {
+        return !bit;
+    }
+    return bit;
+}
+
+/**
+ * Auto write pattern (0x46/0x47): A[7] start value, A[6:4] step height,
+ * A[2:0] step width. The value toggles every step in both directions.
+ */
+static void sim_auto_write(ssd1680_sim_t *sim, int bank, uint8_t a)
+{
+    static const uint16_t heights[] = {8, 16, 32, 64, 128, 256, 296, 296};
+    static const uint16_t widths[] = {8, 16, 32, 64, 128, 176, 176, 176};
+    int start = (a >> 7) & 1;
+    int step_h = heights[(a >> 4) & 7];
+    int step_w = widths[a & 7];
+
+    for (int y = 0; y < SSD1680_SIM_RAM_HEIGHT; y++)
+    {
+        for (int xb = 0; xb < SSD1680_SIM_RAM_WIDTH_BYTES; xb++)
+        {
+            uint8_t byte = 0;
+            for (int b = 0; b < 8; b++)
+            {
+                int x = xb * 8 + b;
+                int v = start ^ (((x / step_w) + (y / step_h)) & 1);
+                byte |= (uint8_t)(v << (7 - b));
+            }
+            sim->ram[bank][y][xb] = byte;
+        }
+    }
+}
+
+// =============================================================================
+// Display update
+// =============================================================================
+
+static void sim_set_pixel(ssd1680_sim_t *sim, int x, int y, uint8_t r, uint8_t g, uint8_t b)
+{
+    uint8_t *px = sim->image[y][x];
+
+    if (px[0] == r && px[1] == g && px[2] == b)
+    {
+        return;
+    }
+    sim->dirty_x1 = x < sim->dirty_x1 ? x : sim->dirty_x1;
+    sim->dirty_y1 = y < sim->dirty_y1 ? y : sim->dirty_y1;
+    sim->dirty_x2 = x > sim->dirty_x2 ? x : sim->dirty_x2;
+    sim->dirty_y2 = y > sim->dirty_y2 ? y : sim->dirty_y2;
+
+    sim->image[y][x][0] = r;
+    sim->image[y][x][1] = g;
+    sim->image[y][x][2] = b;
+}
+
+/**
+ * Net drive of LUTm in frames: VSH1/VSH2 phases push towards black,
+ * VSL phases towards white. Also returns the waveform length in frames.
+ */
+static int32_t sim_lut_drive(const uint8_t *lut, int m, uint32_t *frames)
+{
+    int32_t net = 0;
+    uint32_t total = 0;
+
+    for (int n = 0; n < 12; n++)
+    {
+        const uint8_t *tp = &lut[60 + n * 7];
+        uint8_t vs = lut[m * 12 + n];
+        uint32_t repeat = (uint32_t)tp[6] + 1;
+        const uint8_t phase_tp[4] = {tp[0], tp[1], tp[3], tp[4]};
+
+        for (int p = 0; p < 4; p++)
+        {
+            int level = (vs >> (6 - 2 * p)) & 3;
+            int32_t d = (int32_t)(phase_tp[p] * repeat);
+
+            total += phase_tp[p] * repeat;
+            if (level == 1 || level == 3)
+            {
+                net += d;
+            }
+            else if (level == 2)
+            {
+                net -= d;
+            }
+        }
+    }
+
+    if (frames != NULL)
+    {
+        *frames = total;
+    }
+    return net;
+}
+
+static uint32_t sim_render_lut(ssd1680_sim_t *sim)
+{
+    int32_t net[4];
+    int32_t lo = 0;
+    int32_t hi = 0;
+    uint32_t frames = 0;
+    uint8_t gray[4];
+
+    for (int m = 0; m < 4; m++)
+    {
+        uint32_t f;
+        net[m] = sim_lut_drive(sim->lut, m, &f);
+        frames = f > frames ? f : frames;
+        lo = m == 0 || net[m] < lo ? net[m] : lo;
+        hi = m == 0 || net[m] > hi ? net[m] : hi;
+    }
+
+    // Most black drive -> 0, most white drive -> 255
+    for (int m = 0; m < 4; m++)
+    {
+        gray[m] = hi == lo ? 255 : (uint8_t)(255 * (hi - net[m]) / (hi - lo));
+    }
+
+    for (int y = 0; y < SSD1680_SIM_PANEL_HEIGHT; y++)
+    {
+        int row = sim->gate_tb ? sim->mux - 1 - y : y;
+        if (row < 0)
+        {
+            continue;
+        }
+        for (int x = 0; x < SSD1680_SIM_PANEL_WIDTH; x++)
+        {
+            int m = sim_read_bit(sim, 1, x, row) << 1 | sim_read_bit(sim, 0, x, row);
+            sim_set_pixel(sim, x, y, gray[m], gray[m], gray[m]);
+        }
+    }
+
+    return frames;
+}
+
+static void sim_render_otp(ssd1680_sim_t *sim, bool mode_2)
+{
+    for (int y = 0; y < SSD1680_SIM_PANEL_HEIGHT; y++)
+    {
+        int row = sim->gate_tb ? sim->mux - 1 - y : y;
+        if (row < 0)
+        {
+            continue;
+        }
+        for (int x = 0; x < SSD1680_SIM_PANEL_WIDTH; x++)
+        {
+            int bw = sim_read_bit(sim, 0, x, row);
+            int red = sim_read_bit(sim, 1, x, row);
+
+            // Mode 2: RED RAM is the previous image, unchanged pixels are not driven
+            if (mode_2 && bw == red)
+            {
+                continue;
+            }
+            if (!mode_2 && sim->config.tricolor && red)
+            {
+                sim_set_pixel(sim, x, y, 0xFF, 0x00, 0x00);
+                continue;
+            }
+
+            uint8_t v = bw ? 0xFF : 0x00;
+            sim_set_pixel(sim, x, y, v, v, v);
+        }
+    }
+}
+
+static void sim_write_frame(ssd1680_sim_t *sim)
+{
+    char path[512];
+    unsigned n = ++sim->frame_index;
+
+    if (sim->config.frame_prefix == NULL)
+    {
+        return;
+    }
+
+    snprintf(path, sizeof(path), "%s_%04u.pbm", sim->config.frame_prefix, n);
+    if (ssd1680_sim_write_pbm(sim, path))
+    {
+        sim->stats.frames_written++;
+    }
+
+    if (sim->config.write_png)
+    {
+        snprintf(path, sizeof(path), "%s_%04u.png", sim->config.frame_prefix, n);
+        if (ssd1680_sim_write_png(sim, path))
+        {
+            sim->stats.frames_written++;
+        }
+    }
+}
+
+// A refresh starts writing the image: shared readers retry until sim_shm_end()
+static void sim_shm_begin(ssd1680_sim_t *sim)
+{
+    sim->dirty_x1 = SSD1680_SIM_PANEL_WIDTH;
+    sim->dirty_y1 = SSD1680_SIM_PANEL_HEIGHT;
+    sim->dirty_x2 = -1;
+    sim->dirty_y2 = -1;
+
+    if (sim->shm == NULL)
+    {
+        return;
+    }
+    uint32_t seq = atomic_load_explicit(&sim->shm->seq, memory_order_relaxed);
+    atomic_store_explicit(&sim->shm->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static void sim_shm_end(ssd1680_sim_t *sim, ssd1680_sim_refresh_t mode)
+{
+    ssd1680_sim_shm_header_t *h = sim->shm;
+
+    if (h == NULL)
+    {
+        return;
+    }
+    if (mode != SSD1680_SIM_REFRESH_NONE)
+    {
+        h->generation++;
+    }
+    h->time_us = sim_now(sim);
+    h->dirty_x1 = (int16_t)sim->dirty_x1;
+    h->dirty_y1 = (int16_t)sim->dirty_y1;
+    h->dirty_x2 = (int16_t)sim->dirty_x2;
+    h->dirty_y2 = (int16_t)sim->dirty_y2;
+    h->mode = (uint8_t)mode;
+    atomic_store_explicit(&h->seq, atomic_load_explicit(&h->seq, memory_order_relaxed) + 1, memory_order_release);
+}
+
+static bool sim_shm_open(ssd1680_sim_t *sim, const char *path)
+{
+    size_t size = SSD1680_SIM_SHM_HEADER_SIZE + IMAGE_SIZE;
+    // No O_TRUNC: a viewer still mapping the file from an earlier run must
+    // not see it shrink (SIGBUS)
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+
+    if (fd < 0 || ftruncate(fd, (off_t)size) != 0)
+    {
+        perror(path);
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return false;
+    }
+
+    // The mapping stays valid after close
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        perror(path);
+        return false;
+    }
+
+    ssd1680_sim_shm_header_t *h = map;
+    h->magic = SSD1680_SIM_SHM_MAGIC;
+    h->version = SSD1680_SIM_SHM_VERSION;
+    h->header_size = SSD1680_SIM_SHM_HEADER_SIZE;
+    h->width = SSD1680_SIM_PANEL_WIDTH;
+    h->height = SSD1680_SIM_PANEL_HEIGHT;
+    h->stride = IMAGE_STRIDE;
+    h->generation = 0;
+
+    // A writer that died mid-refresh left seq odd
+    uint32_t seq = atomic_load_explicit(&h->seq, memory_order_relaxed);
+    atomic_store_explicit(&h->seq, seq + (seq & 1), memory_order_release);
+
+    sim->shm = h;
+    sim->shm_size = size;
+    sim->image = (void *)((uint8_t *)map + SSD1680_SIM_SHM_HEADER_SIZE);
+    return true;
+}
+
+// OTP waveform duration at the temperature in the register
+static uint32_t sim_otp_duration(ssd1680_sim_t *sim, uint32_t us)
+{
+    int32_t below_x16 = 25 * 16 - sim->temperature_x16;
+
+    if (below_x16 <= 0)
+    {
+        return us;
+    }
+    return (uint32_t)(us + (uint64_t)us * sim->config.timing.cold_percent_per_c * (uint32_t)below_x16 / (100 * 16));
+}
+
+static void sim_activate(ssd1680_sim_t *sim)
+{
+    const ssd1680_sim_timing_t *t = &sim->config.timing;
+    uint8_t seq = sim->ctrl2;
+    uint32_t us = 0;
+
+    sim->stats.activations++;
+
+    if (seq & SEQ_CLOCK_ON)
+    {
+        sim->clock_on = true;
+    }
+    if ((seq & SEQ_ANALOG_ON) && !sim->analog_on)
+    {
+        sim->analog_on = true;
+        us += t->power_on_us;
+    }
+    if (seq & SEQ_LOAD_TEMP)
+    {
+        // Internal sensor (0x80 selects it), an external value stays as written
+        if (sim->temp_control == 0x80)
+        {
+            sim->temperature_x16 = sim->config.temperature_x16;
+        }
+        us += t->temp_load_us;
+    }
+    if (seq & SEQ_LOAD_LUT)
+    {
+        sim->custom_lut = false;
+        us += t->lut_load_us;
+    }
+    if (seq & SEQ_DISPLAY)
+    {
+        ssd1680_sim_refresh_t mode;
+
+        sim->stats.refreshes++;
+        sim_shm_begin(sim);
+        if (sim->custom_lut)
+        {
+            uint32_t frames = sim_render_lut(sim);
+            us += frames * t->lut_frame_us;
+            sim->stats.lut_refreshes++;
+            mode = SSD1680_SIM_REFRESH_LUT;
+        }
+        else
+        {
+            bool mode_2 = (seq & SEQ_MODE_2) != 0;
+            sim_render_otp(sim, mode_2);
+            us += sim_otp_duration(sim, mode_2 ? t->partial_us : t->full_us);
+            if (mode_2)
+            {
+                sim->stats.partial_refreshes++;
+            }
+            else
+            {
+                sim->stats.full_refreshes++;
+            }
+            mode = mode_2 ? SSD1680_SIM_REFRESH_PARTIAL : SSD1680_SIM_REFRESH_FULL;
+        }
+        sim_shm_end(sim, mode);
+    }
+    if (seq & SEQ_ANALOG_OFF)
+    {
+        if (sim->analog_on)
+        {
+            us += t->power_off_us;
+        }
+        sim->analog_on = false;
+    }
+    if (seq & SEQ_CLOCK_OFF)
+    {
+        sim->clock_on = false;
+    }
+
+    sim_busy_for(sim, us);
+
+    if (seq & SEQ_DISPLAY)
+    {
+        sim_write_frame(sim);
+    }
+}
+
+// =============================================================================
+// Command decoding
+// =============================================================================
+
+// Called after each parameter byte; setters are idempotent
+static void sim_param(ssd1680_sim_t *sim, uint8_t value)
+{
+    const uint8_t *p = sim->param;
+    size_t n;
+
+    if (sim->param_len < PARAM_MAX)
+    {
+        sim->param[sim->param_len] = value;
+    }
+    n = ++sim->param_len;
+
+    switch (sim->cmd)
+    {
+    case WEACT_EPAPER_CMD_DRIVER_OUTPUT_CONTROL:
+        if (n == 2)
+        {
+            sim->mux = (uint16_t)((p[0] | (p[1] & 1) << 8) + 1);
+        }
+        else if (n == 3)
+        {
+            sim->gate_tb = p[2] & 0x01;
+        }
+        break;
+    case WEACT_EPAPER_CMD_DEEP_SLEEP_MODE:
+        if (value == 0x01 || value == 0x03)
+        {
+            sim->deep_sleep = value == 0x03 ? 2 : 1;
+            sim->analog_on = false;
+            sim->clock_on = false;
+            if (sim->deep_sleep == 2)
+            {
+                memset(sim->ram, 0x00, sizeof(sim->ram));
+            }
+        }
+        break;
+    case WEACT_EPAPER_CMD_DATA_ENTRY_MODE:
+        sim->entry = value & 0x07;
+        break;
+    case WEACT_EPAPER_CMD_TEMP_SENSOR_CONTROL:
+        sim->temp_control = value;
+        break;
+    case WEACT_EPAPER_CMD_TEMP_SENSOR_WRITE:
+        if (n == 2)
+        {
+            sim->temperature_x16 = (int16_t)((uint16_t)(p[0] << 8 | p[1])) >> 4;
+        }
+        break;
+    case WEACT_EPAPER_CMD_DISPLAY_UPDATE_CONTROL_1:
+        if (n <= 2)
+        {
+            sim->ctrl1[n - 1] = value;
+        }
+        break;
+    case WEACT_EPAPER_CMD_DISPLAY_UPDATE_CONTROL_2:
+        sim->ctrl2 = value;
+        break;
+    case WEACT_EPAPER_CMD_WRITE_LUT_REGISTER:
+        if (n <= LUT_SIZE)
+        {
+            sim->lut[n - 1] = value;
+            sim->custom_lut = true;
+        }
+        break;
+    case WEACT_EPAPER_CMD_BORDER_WAVEFORM_CONTROL:
+        sim->border = value;
+        break;
+    case WEACT_EPAPER_CMD_SET_RAM_X_ADDRESS_START_END:
+        if (n == 1)
+        {
+            sim->x_start = value & 0x3F;
+        }
+        else if (n == 2)
+        {
+            sim->x_end = value & 0x3F;
+        }
+        break;
+    case WEACT_EPAPER_CMD_SET_RAM_Y_ADDRESS_START_END:
+        if (n == 2)
+        {
+            sim->y_start = (uint16_t)(p[0] | (p[1] & 1) << 8);
+        }
+        else if (n == 4)
+        {
+            sim->y_end = (uint16_t)(p[2] | (p[3] & 1) << 8);
+        }
+        break;
+    case WEACT_EPAPER_CMD_AUTO_WRITE_RED_PATTERN:
+    case WEACT_EPAPER_CMD_AUTO_WRITE_BW_PATTERN:
+        if (n == 1)
+        {
+            sim_auto_write(sim, sim->cmd == WEACT_EPAPER_CMD_AUTO_WRITE_RED_PATTERN ? 1 : 0, value);
+            sim_busy_for(sim, sim->config.timing.auto_write_us);
+        }
+        break;
+    case WEACT_EPAPER_CMD_SET_RAM_X_ADDRESS_COUNTER:
+        sim->x_cnt = value & 0x3F;
+        break;
+    case WEACT_EPAPER_CMD_SET_RAM_Y_ADDRESS_COUNTER:
+        if (n == 2)
+        {
+            sim->y_cnt = (uint16_t)(p[0] | (p[1] & 1) << 8);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void ssd1680_sim_command(ssd1680_sim_t *sim, uint8_t cmd)
+{
+    pthread_mutex_lock(&sim->lock);
+
+    sim->stats.transactions++;
+    sim->stats.commands++;
+
+    // Deep sleep: only a hardware reset gets through
+    if (sim->deep_sleep != 0 || sim->in_reset)
+    {
+        pthread_mutex_unlock(&sim->lock);
+        return;
+    }
+
+    sim->cmd = cmd;
+    sim->param_len = 0;
+    sim->ram_bank = -1;
+
+    switch (cmd)
+    {
+    case WEACT_EPAPER_CMD_SW_RESET:
+        sim_reset_registers(sim);
+        sim->stats.sw_resets++;
+        sim_busy_for(sim, sim->config.timing.sw_reset_us);
+        break;
+    case WEACT_EPAPER_CMD_MASTER_ACTIVATION:
+        sim_activate(sim);
+        break;
+    case WEACT_EPAPER_CMD_WRITE_RAM_BW:
+        sim->ram_bank = 0;
+        break;
+    case WEACT_EPAPER_CMD_WRITE_RAM_RED:
+        sim->ram_bank = 1;
+        break;
+    default:
+        break;
+    }
+
+    pthread_mutex_unlock(&sim->lock);
+}
+
+void ssd1680_sim_data(ssd1680_sim_t *sim, const uint8_t *data, size_t len)
+{
+    pthread_mutex_lock(&sim->lock);
+
+    sim->stats.transactions++;
+    sim->stats.data_bytes += len;
+
+    if (sim->deep_sleep != 0 || sim->in_reset || sim->cmd < 0)
+    {
+        pthread_mutex_unlock(&sim->lock);
+        return;
+    }
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (sim->ram_bank >= 0)
+        {
+            sim_ram_write(sim, data[i]);
+        }
+        else
+        {
+            sim_param(sim, data[i]);
+        }
+    }
+
+    pthread_mutex_unlock(&sim->lock);
+}
+
+void ssd1680_sim_rst(ssd1680_sim_t *sim, int level)
+{
+    pthread_mutex_lock(&sim->lock);
+
+    if (level == 0)
+    {
+        sim->in_reset = true;
+    }
+    else if (sim->in_reset)
+    {
+        sim->in_reset = false;
+        sim->deep_sleep = 0;
+        sim->busy_until_us = 0;
+        sim_reset_registers(sim);
+        sim->stats.hw_resets++;
+        sim_busy_for(sim, sim->config.timing.hw_reset_us);
+    }
+
+    pthread_mutex_unlock(&sim->lock);
+}
+
+bool ssd1680_sim_busy(ssd1680_sim_t *sim)
+{
+    pthread_mutex_lock(&sim->lock);
+    bool busy = sim->deep_sleep != 0 || sim->in_reset || sim_now(sim) < sim->busy_until_us;
+    pthread_mutex_unlock(&sim->lock);
+    return busy;
+}
+
+// =============================================================================
+// Sink glue
+// =============================================================================
+
+static void sink_command(void *ctx, uint8_t cmd)
+{
+    ssd1680_sim_command(ctx, cmd);
+}
+
+static void sink_data(void *ctx, const uint8_t *data, size_t len)
+{
+    ssd1680_sim_data(ctx, data, len);
+}
+
+static void sink_read(void *ctx, uint8_t cmd, uint8_t *data, size_t len)
+{
+    ssd1680_sim_t *sim = ctx;
+
+    pthread_mutex_lock(&sim->lock);
+    sim->stats.transactions += 2;
+    sim->stats.commands++;
+
+    memset(data, 0xFF, len);
+    if (cmd == WEACT_EPAPER_CMD_TEMP_SENSOR_READ && sim->deep_sleep == 0 && len >= 2)
+    {
+        uint16_t raw = (uint16_t)((uint16_t)sim->temperature_x16 << 4);
+        data[0] = (uint8_t)(raw >> 8);
+        data[1] = (uint8_t)raw;
+    }
+    pthread_mutex_unlock(&sim->lock);
+}
+
+static void sink_rst(void *ctx, int level)
+{
+    ssd1680_sim_rst(ctx, level);
+}
+
+static int sink_busy(void *ctx)
+{
+    return ssd1680_sim_busy(ctx) ? 1 : 0;
+}
+
+weact_epaper_host_sink_t ssd1680_sim_sink(ssd1680_sim_t *sim)
+{
+    weact_epaper_host_sink_t sink = {
+        .on_command = sink_command,
+        .on_data = sink_data,
+        .on_read = sink_read,
+        .on_rst = sink_rst,
+        .busy = sink_busy,
+        .ctx = sim,
+    };
+    return sink;
+}
+
+// =============================================================================
+// Lifecycle and output
+// =============================================================================
+
+ssd1680_sim_t *ssd1680_sim_new(const ssd1680_sim_config_t *config)
+{
+    ssd1680_sim_t *sim = calloc(1, sizeof(*sim));
+    if (sim == NULL)
+    {
+        return NULL;
+    }
+
+    sim->config = config != NULL ? *config : ssd1680_sim_default_config();
+    sim->image = sim->own_image;
+    if (sim->config.shm_path != NULL && !sim_shm_open(sim, sim->config.shm_path))
+    {
+        free(sim);
+        return NULL;
+    }
+    pthread_mutex_init(&sim->lock, NULL);
+    sim_reset_registers(sim);
+    sim->temperature_x16 = sim->config.temperature_x16;
+
+    // Power-on RAM content is undefined; the panel starts white
+    memset(sim->ram, 0xFF, sizeof(sim->ram));
+    sim_shm_begin(sim);
+    memset(sim->image, 0xFF, IMAGE_SIZE);
+    sim_shm_end(sim, SSD1680_SIM_REFRESH_NONE);
+
+    return sim;
+}
+
+void ssd1680_sim_delete(ssd1680_sim_t *sim)
+{
+    if (sim == NULL)
+    {
+        return;
+    }
+    pthread_mutex_destroy(&sim->lock);
+    if (sim->shm != NULL)
+    {
+        // The file stays, a viewer can still show the last image
+        munmap(sim->shm, sim->shm_size);
+    }
+    free(sim);
+}
+
+void ssd1680_sim_set_temperature(ssd1680_sim_t *sim, int16_t temperature_x16)
+{
+    pthread_mutex_lock(&sim->lock);
+    sim->config.temperature_x16 = temperature_x16;
+    pthread_mutex_unlock(&sim->lock);
+}
+
+const ssd1680_sim_stats_t *ssd1680_sim_stats(ssd1680_sim_t *sim)
+{
+    return &sim->stats;
+}
+
+void ssd1680_sim_reset_stats(ssd1680_sim_t *sim)
+{
+    pthread_mutex_lock(&sim->lock);
+    memset(&sim->stats, 0, sizeof(sim->stats));
+    pthread_mutex_unlock(&sim->lock);
+}
+
+const uint8_t *ssd1680_sim_image(ssd1680_sim_t *sim)
+{
+    return &sim->image[0][0][0];
+}
+
+bool ssd1680_sim_write_pbm(ssd1680_sim_t *sim, const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (f == NULL)
+    {
+        return false;
+    }
+
+    fprintf(f, "P4\n%d %d\n", SSD1680_SIM_PANEL_WIDTH, SSD1680_SIM_PANEL_HEIGHT);
+
+    // P4: 1 = black, rows padded to whole bytes
+    for (int y = 0; y < SSD1680_SIM_PANEL_HEIGHT; y++)
+    {
+        uint8_t row[(SSD1680_SIM_PANEL_WIDTH + 7) / 8] = {0};
+        for (int x = 0; x < SSD1680_SIM_PANEL_WIDTH; x++)
+        {
+            const uint8_t *px = sim->image[y][x];
+            int luma = (px[0] * 77 + px[1] * 150 + px[2] * 29) >> 8;
+            if (luma < 128)
+            {
+                row[x / 8] |= (uint8_t)(0x80 >> (x % 8));
+            }
+        }
+        fwrite(row, 1, sizeof(row), f);
+    }
+
+    return fclose(f) == 0;
+}
+
+// PNG with stored (uncompressed) deflate blocks: no zlib dependency
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t len)
+{
+    static uint32_t table[256];
+    if (table[1] == 0)
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+            {
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+    }
+
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static void put_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static void png_chunk(FILE *f, const char *type, const uint8_t *data, uint32_t len)
+{
+    uint8_t hdr[8];
+    uint8_t crc_buf[4];
+
+    put_be32(hdr, len);
+    memcpy(hdr + 4, type, 4);
+    fwrite(hdr, 1, 8, f);
+    fwrite(data, 1, len, f);
+
+    uint32_t crc = crc32_update(0, (const uint8_t *)type, 4);
+    crc = crc32_update(crc, data, len);
+    put_be32(crc_buf, crc);
+    fwrite(crc_buf, 1, 4, f);
+}
+
+bool ssd1680_sim_write_png(ssd1680_sim_t *sim, const char *path)
+{
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    const size_t row_len = 1 + SSD1680_SIM_PANEL_WIDTH * 3;
+    const size_t raw_len = row_len * SSD1680_SIM_PANEL_HEIGHT;
+
+    // Raw scanlines, filter type 0
+    uint8_t *raw = malloc(raw_len);
+    // zlib header + stored blocks (5 bytes per 65535) + adler32
+    size_t z_cap = 2 + raw_len + 5 * (raw_len / 65535 + 1) + 4;
+    uint8_t *z = malloc(z_cap);
+    FILE *f = fopen(path, "wb");
+
+    if (raw == NULL || z == NULL || f == NULL)
+    {
+        free(raw);
+        free(z);
+        if (f != NULL)
+        {
+            fclose(f);
+        }
+        return false;
+    }
+
+    for (int y = 0; y < SSD1680_SIM_PANEL_HEIGHT; y++)
+    {
+        raw[y * row_len] = 0;
+        memcpy(&raw[y * row_len + 1], sim->image[y], SSD1680_SIM_PANEL_WIDTH * 3);
+    }
+
+    size_t zn = 0;
+    uint32_t a = 1;
+    uint32_t b = 0;
+    z[zn++] = 0x78;
+    z[zn++] = 0x01;
+    for (size_t off = 0; off < raw_len;)
+    {
+        size_t n = raw_len - off > 65535 ? 65535 : raw_len - off;
+        z[zn++] = off + n == raw_len ? 1 : 0;
+        z[zn++] = (uint8_t)n;
+        z[zn++] = (uint8_t)(n >> 8);
+        z[zn++] = (uint8_t)~n;
+        z[zn++] = (uint8_t)(~n >> 8);
+        memcpy(&z[zn], &raw[off], n);
+        for (size_t i = 0; i < n; i++)
+        {
+            a = (a + raw[off + i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        zn += n;
+        off += n;
+    }
+    put_be32(&z[zn], b << 16 | a);
+    zn += 4;
+
+    uint8_t ihdr[13];
+    put_be32(ihdr, SSD1680_SIM_PANEL_WIDTH);
+    put_be32(ihdr + 4, SSD1680_SIM_PANEL_HEIGHT);
+    ihdr[8] = 8;  // Bit depth
+    ihdr[9] = 2;  // RGB
+    ihdr[10] = 0; // Deflate
+    ihdr[11] = 0; // Filter method
+    ihdr[12] = 0; // No interlace
+
+    fwrite(signature, 1, sizeof(signature), f);
+    png_chunk(f, "IHDR", ihdr, sizeof(ihdr));
+    png_chunk(f, "IDAT", z, (uint32_t)zn);
+    png_chunk(f, "IEND", NULL, 0);
+
+    free(raw);
+    free(z);
+    return fclose(f) == 0;
+}
@@ -0,0 +1,179 @@
+#ifndef SSD1680_SIM_H
+#define SSD1680_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "weact_epaper_host.h"
+
+/**
+ * @brief SSD1680 controller model (host only)
+ *
+ * Consumes the command/data stream of the host transport and keeps what the
+ * controller keeps: both RAM banks (176 x 296 bits), RAM windows and
+ * address counters, data entry mode, Display Update Control 1/2, the
+ * loaded LUT, temperature, analog power and deep sleep. Master activation
+ * runs the update sequence bit by bit, holds BUSY high for the modelled
+ * duration and, when the sequence drives the display, renders the visible
+ * 122 x 250 image:
+ *
+ * - OTP waveform, mode 1: BW RAM (red where RED RAM = 1 on tri-color)
+ * - OTP waveform, mode 2: only pixels whose BW and RED bits differ change
+ * - Custom LUT: each pixel's LUT0..LUT3 (RED << 1 | BW) is reduced to its
+ *   net drive (VSH = black, VSL = white) and mapped to a gray level
+ *
+ * Update Control 1 bypass/invert options apply while RAM is read, as on
+ * the chip.
+ */
+
+#define SSD1680_SIM_RAM_WIDTH_BYTES 22   // 176 sources
+#define SSD1680_SIM_RAM_HEIGHT      296  // 296 gates
+#define SSD1680_SIM_PANEL_WIDTH     122
+#define SSD1680_SIM_PANEL_HEIGHT    250
+
+/**
+ * @brief What the last refresh drove the display with
+ */
+typedef enum {
+    SSD1680_SIM_REFRESH_NONE = 0,
+    SSD1680_SIM_REFRESH_FULL,    // OTP waveform, mode 1
+    SSD1680_SIM_REFRESH_PARTIAL, // OTP waveform, mode 2
+    SSD1680_SIM_REFRESH_LUT,     // Custom LUT
+} ssd1680_sim_refresh_t;
+
+#define SSD1680_SIM_SHM_MAGIC       0x4D485345 // "ESHM"
+#define SSD1680_SIM_SHM_VERSION     1
+#define SSD1680_SIM_SHM_HEADER_SIZE 64
+
+/**
+ * @brief Header of the shared image file (config.shm_path)
+ *
+ * The file is this header, padded to header_size, followed by the visible
+ * image (RGB888, height rows of stride bytes). The model renders straight
+ * into the mapping, so a viewer that maps the same file sees each refresh
+ * without copies or file writes.
+ *
+ * seq is a sequence lock: it is odd while a refresh writes the image and
+ * the fields below it, and even otherwise. A reader loads seq (acquire),
+ * skips the frame if it is odd, reads what it needs, then issues an acquire
+ * fence and loads seq again; if it changed, the read raced a refresh and is
+ * discarded. See host/sim/sim_view.c.
+ */
+typedef struct {
+    uint32_t magic;            // SSD1680_SIM_SHM_MAGIC
+    uint16_t version;          // SSD1680_SIM_SHM_VERSION
+    uint16_t header_size;      // Offset of the image
+    uint16_t width;            // SSD1680_SIM_PANEL_WIDTH
+    uint16_t height;           // SSD1680_SIM_PANEL_HEIGHT
+    uint32_t stride;           // Bytes per image row
+    _Atomic uint32_t seq;      // Odd while a refresh is being written
+    uint32_t generation;       // Refreshes so far
+    int64_t time_us;           // Model clock at the last refresh
+    int16_t dirty_x1;          // Pixels changed by the last refresh, inclusive
+    int16_t dirty_y1;          // (panel coordinates; x1 > x2 = none changed)
+    int16_t dirty_x2;
+    int16_t dirty_y2;
+    uint8_t mode;              // ssd1680_sim_refresh_t of the last refresh
+    uint8_t reserved[7];
+} ssd1680_sim_shm_header_t;
+
+/**
+ * @brief BUSY durations in microseconds
+ *
+ * The OTP waveform is picked by temperature and gets longer in the cold;
+ * a custom LUT runs for its own frame count whatever the temperature.
+ */
+typedef struct {
+    uint32_t hw_reset_us;      // After RST released
+    uint32_t sw_reset_us;      // 0x12
+    uint32_t auto_write_us;    // 0x46 / 0x47
+    uint32_t power_on_us;      // Analog on (sequence bit 6, if it was off)
+    uint32_t power_off_us;     // Analog off (bit 1)
+    uint32_t temp_load_us;     // Temperature sensor read (bit 5)
+    uint32_t lut_load_us;      // OTP LUT load (bit 4)
+    uint32_t full_us;          // Display, OTP mode 1
+    uint32_t partial_us;       // Display, OTP mode 2
+    uint32_t lut_frame_us;     // Display with a custom LUT: per LUT frame
+    uint16_t cold_percent_per_c; // OTP waveforms: full/partial +N % per °C below 25 °C
+} ssd1680_sim_timing_t;
+
+/**
+ * @brief Counters since ssd1680_sim_new() (or ssd1680_sim_reset_stats())
+ */
+typedef struct {
+    uint32_t transactions;     // Command + data transfers seen
+    uint32_t commands;
+    uint64_t data_bytes;
+    uint64_t ram_bytes[2];     // Bytes written to BW / RED RAM
+    uint32_t activations;      // MASTER_ACTIVATION count
+    uint32_t refreshes;        // Activations that drove the display
+    uint32_t full_refreshes;   // OTP mode 1
+    uint32_t partial_refreshes; // OTP mode 2
+    uint32_t lut_refreshes;    // Custom LUT
+    uint32_t hw_resets;
+    uint32_t sw_resets;
+    uint64_t busy_us;          // Total modelled BUSY high time
+    uint32_t last_busy_us;     // Last BUSY period
+    uint32_t frames_written;   // Image files written
+} ssd1680_sim_stats_t;
+
+/**
+ * @brief Model configuration
+ */
+typedef struct {
+    ssd1680_sim_timing_t timing;
+    int16_t temperature_x16;   // Internal sensor reading, 1/16 °C
+    bool tricolor;             // Render RED RAM as red in mode 1
+    const char *frame_prefix;  // Write <prefix>_NNNN.pbm after each refresh (NULL = off)
+    bool write_png;            // Also write <prefix>_NNNN.png
+    const char *shm_path;      // Keep the image in this mapped file (ssd1680_sim_shm_header_t, NULL = off)
+    int64_t (*now_us)(void *ctx); // Clock for BUSY timing (NULL = host clock)
+    void *clock_ctx;
+} ssd1680_sim_config_t;
+
+typedef struct ssd1680_sim ssd1680_sim_t;
+
+/**
+ * @brief Defaults: WeAct 2.13" timings at room temperature, no files
+ */
+ssd1680_sim_config_t ssd1680_sim_default_config(void);
+
+ssd1680_sim_t *ssd1680_sim_new(const ssd1680_sim_config_t *config);
+void ssd1680_sim_delete(ssd1680_sim_t *sim);
+
+/**
+ * @brief Sink to pass to weact_epaper_transport_new_host()
+ */
+weact_epaper_host_sink_t ssd1680_sim_sink(ssd1680_sim_t *sim);
+
+/**
+ * @brief Feed the model directly (trace replay, tests)
+ */
+void ssd1680_sim_command(ssd1680_sim_t *sim, uint8_t cmd);
+void ssd1680_sim_data(ssd1680_sim_t *sim, const uint8_t *data, size_t len);
+void ssd1680_sim_rst(ssd1680_sim_t *sim, int level);
+bool ssd1680_sim_busy(ssd1680_sim_t *sim);
+
+/**
+ * @brief Change the internal sensor reading (used at the next temperature load)
+ */
+void ssd1680_sim_set_temperature(ssd1680_sim_t *sim, int16_t temperature_x16);
+
+const ssd1680_sim_stats_t *ssd1680_sim_stats(ssd1680_sim_t *sim);
+void ssd1680_sim_reset_stats(ssd1680_sim_t *sim);
+
+/**
+ * @brief Visible image, RGB888, SSD1680_SIM_PANEL_WIDTH x SSD1680_SIM_PANEL_HEIGHT
+ */
+const uint8_t *ssd1680_sim_image(ssd1680_sim_t *sim);
+
+/**
+ * @brief RAM bit (1 = white in BW RAM), x/y in RAM coordinates
+ */
+int ssd1680_sim_ram_bit(ssd1680_sim_t *sim, int bank, int x, int y);
+
+bool ssd1680_sim_write_pbm(ssd1680_sim_t *sim, const char *path);
+bool ssd1680_sim_write_png(ssd1680_sim_t *sim, const char *path);
+
+#endif // SSD1680_SIM_H
@@ -0,0 +1,334 @@
+/**
+ * @file trace_replay.c
+ * @brief Replay, print and compare bus traces on the host
+ *
+ * Traces come from weact_epaper_trace_dump() (binary) or from a console
+ * log holding a weact_epaper_trace_dump_console() base64 block.
+ *
+ *   trace_replay [-o prefix] [-m file] [-w] trace    Replay into the SSD1680 model, print what it saw
+ *   trace_replay -p trace                  Print as CSV
+ *   trace_replay -d a b                    Compare commands and data (timing ignored)
+ *   trace_replay -r trace.bin              Record init, frame, diff and clear on the model
+ *
+ *   -o prefix  Write the model's frames as <prefix>_NNNN.pbm
+ *   -m file    Keep the model's image in a shared mapped file (see sim_view)
+ *   -w         Keep the recorded timing (wall clock) instead of the virtual clock
+ */
+
+#include "ssd1680_sim.h"
+#include "weact_epaper_2in13.h"
+#include "weact_epaper_trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CONSOLE_BEGIN "-----BEGIN WEACT EPAPER TRACE-----"
+#define CONSOLE_END   "-----END WEACT EPAPER TRACE-----"
+
+static int base64_value(int c)
+{
+    if (c >= 'A' && c <= 'Z')
+        return c - 'A';
+    if (c >= 'a' && c <= 'z')
+        return c - 'a' + 26;
+    if (c >= '0' && c <= '9')
+        return c - '0' + 52;
+    if (c == '+')
+        return 62;
+    if (c == '/')
+        return 63;
+    return -1;
+}
+
+// Decode the base64 block of a console log in place, returns the new length
+static size_t console_decode(uint8_t *buf)
+{
+    char *begin = strstr((char *)buf, CONSOLE_BEGIN);
+    char *end = begin != NULL ? strstr(begin, CONSOLE_END) : NULL;
+    size_t out = 0;
+    uint32_t acc = 0;
+    int bits = 0;
+
+    if (end == NULL)
+    {
+        return 0;
+    }
+
+    for (char *p = begin + strlen(CONSOLE_BEGIN); p < end; p++)
+    {
+        int v = base64_value((unsigned char)*p);
+        if (v < 0)
+        {
+            continue; // Newlines, '=' padding, log prefixes are not base64
+        }
+        acc = acc << 6 | (uint32_t)v;
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            buf[out++] = (uint8_t)(acc >> bits);
+        }
+    }
+    return out;
+}
+
+static weact_epaper_trace_t *load(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        perror(path);
+        return NULL;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    uint8_t *buf = malloc((size_t)size + 1);
+    if (buf == NULL || fread(buf, 1, (size_t)size, f) != (size_t)size)
+    {
+        fclose(f);
+        free(buf);
+        return NULL;
+    }
+    fclose(f);
+    buf[size] = '\0';
+
+    size_t len = (size_t)size;
+    if (len < 4 || memcmp(buf, "WEPT", 4) != 0)
+    {
+        len = console_decode(buf);
+    }
+
+    weact_epaper_trace_t *trace = weact_epaper_trace_load(buf, len);
+    free(buf);
+    if (trace == NULL)
+    {
+        fprintf(stderr, "%s: no trace found\n", path);
+    }
+    return trace;
+}
+
+static void file_write(void *ctx, const void *data, size_t len)
+{
+    fwrite(data, 1, len, ctx);
+}
+
+static int replay(const char *path, const char *prefix, const char *shm_path, bool wall_clock)
+{
+    weact_epaper_trace_t *trace = load(path);
+    if (trace == NULL)
+    {
+        return 1;
+    }
+
+    weact_epaper_host_set_virtual_clock(!wall_clock);
+
+    ssd1680_sim_config_t sim_config = ssd1680_sim_default_config();
+    sim_config.frame_prefix = prefix;
+    sim_config.shm_path = shm_path;
+    ssd1680_sim_t *sim = ssd1680_sim_new(&sim_config);
+    if (sim == NULL)
+    {
+        weact_epaper_trace_delete(trace);
+        return 1;
+    }
+    weact_epaper_host_sink_t sink = ssd1680_sim_sink(sim);
+    weact_epaper_transport_t *target = weact_epaper_transport_new_host(&sink);
+
+    weact_epaper_trace_replay_config_t config = {
+        .keep_timing = true,
+        .wait_busy = true,
+    };
+    int64_t t0 = weact_epaper_host_now_us();
+    size_t n = weact_epaper_trace_replay(trace, target, &config);
+    int64_t elapsed = weact_epaper_host_now_us() - t0;
+
+    const ssd1680_sim_stats_t *s = ssd1680_sim_stats(sim);
+    printf("records %zu, %.1f ms\n", n, elapsed / 1000.0);
+    printf("transactions %u, commands %u, data bytes %llu, refreshes %u (full %u, partial %u, lut %u), busy %.1f ms\n",
+           s->transactions, s->commands, (unsigned long long)s->data_bytes, s->refreshes, s->full_refreshes,
+           s->partial_refreshes, s->lut_refreshes, s->busy_us / 1000.0);
+
+    target->del(target);
+    ssd1680_sim_delete(sim);
+    weact_epaper_trace_delete(trace);
+    return 0;
+}
+
+// Next record that goes on the bus (commands, data, reads)
+static bool next_bus_record(weact_epaper_trace_t *trace, uint64_t *cursor, weact_epaper_trace_record_t *rec,
+                            uint8_t *payload)
+{
+    while (weact_epaper_trace_next(trace, cursor, rec, payload, UINT16_MAX))
+    {
+        if (rec->type == WEACT_EPAPER_TRACE_COMMAND || rec->type == WEACT_EPAPER_TRACE_DATA ||
+            rec->type == WEACT_EPAPER_TRACE_READ || rec->type == WEACT_EPAPER_TRACE_RST)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int compare(const char *path_a, const char *path_b)
+{
+    weact_epaper_trace_t *a = load(path_a);
+    weact_epaper_trace_t *b = load(path_b);
+    static uint8_t pa[UINT16_MAX];
+    static uint8_t pb[UINT16_MAX];
+    uint64_t ca = 0;
+    uint64_t cb = 0;
+    size_t index = 0;
+    size_t bytes = 0;
+    int result = 0;
+
+    if (a == NULL || b == NULL)
+    {
+        return 2;
+    }
+
+    for (;; index++)
+    {
+        weact_epaper_trace_record_t ra;
+        weact_epaper_trace_record_t rb;
+        bool more_a = next_bus_record(a, &ca, &ra, pa);
+        bool more_b = next_bus_record(b, &cb, &rb, pb);
+
+        if (!more_a && !more_b)
+        {
+            break;
+        }
+        if (more_a != more_b)
+        {
+            printf("bus record %zu: %s ends first\n", index, more_a ? path_b : path_a);
+            result = 1;
+            break;
+        }
+        // Transfer boundaries count too: a different chunking is reported
+        if (ra.type != rb.type || ra.value != rb.value || ra.len != rb.len || ra.stored != rb.stored ||
+            memcmp(pa, pb, ra.stored) != 0)
+        {
+            printf("bus record %zu differs: %s type %u value 0x%02x len %u at %lu us / %s type %u value 0x%02x len %u at %lu us\n",
+                   index, path_a, ra.type, ra.value, ra.len, (unsigned long)ra.time_us, path_b, rb.type, rb.value,
+                   rb.len, (unsigned long)rb.time_us);
+            result = 1;
+            break;
+        }
+        bytes += ra.len + (ra.type != WEACT_EPAPER_TRACE_DATA);
+    }
+
+    if (result == 0)
+    {
+        printf("identical: %zu bus records, %zu bytes\n", index, bytes);
+    }
+    weact_epaper_trace_delete(a);
+    weact_epaper_trace_delete(b);
+    return result;
+}
+
+static int record(const char *path)
+{
+    weact_epaper_host_set_virtual_clock(true);
+
+    ssd1680_sim_t *sim = ssd1680_sim_new(NULL);
+    weact_epaper_host_sink_t sink = ssd1680_sim_sink(sim);
+    weact_epaper_config_t config = {
+        .transport = weact_epaper_transport_new_host(&sink),
+        .trace_size = 64 * 1024,
+    };
+    weact_epaper_t dev;
+    static uint8_t previous[WEACT_EPAPER_BUFFER_SIZE];
+
+    if (!weact_epaper_init(&dev, &config))
+    {
+        return 1;
+    }
+    weact_epaper_draw_rectangle(&dev, 20, 20, 60, 60, true);
+    weact_epaper_display_frame(&dev);
+    memcpy(previous, dev.framebuffer, sizeof(previous));
+    weact_epaper_draw_rectangle(&dev, 70, 100, 110, 140, true);
+    weact_epaper_display_diff(&dev, previous);
+    weact_epaper_clear_screen(&dev);
+
+    FILE *f = fopen(path, "wb");
+    if (f == NULL)
+    {
+        perror(path);
+        return 1;
+    }
+    weact_epaper_trace_dump(dev.trace, WEACT_EPAPER_TRACE_BINARY, file_write, f);
+    fclose(f);
+
+    uint32_t dropped;
+    printf("%zu records (%lu dropped) written to %s\n", weact_epaper_trace_count(dev.trace, &dropped), (unsigned long)dropped,
+           path);
+
+    weact_epaper_deinit(&dev);
+    config.transport->del(config.transport);
+    ssd1680_sim_delete(sim);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *prefix = NULL;
+    const char *shm_path = NULL;
+    bool wall_clock = false;
+    char mode = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:m:wpdr")) != -1)
+    {
+        switch (opt)
+        {
+        case 'o':
+            prefix = optarg;
+            break;
+        case 'm':
+            shm_path = optarg;
+            break;
+        case 'w':
+            wall_clock = true;
+            break;
+        case 'p':
+        case 'd':
+        case 'r':
+            mode = (char)opt;
+            break;
+        default:
+            goto usage;
+        }
+    }
+
+    if (mode == 'd' && optind + 2 == argc)
+    {
+        return compare(argv[optind], argv[optind + 1]);
+    }
+    if (optind + 1 != argc)
+    {
+        goto usage;
+    }
+    if (mode == 'r')
+    {
+        return record(argv[optind]);
+    }
+    if (mode == 'p')
+    {
+        weact_epaper_trace_t *trace = load(argv[optind]);
+        if (trace == NULL)
+        {
+            return 1;
+        }
+        weact_epaper_trace_dump(trace, WEACT_EPAPER_TRACE_CSV, file_write, stdout);
+        weact_epaper_trace_delete(trace);
+        return 0;
+    }
+    return replay(argv[optind], prefix, shm_path, wall_clock);
+
+usage:
+    fprintf(stderr, "usage: %s [-o prefix] [-m file] [-w] trace | -p trace | -d a b | -r out.bin\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,211 @@
+/**
+ * @file ui_render.c
+ * @brief Render and time the application screen (main/ui.c) on the host
+ *
+ * Builds ui_init() on an lvgl_weact_epaper display (landscape, as in
+ * main.c) whose transport feeds the SSD1680 model, then changes the
+ * temperatures n times. Every refreshed panel image is written as
+ * <prefix>_NNNN.pbm by the model. One CSV row per frame:
+ *
+ *   frame,render_us,flush_us,invalidated_px,dirty_x1,dirty_y1,dirty_x2,dirty_y2,changed_px,update_ms
+ *
+ * - render_us: LVGL render start to flush (wall clock)
+ * - flush_us: flush callback, i.e. color conversion and the driver's bus
+ *   work (wall clock; BUSY waits run on the virtual clock and cost nothing,
+ *   unless -w)
+ * - invalidated_px / dirty_*: areas LVGL invalidated for the frame (sum,
+ *   and bounding box in LVGL coordinates). The display renders in FULL
+ *   mode, so the whole screen is redrawn whatever this says
+ * - changed_px: panel pixels that differ from the previous refresh
+ * - update_ms: modelled render start to BUSY low
+ *
+ * Usage: ui_render [-o prefix] [-n updates] [-m file] [-w]
+ *
+ *   -o prefix  Frame files (default "ui_frame", "-" = none)
+ *   -n updates Temperature changes after the first frame (default 10)
+ *   -m file    Keep the model's image in a shared mapped file (see sim_view)
+ *   -w         Wall clock: BUSY waits take real time, so a viewer sees each refresh
+ */
+
+#include "lvgl.h"
+#include "lvgl_weact_epaper.h"
+#include "ssd1680_sim.h"
+#include "ui.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PANEL_PIXELS (SSD1680_SIM_PANEL_WIDTH * SSD1680_SIM_PANEL_HEIGHT)
+
+typedef struct {
+    int64_t render_start_us;
+    int64_t flush_start_us;
+    uint32_t invalidated_px;
+    lv_area_t dirty;
+    bool any;
+} frame_t;
+
+static int64_t wall_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void display_event_cb(lv_event_t *e)
+{
+    frame_t *frame = lv_event_get_user_data(e);
+
+    switch (lv_event_get_code(e))
+    {
+    case LV_EVENT_INVALIDATE_AREA:
+    {
+        const lv_area_t *area = lv_event_get_param(e);
+        frame->invalidated_px += lv_area_get_size(area);
+        if (frame->any)
+        {
+            lv_area_join(&frame->dirty, &frame->dirty, area);
+        }
+        else
+        {
+            lv_area_copy(&frame->dirty, area);
+            frame->any = true;
+        }
+        break;
+    }
+    case LV_EVENT_RENDER_START:
+        if (frame->render_start_us == 0)
+        {
+            frame->render_start_us = wall_us();
+        }
+        break;
+    case LV_EVENT_FLUSH_START:
+        frame->flush_start_us = wall_us();
+        break;
+    default:
+        break;
+    }
+}
+
+// Panel pixels that differ from the last image, which is updated
+static uint32_t count_changed(const uint8_t *image, uint8_t *last)
+{
+    uint32_t changed = 0;
+
+    for (size_t i = 0; i < PANEL_PIXELS; i++)
+    {
+        changed += memcmp(image + i * 3, last + i * 3, 3) != 0;
+    }
+    memcpy(last, image, PANEL_PIXELS * 3);
+    return changed;
+}
+
+int main(int argc, char **argv)
+{
+    const char *prefix = "ui_frame";
+    const char *shm_path = NULL;
+    bool wall_clock = false;
+    int updates = 10;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:n:m:w")) != -1)
+    {
+        switch (opt)
+        {
+        case 'o':
+            prefix = optarg;
+            break;
+        case 'n':
+            updates = atoi(optarg);
+            break;
+        case 'm':
+            shm_path = optarg;
+            break;
+        case 'w':
+            wall_clock = true;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-o prefix] [-n updates] [-m file] [-w]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    weact_epaper_host_set_virtual_clock(!wall_clock);
+
+    ssd1680_sim_config_t sim_config = ssd1680_sim_default_config();
+    sim_config.frame_prefix = strcmp(prefix, "-") == 0 ? NULL : prefix;
+    sim_config.shm_path = shm_path;
+    ssd1680_sim_t *sim = ssd1680_sim_new(&sim_config);
+    if (sim == NULL)
+    {
+        return 1;
+    }
+    weact_epaper_host_sink_t sink = ssd1680_sim_sink(sim);
+
+    lv_init();
+
+    lvgl_weact_epaper_config_t config = lvgl_weact_epaper_get_default_config();
+    config.landscape = true; // As in main.c
+    config.transport = weact_epaper_transport_new_host(&sink);
+
+    lv_display_t *disp = lvgl_weact_epaper_create(&config);
+    if (disp == NULL)
+    {
+        fprintf(stderr, "lvgl_weact_epaper_create failed\n");
+        return 1;
+    }
+
+    static uint8_t last[PANEL_PIXELS * 3];
+    frame_t frame = {0};
+    count_changed(ssd1680_sim_image(sim), last);
+
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_INVALIDATE_AREA, &frame);
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_RENDER_START, &frame);
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_FLUSH_START, &frame);
+
+    printf("frame,render_us,flush_us,invalidated_px,dirty_x1,dirty_y1,dirty_x2,dirty_y2,changed_px,update_ms\n");
+
+    weact_epaper_phase_stats_t render = {0};
+    weact_epaper_phase_stats_t flush = {0};
+
+    for (int i = 0; i <= updates; i++)
+    {
+        if (i == 0)
+        {
+            ui_init();
+        }
+        else
+        {
+            // Current changes every time, target every fifth update
+            ui_set_temperatures(20.0f + (float)(i % 50) / 10.0f, 21.0f + (float)(i / 5 % 3) / 2.0f);
+        }
+
+        lv_refr_now(disp);
+        int64_t flush_end_us = wall_us();
+
+        lvgl_weact_epaper_stats_t stats;
+        lvgl_weact_epaper_get_stats(disp, &stats);
+
+        int64_t render_us = frame.flush_start_us - frame.render_start_us;
+        int64_t flush_us = flush_end_us - frame.flush_start_us;
+        weact_epaper_phase_stats_add(&render, render_us);
+        weact_epaper_phase_stats_add(&flush, flush_us);
+
+        printf("%d,%lld,%lld,%u,%ld,%ld,%ld,%ld,%u,%.1f\n", i, (long long)render_us, (long long)flush_us,
+               frame.invalidated_px, (long)frame.dirty.x1, (long)frame.dirty.y1, (long)frame.dirty.x2,
+               (long)frame.dirty.y2, count_changed(ssd1680_sim_image(sim), last), stats.panel.update.last_us / 1000.0);
+
+        memset(&frame, 0, sizeof(frame));
+    }
+
+    printf("# render mean %.2f ms max %.2f ms, flush mean %.2f ms max %.2f ms, %u panel refreshes\n",
+           render.mean_us / 1000.0, render.max_us / 1000.0, flush.mean_us / 1000.0, flush.max_us / 1000.0,
+           ssd1680_sim_stats(sim)->refreshes);
+
+    lvgl_weact_epaper_delete(disp);
+    config.transport->del(config.transport);
+    ssd1680_sim_delete(sim);
+    return 0;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file ui.c
+ * @brief Thermostat screen (current and target temperature)
+ */
+
+#include <stdio.h>
+#include "esp_log.h" // CONFIG_APP_PROJECT_VER (sdkconfig.h)
+#include "lvgl.h"
+#include "ui.h"
+
+LV_FONT_DECLARE(Rubik_Medium_48)
+
+static lv_obj_t *cur_temp_;
+static lv_obj_t *tgt_temp_;
+
+void ui_init(void)
+{
+    lv_obj_t *main_view_ = lv_screen_active();
+    lv_obj_clean(main_view_);
+    lv_obj_set_style_bg_color(main_view_, lv_color_white(), LV_PART_MAIN);
+    lv_obj_set_style_pad_all(main_view_, 0, LV_PART_MAIN);
+
+    // Create current temp
+    lv_obj_t *lbl_cur_temp = lv_label_create(main_view_);
+    lv_label_set_text(lbl_cur_temp, "Current °C");
+
+    lv_obj_set_width(lbl_cur_temp, lv_pct(100));
+    lv_obj_set_style_text_font(lbl_cur_temp, &lv_font_montserrat_14, LV_PART_MAIN);
+    lv_obj_set_style_text_color(lbl_cur_temp, lv_color_black(), LV_PART_MAIN);
+    lv_obj_set_pos(lbl_cur_temp, 0, 0);
+
+    cur_temp_ = lv_label_create(main_view_);
+    char temp_str[32];
+    snprintf(temp_str, sizeof(temp_str), "%.1f", 24.5);
+    lv_label_set_text_fmt(cur_temp_, "%s", temp_str);
+    lv_obj_set_width(cur_temp_, lv_pct(100));
+    lv_obj_set_style_text_font(cur_temp_, &Rubik_Medium_48, LV_PART_MAIN);
+    lv_obj_set_style_text_color(cur_temp_, lv_color_black(), LV_PART_MAIN);
+
+    lv_obj_align_to(cur_temp_, lbl_cur_temp, LV_ALIGN_OUT_BOTTOM_LEFT, 0, -4);
+
+    // Create target temp
+    lv_obj_t *lbl_tgt_temp = lv_label_create(main_view_);
+    lv_label_set_text(lbl_tgt_temp, "Target °C");
+    lv_obj_set_width(lbl_tgt_temp, lv_pct(100));
+    lv_obj_set_style_text_font(lbl_tgt_temp, &lv_font_montserrat_14, LV_PART_MAIN);
+    lv_obj_set_style_text_color(lbl_tgt_temp, lv_color_black(), LV_PART_MAIN);
+    lv_obj_set_style_text_align(lbl_tgt_temp, LV_TEXT_ALIGN_RIGHT, LV_PART_MAIN);
+    lv_obj_set_pos(lbl_tgt_temp, 0, 0);
+
+    lv_obj_align_to(lbl_tgt_temp, cur_temp_, LV_ALIGN_OUT_BOTTOM_LEFT, 0, -6);
+
+    tgt_temp_ = lv_label_create(main_view_);
+    snprintf(temp_str, sizeof(temp_str), "%.1f", 21.0);
+    lv_label_set_text_fmt(tgt_temp_, "%s", temp_str);
+    lv_obj_set_width(tgt_temp_, lv_pct(100));
+    lv_obj_set_style_text_font(tgt_temp_, &Rubik_Medium_48, LV_PART_MAIN);
+    lv_obj_set_style_text_color(tgt_temp_, lv_color_black(), LV_PART_MAIN);
+    lv_obj_set_style_text_align(tgt_temp_, LV_TEXT_ALIGN_RIGHT, LV_PART_MAIN);
+
+    lv_obj_align_to(tgt_temp_, lbl_tgt_temp, LV_ALIGN_OUT_BOTTOM_LEFT, 0, -4);
+
+    // Version label
+    lv_obj_t *label_version = lv_label_create(main_view_);
+    lv_label_set_text_fmt(label_version, "v%s\n%s",
+                          CONFIG_APP_PROJECT_VER,
+                          "vogeler2129");
+    lv_obj_set_style_text_font(label_version, &lv_font_montserrat_14, LV_PART_MAIN);
+    lv_obj_set_style_text_color(label_version, lv_color_black(), LV_PART_MAIN);
+    lv_obj_align(label_version, LV_ALIGN_BOTTOM_LEFT, 0, 0);
+
+    // Define line points as static (they need to persist)
+    static lv_point_precise_t separator_points[] = {
+        {0, 0},
+        {0, 122} // 100px vertical line
+    };
+
+    lv_obj_t *separator = lv_line_create(main_view_);
+    lv_obj_set_style_pad_all(separator, 0, LV_PART_MAIN);
+    lv_line_set_points(separator, separator_points, 2);
+    lv_obj_align(separator, LV_ALIGN_CENTER, 0, 0);
+    lv_obj_set_style_line_width(separator, 3, 0);
+    lv_obj_set_style_line_color(separator, lv_color_black(), 0);
+
+    // xTaskCreatePinnedToCore(update_task, "update_task", 4096 * 2, NULL, 0, NULL, 1);
+}
+
+void ui_set_temperatures(float current, float target)
+{
+    char temp_str[32];
+
+    if (cur_temp_ == NULL)
+    {
+        return;
+    }
+
+    snprintf(temp_str, sizeof(temp_str), "%.1f", current);
+    lv_label_set_text(cur_temp_, temp_str);
+    snprintf(temp_str, sizeof(temp_str), "%.1f", target);
+    lv_label_set_text(tgt_temp_, temp_str);
+}
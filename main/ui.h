@@ -0,0 +1,24 @@
+/**
+ * @file ui.h
+ * @brief Thermostat screen (current and target temperature)
+ *
+ * Kept apart from app_main() so the host build can render the same screen
+ * (host/sim/ui_render.c).
+ */
+
+#ifndef UI_H
+#define UI_H
+
+/**
+ * @brief Build the screen on the active LVGL screen
+ */
+void ui_init(void);
+
+/**
+ * @brief Show new temperatures (°C)
+ *
+ * Only invalidates the two labels; the next LVGL refresh draws them.
+ */
+void ui_set_temperatures(float current, float target);
+
+#endif // UI_H